@@ -4,6 +4,8 @@
 #include "utils/filesystem.hpp"
 #include "utils/json.hpp"
 #include "dft/lattice_relaxation.hpp"
+#include "dft/phonons.hpp"
+#include "dft/molecular_dynamics.hpp"
 
 using namespace sirius;
 using json = nlohmann::json;
@@ -20,6 +22,9 @@ struct task_t
     static const int read_config              = 4;
     static const int ground_state_new_relax   = 5;
     static const int ground_state_new_vcrelax = 6;
+    static const int ground_state_continuation = 7;
+    static const int phonons                  = 8;
+    static const int molecular_dynamics       = 9;
 };
 
 void json_output_common(json& dict__)
@@ -85,6 +90,52 @@ create_sim_ctx(std::string fname__, cmd_args const& args__)
     return ctx_ptr;
 }
 
+/// Converge the ground state with reduced cutoffs and a coarser k-mesh and use it as a starting point for dft__.
+json
+coarse_ground_state(Simulation_context& ctx__, cmd_args const& args__, DFT_ground_state& dft__)
+{
+    PROFILE("coarse_ground_state");
+
+    auto scale   = args__.value<double>("coarse_cutoff_scale", 0.6);
+    auto divisor = args__.value<int>("coarse_kmesh_divisor", 2);
+
+    auto dict = ctx__.cfg().dict();
+    dict.erase("locked");
+    dict["parameters"]["pw_cutoff"] = ctx__.pw_cutoff() * scale;
+    dict["parameters"]["gk_cutoff"] = ctx__.gk_cutoff() * scale;
+    std::vector<int> ngridk(3);
+    for (int x : {0, 1, 2}) {
+        ngridk[x] = std::max(1, ctx__.cfg().parameters().ngridk()[x] / divisor);
+    }
+    dict["parameters"]["ngridk"] = ngridk;
+
+    Simulation_context ctx(dict.dump(), ctx__.comm());
+    ctx.initialize();
+
+    auto& inp = ctx.cfg().parameters();
+
+    bool const reduce_kp = ctx.use_symmetry() && inp.use_ibz();
+    K_point_set kset(ctx, inp.ngridk(), inp.shiftk(), reduce_kp);
+
+    DFT_ground_state dft(kset);
+    dft.initial_state();
+    /* the density is only a starting point for the final calculation; don't converge it too tightly */
+    auto result = dft.find(10 * inp.density_tol(), 10 * inp.energy_tol(),
+            ctx.cfg().iterative_solver().energy_tolerance(), inp.num_dft_iter(), false);
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+    dft__.initial_state(dft);
+    auto t1 = std::chrono::high_resolution_clock::now();
+
+    result["pw_cutoff"]     = ctx.pw_cutoff();
+    result["gk_cutoff"]     = ctx.gk_cutoff();
+    result["ngridk"]        = ngridk;
+    result["num_kpoints"]   = kset.num_kpoints();
+    result["transfer_time"] = std::chrono::duration_cast<std::chrono::duration<double>>(t1 - t0).count();
+
+    return result;
+}
+
 double
 ground_state(Simulation_context& ctx, int task_id, cmd_args const& args, int write_output)
 {
@@ -110,6 +161,24 @@ ground_state(Simulation_context& ctx, int task_id, cmd_args const& args, int wri
                           << "+---------------------------------------------------------+" << std::endl;
                 break;
             }
+            case task_t::ground_state_continuation: {
+                ctx.out() << "+-------------------------------------------------+" << std::endl
+                          << "| new SCF ground state starting from coarse stage |" << std::endl
+                          << "+-------------------------------------------------+" << std::endl;
+                break;
+            }
+            case task_t::phonons: {
+                ctx.out() << "+-----------------------------------------------+" << std::endl
+                          << "| force constants from the finite displacements |" << std::endl
+                          << "+-----------------------------------------------+" << std::endl;
+                break;
+            }
+            case task_t::molecular_dynamics: {
+                ctx.out() << "+-------------------------------------+" << std::endl
+                          << "| Born-Oppenheimer molecular dynamics |" << std::endl
+                          << "+-------------------------------------+" << std::endl;
+                break;
+            }
             default: {
                 break;
             }
@@ -132,12 +201,16 @@ ground_state(Simulation_context& ctx, int task_id, cmd_args const& args, int wri
     auto& potential = dft.potential();
     auto& density = dft.density();
 
+    json result_coarse;
+
     if (task_id == task_t::ground_state_restart) {
         if (!utils::file_exists(storage_file_name)) {
             RTE_THROW("storage file is not found");
         }
         density.load();
         potential.load();
+    } else if (task_id == task_t::ground_state_continuation) {
+        result_coarse = coarse_ground_state(ctx, args, dft);
     } else {
         dft.initial_state();
     }
@@ -157,11 +230,32 @@ ground_state(Simulation_context& ctx, int task_id, cmd_args const& args, int wri
 
     switch (task_id) {
         case task_t::ground_state_new:
-        case task_t::ground_state_restart: {
+        case task_t::ground_state_restart:
+        case task_t::ground_state_continuation: {
             /* launch the calculation */
             result = dft.find(inp.density_tol(), inp.energy_tol(), ctx.cfg().iterative_solver().energy_tolerance(),
                     inp.num_dft_iter(), write_state);
 
+            if (task_id == task_t::ground_state_continuation) {
+                result["continuation"] = json::array({result_coarse, json::object()});
+                auto& fine = result["continuation"][1];
+                fine["pw_cutoff"]          = ctx.pw_cutoff();
+                fine["gk_cutoff"]          = ctx.gk_cutoff();
+                fine["ngridk"]             = inp.ngridk();
+                fine["num_kpoints"]        = kset.num_kpoints();
+                fine["num_scf_iterations"] = result.value("num_scf_iterations", -1);
+                fine["scf_time"]           = result["scf_time"];
+                if (ctx.comm().rank() == 0) {
+                    ctx.out() << "continuation stages" << std::endl;
+                    for (auto& e : result["continuation"]) {
+                        ctx.out() << "  pw_cutoff : " << e["pw_cutoff"] << ", gk_cutoff : " << e["gk_cutoff"]
+                                  << ", ngridk : " << e["ngridk"] << ", SCF iterations : "
+                                  << e.value("num_scf_iterations", -1) << ", time : " << e["scf_time"] << " sec."
+                                  << std::endl;
+                    }
+                }
+            }
+
             if (compute_stress) {
                 dft.stress().calc_stress_total();
             }
@@ -202,6 +296,21 @@ ground_state(Simulation_context& ctx, int task_id, cmd_args const& args, int wri
                     ctx.cfg().vcsqnm().stress_tol());
             break;
         }
+        case task_t::phonons: {
+            /* ground state of the undistorted structure */
+            result = dft.find(inp.density_tol(), inp.energy_tol(), ctx.cfg().iterative_solver().energy_tolerance(),
+                    inp.num_dft_iter(), write_state);
+
+            Finite_displacement_phonons ph(dft);
+            result["phonons"] = ph.find(args.value<double>("phonon_displacement", 0.01),
+                    args.value<int>("phonon_groups", 1), args.value<std::string>("phonon_file", "force_constants.h5"));
+            break;
+        }
+        case task_t::molecular_dynamics: {
+            Molecular_dynamics md(dft);
+            result = md.run(ctx.cfg().md().num_steps());
+            break;
+        }
         default: {
             RTE_OUT(ctx.out()) << "task " << task_id << " is not handeled" << std::endl;
             break;
@@ -370,7 +479,10 @@ void run_tasks(cmd_args const& args)
     if (task_id == task_t::ground_state_new ||
         task_id == task_t::ground_state_restart ||
         task_id == task_t::ground_state_new_relax ||
-        task_id == task_t::ground_state_new_vcrelax) {
+        task_id == task_t::ground_state_new_vcrelax ||
+        task_id == task_t::ground_state_continuation ||
+        task_id == task_t::phonons ||
+        task_id == task_t::molecular_dynamics) {
         auto ctx = create_sim_ctx(fname, args);
         ctx->initialize();
         //if (ctx->comm().rank() == 0) {
@@ -575,6 +687,11 @@ int main(int argn, char** argv)
     args.register_key("--mixer.beta=", "{double} mixing parameter");
     args.register_key("--volume_scale0=", "{double} starting volume scale for EOS calculation");
     args.register_key("--volume_scale1=", "{double} final volume scale for EOS calculation");
+    args.register_key("--coarse_cutoff_scale=", "{double} scale factor of the cutoffs in the coarse stage of the continuation");
+    args.register_key("--coarse_kmesh_divisor=", "{int} divisor of the k-mesh in the coarse stage of the continuation");
+    args.register_key("--phonon_displacement=", "{double} magnitude of the atomic displacement (a.u.) for the force constants");
+    args.register_key("--phonon_groups=", "{int} number of groups of MPI ranks that compute displacements concurrently");
+    args.register_key("--phonon_file=", "{string} HDF5 file for the force constants");
 
     args.parse_args(argn, argv);
 
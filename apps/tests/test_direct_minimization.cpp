@@ -0,0 +1,69 @@
+#include <sirius.hpp>
+
+using namespace sirius;
+
+/* find the ground state of the input with the given solver and return the total energy */
+double ground_state_energy(nlohmann::json dict__, std::string solver__)
+{
+    dict__["parameters"]["ground_state_solver"] = solver__;
+
+    Simulation_context ctx(dict__.dump(), mpi::Communicator::world());
+    ctx.initialize();
+
+    auto& inp = ctx.cfg().parameters();
+    K_point_set kset(ctx, inp.ngridk(), inp.shiftk(), ctx.use_symmetry());
+    DFT_ground_state dft(kset);
+    dft.initial_state();
+    auto result = dft.find(inp.density_tol(), inp.energy_tol(), ctx.cfg().iterative_solver().energy_tolerance(),
+            inp.num_dft_iter(), false);
+
+    if (!result["converged"].get<bool>()) {
+        RTE_THROW("ground state is not converged with the " + solver__ + " solver");
+    }
+    return result["energy"]["total"].get<double>();
+}
+
+int main(int argn, char** argv)
+{
+    cmd_args args;
+    args.register_key("--input=", "{string} input file name (default: sirius.json, e.g. Si of the test08)");
+    args.register_key("--tol=", "{double} tolerance for the total energy difference");
+    args.register_key("--ensemble", "minimize the free energy of a metal (the smearing of the input is kept)");
+
+    args.parse_args(argn, argv);
+    if (args.exist("help")) {
+        printf("Usage: %s [options]\n", argv[0]);
+        args.print_help();
+        return 0;
+    }
+    auto fname    = args.value<std::string>("input", "sirius.json");
+    auto tol      = args.value<double>("tol", 1e-6);
+    bool ensemble = args.exist("ensemble");
+
+    sirius::initialize(1);
+
+    auto dict = utils::read_json_from_file_or_string(fname);
+    if (ensemble) {
+        /* both solvers find the minimum of the free energy E - TS */
+        dict["direct_minimization"]["ensemble"] = true;
+    } else {
+        /* direct minimization keeps integer occupation numbers; a tiny smearing makes the SCF run comparable */
+        dict["parameters"]["smearing_width"] = 1e-4;
+    }
+
+    double e_scf = ground_state_energy(dict, "scf");
+    double e_dm  = ground_state_energy(dict, "direct_minimization");
+
+    int err{0};
+    if (mpi::Communicator::world().rank() == 0) {
+        printf("%s (Davidson and mixing) : %18.10f\n", ensemble ? " free energy" : "total energy", e_scf);
+        printf("%s (direct minimization) : %18.10f\n", ensemble ? " free energy" : "total energy", e_dm);
+        printf("difference                         : %18.10e\n", std::abs(e_scf - e_dm));
+    }
+    if (std::abs(e_scf - e_dm) > tol) {
+        err = 1;
+    }
+
+    sirius::finalize();
+    return err;
+}
@@ -0,0 +1,198 @@
+#include <sirius.hpp>
+
+using namespace sirius;
+
+/* write a smooth complex function with a given layout, read it back in full and block by block and report
+ * the file size and the timings */
+int test_layout(std::string label__, sddk::hdf5_filter_t filter__, int n__, int nblk__)
+{
+    sddk::mdarray<std::complex<double>, 2> f(n__ * n__, n__);
+    for (int k = 0; k < n__; k++) {
+        for (int j = 0; j < n__; j++) {
+            for (int i = 0; i < n__; i++) {
+                double x = twopi * (i + 0.5 * j + 0.25 * k) / n__;
+                f(i + j * n__, k) = std::complex<double>(std::cos(x), std::sin(2 * x)) * std::exp(-0.01 * k);
+            }
+        }
+    }
+
+    sddk::hdf5_layout_t layout;
+    layout.filter = filter__;
+    if (filter__ != sddk::hdf5_filter_t::none) {
+        layout.chunk = {n__ * n__, std::max(1, n__ / nblk__)};
+    }
+
+    std::string fname = "test_hdf5_chunked.h5";
+
+    auto t0 = utils::time_now();
+    {
+        sddk::HDF5_tree fout(fname, sddk::hdf5_access_t::truncate);
+        fout.write("f", f, layout);
+    }
+    double t_write = utils::time_interval(t0);
+
+    std::ifstream ifs(fname, std::ios::binary | std::ios::ate);
+    double size = static_cast<double>(ifs.tellg()) / (1 << 20);
+
+    sddk::mdarray<std::complex<double>, 2> g(n__ * n__, n__);
+    t0 = utils::time_now();
+    {
+        sddk::HDF5_tree fin(fname, sddk::hdf5_access_t::read_only);
+        fin.read("f", g);
+    }
+    double t_read = utils::time_interval(t0);
+
+    double diff{0};
+    for (int k = 0; k < n__; k++) {
+        for (int i = 0; i < n__ * n__; i++) {
+            diff += std::abs(f(i, k) - g(i, k));
+        }
+    }
+
+    /* read one block of the slowest dimension */
+    int nk = std::max(1, n__ / nblk__);
+    int k0 = n__ - nk;
+    sddk::mdarray<std::complex<double>, 2> h(n__ * n__, nk);
+    t0 = utils::time_now();
+    {
+        sddk::HDF5_tree fin(fname, sddk::hdf5_access_t::read_only);
+        auto dims = fin.dims("f");
+        if (dims[0] != 2 || dims[1] != n__ * n__ || dims[2] != n__) {
+            std::cout << "wrong dimensions of the dataset" << std::endl;
+            return 1;
+        }
+        fin.read("f", h, {0, k0});
+    }
+    double t_read_block = utils::time_interval(t0);
+
+    for (int k = 0; k < nk; k++) {
+        for (int i = 0; i < n__ * n__; i++) {
+            diff += std::abs(f(i, k0 + k) - h(i, k));
+        }
+    }
+
+    std::printf("%-8s  size : %10.4f Mb,  write : %8.4f s,  read : %8.4f s,  read 1/%i : %8.4f s,  diff : %e\n",
+                label__.c_str(), size, t_write, t_read, nblk__, t_read_block, diff);
+
+    return (diff > 1e-12) ? 1 : 0;
+}
+
+/* rewrite an existing real dataset (e.g. effective_potential/f_pw of sirius.h5) with a given layout, read it back in
+ * full and the last 1/nblk of it and report the file size and the timings */
+int test_layout_dataset(std::string label__, sddk::hdf5_filter_t filter__, std::vector<double> const& f__,
+                        int nblk__)
+{
+    int n = static_cast<int>(f__.size());
+
+    sddk::hdf5_layout_t layout;
+    layout.filter = filter__;
+    if (filter__ != sddk::hdf5_filter_t::none) {
+        layout.chunk = {std::max(1, n / nblk__)};
+    }
+
+    std::string fname = "test_hdf5_chunked.h5";
+
+    auto t0 = utils::time_now();
+    {
+        sddk::HDF5_tree fout(fname, sddk::hdf5_access_t::truncate);
+        fout.write("f", f__.data(), n, layout);
+    }
+    double t_write = utils::time_interval(t0);
+
+    std::ifstream ifs(fname, std::ios::binary | std::ios::ate);
+    double size = static_cast<double>(ifs.tellg()) / (1 << 20);
+
+    std::vector<double> g(n);
+    t0 = utils::time_now();
+    {
+        sddk::HDF5_tree fin(fname, sddk::hdf5_access_t::read_only);
+        fin.read("f", g.data(), n);
+    }
+    double t_read = utils::time_interval(t0);
+
+    double diff{0};
+    for (int i = 0; i < n; i++) {
+        diff += std::abs(f__[i] - g[i]);
+    }
+
+    int nb = std::max(1, n / nblk__);
+    int i0 = n - nb;
+    std::vector<double> h(nb);
+    t0 = utils::time_now();
+    {
+        sddk::HDF5_tree fin(fname, sddk::hdf5_access_t::read_only);
+        fin.read("f", h.data(), {i0}, {nb});
+    }
+    double t_read_block = utils::time_interval(t0);
+
+    for (int i = 0; i < nb; i++) {
+        diff += std::abs(f__[i0 + i] - h[i]);
+    }
+
+    std::printf("%-8s  size : %10.4f Mb,  write : %8.4f s,  read : %8.4f s,  read 1/%i : %8.4f s,  diff : %e\n",
+                label__.c_str(), size, t_write, t_read, nblk__, t_read_block, diff);
+
+    return (diff > 0) ? 1 : 0;
+}
+
+int main(int argn, char** argv)
+{
+    cmd_args args;
+    args.register_key("--n=", "{int} size of the array along each of the three dimensions");
+    args.register_key("--nblk=", "{int} number of blocks along the slowest dimension");
+    args.register_key("--input=", "{string} HDF5 file with an existing dataset, e.g. sirius.h5 of a finished run");
+    args.register_key("--dataset=", "{string} path to the real dataset in the input file (default: effective_potential/f_pw)");
+
+    args.parse_args(argn, argv);
+    if (args.exist("help")) {
+        printf("Usage: %s [options]\n", argv[0]);
+        args.print_help();
+        return 0;
+    }
+    int n    = args.value<int>("n", 64);
+    int nblk = args.value<int>("nblk", 8);
+
+    sirius::initialize(1);
+    int err{0};
+    if (args.exist("input")) {
+        auto fname = args.value<std::string>("input");
+        auto path  = args.value<std::string>("dataset", "effective_potential/f_pw");
+        auto pos   = path.rfind('/');
+        auto group = (pos == std::string::npos) ? std::string() : path.substr(0, pos);
+        auto name  = (pos == std::string::npos) ? path : path.substr(pos + 1);
+
+        std::vector<double> f;
+        auto read_dataset = [&](sddk::HDF5_tree& node__)
+        {
+            size_t sz{1};
+            for (auto d : node__.dims(name)) {
+                sz *= d;
+            }
+            f.resize(sz);
+            node__.read(name, f.data(), static_cast<int>(sz));
+        };
+        {
+            sddk::HDF5_tree fin(fname, sddk::hdf5_access_t::read_only);
+            if (group.empty()) {
+                read_dataset(fin);
+            } else {
+                auto node = fin[group];
+                read_dataset(node);
+            }
+        }
+        std::printf("dataset %s of %s : %zu elements\n", path.c_str(), fname.c_str(), f.size());
+
+        err += test_layout_dataset("none", sddk::hdf5_filter_t::none, f, nblk);
+        err += test_layout_dataset("deflate", sddk::hdf5_filter_t::deflate, f, nblk);
+        err += test_layout_dataset("szip", sddk::hdf5_filter_t::szip, f, nblk);
+        err += test_layout_dataset("zstd", sddk::hdf5_filter_t::zstd, f, nblk);
+    } else {
+        err += test_layout("none", sddk::hdf5_filter_t::none, n, nblk);
+        err += test_layout("deflate", sddk::hdf5_filter_t::deflate, n, nblk);
+        err += test_layout("szip", sddk::hdf5_filter_t::szip, n, nblk);
+        err += test_layout("zstd", sddk::hdf5_filter_t::zstd, n, nblk);
+    }
+    sirius::finalize();
+
+    return err;
+}
@@ -0,0 +1,74 @@
+#include <sirius.hpp>
+
+using namespace sirius;
+
+/* run the ground state of the DFT+U+V input in the non-collinear mode with and without symmetry */
+double ground_state_energy(nlohmann::json dict__, bool use_symmetry__)
+{
+    dict__["parameters"]["num_mag_dims"] = 3;
+    dict__["parameters"]["use_symmetry"] = use_symmetry__;
+    dict__["parameters"]["use_ibz"]      = use_symmetry__;
+
+    Simulation_context ctx(dict__.dump(), mpi::Communicator::world());
+    ctx.initialize();
+
+    auto& inp = ctx.cfg().parameters();
+    K_point_set kset(ctx, inp.ngridk(), inp.shiftk(), use_symmetry__);
+    DFT_ground_state dft(kset);
+    dft.initial_state();
+    auto result = dft.find(inp.density_tol(), inp.energy_tol(), ctx.cfg().iterative_solver().energy_tolerance(),
+            inp.num_dft_iter(), false);
+
+    if (!result["converged"].get<bool>()) {
+        RTE_THROW("ground state is not converged");
+    }
+    return result["energy"]["total"].get<double>();
+}
+
+int main(int argn, char** argv)
+{
+    cmd_args args;
+    args.register_key("--input=", "{string} input file name (default: sirius.json of the verification test28)");
+    args.register_key("--moment=", "{double double double} starting magnetic moment of the first atom type");
+    args.register_key("--tol=", "{double} tolerance for the total energy difference");
+
+    args.parse_args(argn, argv);
+    if (args.exist("help")) {
+        printf("Usage: %s [options]\n", argv[0]);
+        args.print_help();
+        return 0;
+    }
+    auto fname  = args.value<std::string>("input", "sirius.json");
+    auto moment = args.value("moment", std::vector<double>({1, 0, 1}));
+    auto tol    = args.value<double>("tol", 1e-6);
+
+    sirius::initialize(1);
+
+    auto dict = utils::read_json_from_file_or_string(fname);
+    if (!dict["hubbard"]["nonlocal"].size()) {
+        RTE_THROW("input has no inter-site V correction");
+    }
+    /* canted starting moment on the atoms of the first type */
+    auto label = dict["unit_cell"]["atom_types"][0].get<std::string>();
+    for (auto& a : dict["unit_cell"]["atoms"][label]) {
+        std::vector<double> v({a[0].get<double>(), a[1].get<double>(), a[2].get<double>()});
+        v.insert(v.end(), moment.begin(), moment.end());
+        a = v;
+    }
+
+    double e_sym   = ground_state_energy(dict, true);
+    double e_nosym = ground_state_energy(dict, false);
+
+    int err{0};
+    if (mpi::Communicator::world().rank() == 0) {
+        printf("total energy with symmetry    : %18.10f\n", e_sym);
+        printf("total energy without symmetry : %18.10f\n", e_nosym);
+        printf("difference                    : %18.10e\n", std::abs(e_sym - e_nosym));
+    }
+    if (std::abs(e_sym - e_nosym) > tol) {
+        err = 1;
+    }
+
+    sirius::finalize();
+    return err;
+}
@@ -0,0 +1,84 @@
+#include <sirius.hpp>
+#include "symmetry/crystal_symmetry.hpp"
+#include "symmetry/get_irreducible_reciprocal_mesh.hpp"
+
+using namespace sirius;
+
+/* check the magnetic group of two atoms in the CsCl structure and print the number of irreducible k-points */
+int test_magnetic_sym(r3::vector<double> m0__, r3::vector<double> m1__, bool spin_orbit__, int k__)
+{
+    r3::matrix<double> lv;
+    for (int x : {0, 1, 2}) {
+        lv(x, x) = 5.0;
+    }
+
+    sddk::mdarray<double, 2> positions(3, 2);
+    sddk::mdarray<double, 2> spins(3, 2);
+    for (int x : {0, 1, 2}) {
+        positions(x, 0) = 0;
+        positions(x, 1) = 0.5;
+        spins(x, 0)     = m0__[x];
+        spins(x, 1)     = m1__[x];
+    }
+    std::vector<int> types({0, 0});
+
+    Crystal_symmetry sym(lv, 2, 1, types, positions, spins, spin_orbit__, 1e-6, true);
+
+    /* magnetic moments must transform into each other under all operations */
+    for (int isym = 0; isym < sym.size(); isym++) {
+        auto S = sym[isym].spin_rotation;
+        for (int ia = 0; ia < 2; ia++) {
+            int ja = sym[isym].spg_op.sym_atom[ia];
+            r3::vector<double> mi(spins(0, ia), spins(1, ia), spins(2, ia));
+            r3::vector<double> mj(spins(0, ja), spins(1, ja), spins(2, ja));
+            if ((dot(S, mi) - mj).length() > 1e-10) {
+                std::cout << "wrong transformation of magnetic moment by operation " << isym << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    auto result = get_irreducible_reciprocal_mesh(sym, {k__, k__, k__}, {0, 0, 0});
+
+    std::cout << "m0 : " << m0__ << ", m1 : " << m1__ << ", spin-orbit : " << spin_orbit__ << std::endl
+              << "  number of operations : " << sym.size() << ", antiunitary : " << sym.num_antiunitary()
+              << ", time reversal : " << sym.time_reversal() << std::endl
+              << "  number of irreducible k-points : " << std::get<0>(result) << " out of " << k__ * k__ * k__
+              << std::endl;
+
+    /* antiferromagnet with spin-orbit coupling: the translation that maps one sublattice to the other
+     * is a symmetry only in combination with the time reversal */
+    if (spin_orbit__ && (m0__ + m1__).length() < 1e-10 && sym.num_antiunitary() == 0) {
+        std::cout << "antiunitary operations are not found" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argn, char** argv)
+{
+    cmd_args args;
+    args.register_key("--k=", "{int} size of the k-mesh in each direction");
+
+    args.parse_args(argn, argv);
+    if (args.exist("help")) {
+        printf("Usage: %s [options]\n", argv[0]);
+        args.print_help();
+        return 0;
+    }
+    int k = args.value<int>("k", 8);
+
+    sirius::initialize(1);
+    int err{0};
+    /* collinear antiferromagnet with spin-orbit coupling */
+    err += test_magnetic_sym({0, 0, 1}, {0, 0, -1}, true, k);
+    /* ferromagnet with spin-orbit coupling */
+    err += test_magnetic_sym({0, 0, 1}, {0, 0, 1}, true, k);
+    /* canted antiferromagnet without spin-orbit coupling */
+    err += test_magnetic_sym({1, 0, 1}, {-1, 0, 1}, false, k);
+    /* canted antiferromagnet with spin-orbit coupling */
+    err += test_magnetic_sym({1, 0, 1}, {-1, 0, -1}, true, k);
+    sirius::finalize();
+
+    return err;
+}
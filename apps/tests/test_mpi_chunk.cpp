@@ -0,0 +1,187 @@
+#include <sirius.hpp>
+
+using namespace sirius;
+using namespace sddk;
+
+/* value of the i-th element of the buffer on a given rank */
+inline double value(size_t i__, int rank__)
+{
+    return 1.0 / (i__ % 1000 + rank__ + 1);
+}
+
+/* Check the results and compare the performance of allreduce and bcast of a large buffer for different chunk sizes */
+int test_chunk(size_t size__, int repeat__)
+{
+    auto& comm = mpi::Communicator::world();
+
+    sddk::mdarray<double, 1> buf(size__ / sizeof(double));
+
+    if (comm.rank() == 0) {
+        std::printf("buffer size : %f MB, number of ranks : %i\n", size__ / double(1 << 20), comm.size());
+        std::printf("chunk size (MB)  allreduce (sec.)  allreduce (GB/s)  bcast (sec.)  bcast (GB/s)  status\n");
+    }
+
+    auto chunk_size0 = mpi::collective_chunk_size();
+
+    /* zero chunk size means that the buffer is not split */
+    std::vector<size_t> chunks({0});
+    for (size_t c = (1 << 20); c < size__; c *= 4) {
+        chunks.push_back(c);
+    }
+
+    /* expected result of the reduction */
+    std::vector<double> sum(1000, 0);
+    for (int j = 0; j < 1000; j++) {
+        for (int r = 0; r < comm.size(); r++) {
+            sum[j] += value(j, r);
+        }
+    }
+
+    int err{0};
+    for (auto c : chunks) {
+        mpi::collective_chunk_size() = c;
+
+        int nerr{0};
+
+        /* check the reduction */
+        for (size_t i = 0; i < buf.size(); i++) {
+            buf[i] = value(i, comm.rank());
+        }
+        comm.allreduce(buf.at(memory_t::host), buf.size());
+        for (size_t i = 0; i < buf.size(); i++) {
+            if (std::abs(buf[i] - sum[i % 1000]) > 1e-12) {
+                nerr++;
+            }
+        }
+
+        /* check the broadcast from the last rank */
+        int root = comm.size() - 1;
+        for (size_t i = 0; i < buf.size(); i++) {
+            buf[i] = value(i, comm.rank());
+        }
+        comm.bcast(buf.at(memory_t::host), buf.size(), root);
+        for (size_t i = 0; i < buf.size(); i++) {
+            if (buf[i] != value(i, root)) {
+                nerr++;
+            }
+        }
+
+        comm.barrier();
+        double t0 = -utils::wtime();
+        for (int i = 0; i < repeat__; i++) {
+            comm.allreduce(buf.at(memory_t::host), buf.size());
+        }
+        comm.barrier();
+        t0 += utils::wtime();
+
+        double t1 = -utils::wtime();
+        for (int i = 0; i < repeat__; i++) {
+            comm.bcast(buf.at(memory_t::host), buf.size(), i % comm.size());
+        }
+        comm.barrier();
+        t1 += utils::wtime();
+
+        comm.allreduce(&nerr, 1);
+        err += nerr;
+
+        t0 /= repeat__;
+        t1 /= repeat__;
+        if (comm.rank() == 0) {
+            std::printf("%15.2f  %16.6f  %16.6f  %12.6f  %12.6f  %s\n", c / double(1 << 20), t0,
+                        size__ / t0 / (1 << 30), t1, size__ / t1 / (1 << 30), nerr ? "Failed" : "OK");
+        }
+    }
+    mpi::collective_chunk_size() = chunk_size0;
+
+    return err;
+}
+
+/* Check alltoall and in-place allgather of blocks larger than the chunk size */
+int test_chunk_alltoall(size_t size__)
+{
+    auto& comm = mpi::Communicator::world();
+
+    /* number of elements in the block of each rank */
+    size_t n = size__ / sizeof(double) / comm.size();
+
+    sddk::mdarray<double, 1> sbuf(n * comm.size());
+    sddk::mdarray<double, 1> rbuf(n * comm.size());
+
+    auto chunk_size0 = mpi::collective_chunk_size();
+
+    std::vector<size_t> chunks({0});
+    for (size_t c = (1 << 20); c < n * sizeof(double); c *= 4) {
+        chunks.push_back(c);
+    }
+
+    int err{0};
+    for (auto c : chunks) {
+        mpi::collective_chunk_size() = c;
+
+        int nerr{0};
+
+        /* block j of rank r is sent to rank j and is stored in the block r of the receive buffer */
+        for (int j = 0; j < comm.size(); j++) {
+            for (size_t i = 0; i < n; i++) {
+                sbuf[j * n + i] = value(i, comm.rank()) + j;
+            }
+        }
+        comm.alltoall(sbuf.at(memory_t::host), n, rbuf.at(memory_t::host), n);
+        for (int r = 0; r < comm.size(); r++) {
+            for (size_t i = 0; i < n; i++) {
+                if (rbuf[r * n + i] != value(i, r) + comm.rank()) {
+                    nerr++;
+                }
+            }
+        }
+
+        /* each rank contributes its own block */
+        for (size_t i = 0; i < n; i++) {
+            rbuf[comm.rank() * n + i] = value(i, comm.rank());
+        }
+        comm.allgather(rbuf.at(memory_t::host), n, comm.rank() * n);
+        for (int r = 0; r < comm.size(); r++) {
+            for (size_t i = 0; i < n; i++) {
+                if (rbuf[r * n + i] != value(i, r)) {
+                    nerr++;
+                }
+            }
+        }
+
+        comm.allreduce(&nerr, 1);
+        err += nerr;
+
+        if (comm.rank() == 0) {
+            std::printf("alltoall and allgather, chunk size (MB) : %8.2f  %s\n", c / double(1 << 20),
+                        nerr ? "Failed" : "OK");
+        }
+    }
+    mpi::collective_chunk_size() = chunk_size0;
+
+    return err;
+}
+
+int main(int argn, char** argv)
+{
+    cmd_args args;
+    args.register_key("--size=", "{int} buffer size in megabytes");
+    args.register_key("--repeat=", "{int} number of repetitions");
+
+    args.parse_args(argn, argv);
+
+    if (args.exist("help")) {
+        printf("Usage: %s [options]\n", argv[0]);
+        args.print_help();
+        return 0;
+    }
+
+    auto size   = args.value<size_t>("size", 1024);
+    auto repeat = args.value<int>("repeat", 5);
+
+    sirius::initialize(1);
+    int err = test_chunk(size << 20, repeat);
+    err += test_chunk_alltoall(size << 20);
+    sirius::finalize();
+
+    return (err == 0) ? 0 : 1;
+}
@@ -0,0 +1,75 @@
+#include <sirius.hpp>
+
+using namespace sirius;
+
+/* find the ground state of the input and return the free energy and the total magnetic moment */
+std::pair<double, double> ground_state(nlohmann::json dict__, bool sv_partial__, int num_empty__)
+{
+    dict__["settings"]["sv_partial"]          = sv_partial__;
+    dict__["settings"]["sv_num_empty_states"] = num_empty__;
+
+    Simulation_context ctx(dict__.dump(), mpi::Communicator::world());
+    ctx.initialize();
+
+    if (!ctx.full_potential() || ctx.num_mag_dims() == 0) {
+        RTE_THROW("this test requires a magnetic full-potential input");
+    }
+
+    auto& inp = ctx.cfg().parameters();
+    K_point_set kset(ctx, inp.ngridk(), inp.shiftk(), ctx.use_symmetry());
+    DFT_ground_state dft(kset);
+    dft.initial_state();
+    auto result = dft.find(inp.density_tol(), inp.energy_tol(), ctx.cfg().iterative_solver().energy_tolerance(),
+            inp.num_dft_iter(), false);
+
+    if (!result["converged"].get<bool>()) {
+        RTE_THROW(std::string("ground state is not converged with sv_partial = ") + (sv_partial__ ? "true" : "false"));
+    }
+    auto mag = std::get<0>(dft.density().get_magnetisation());
+
+    return std::make_pair(result["energy"]["total"].get<double>(), mag[2]);
+}
+
+int main(int argn, char** argv)
+{
+    cmd_args args;
+    args.register_key("--input=", "{string} input file name (default: sirius.json, e.g. bcc Fe of the test19)");
+    args.register_key("--num_empty=", "{int} number of empty second-variational states in the partial spectrum");
+    args.register_key("--smearing_width=", "{double} smearing width (default: 0.01)");
+    args.register_key("--tol=", "{double} tolerance for the energy and moment differences");
+
+    args.parse_args(argn, argv);
+    if (args.exist("help")) {
+        printf("Usage: %s [options]\n", argv[0]);
+        args.print_help();
+        return 0;
+    }
+    auto fname     = args.value<std::string>("input", "sirius.json");
+    auto num_empty = args.value<int>("num_empty", 4);
+    auto width     = args.value<double>("smearing_width", 0.01);
+    auto tol       = args.value<double>("tol", 1e-6);
+
+    sirius::initialize(1);
+
+    auto dict = utils::read_json_from_file_or_string(fname);
+    /* a large smearing gives the states just above the Fermi level a noticeable occupancy */
+    dict["parameters"]["smearing_width"] = width;
+
+    auto full    = ground_state(dict, false, num_empty);
+    auto partial = ground_state(dict, true, num_empty);
+
+    int err{0};
+    if (mpi::Communicator::world().rank() == 0) {
+        printf("                 full spectrum     partial spectrum   difference\n");
+        printf("free energy : %18.10f %18.10f %12.4e\n", full.first, partial.first,
+               std::abs(full.first - partial.first));
+        printf("moment      : %18.10f %18.10f %12.4e\n", full.second, partial.second,
+               std::abs(full.second - partial.second));
+    }
+    if (std::abs(full.first - partial.first) > tol || std::abs(full.second - partial.second) > tol) {
+        err = 1;
+    }
+
+    sirius::finalize();
+    return err;
+}
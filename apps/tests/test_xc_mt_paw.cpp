@@ -0,0 +1,143 @@
+#include <sirius.hpp>
+#include <testing.hpp>
+
+using namespace sirius;
+
+/* number of calls to the global operator new; arrays of sddk::mdarray are counted by sddk::num_host_allocations() */
+static std::atomic<size_t> num_new{0};
+
+void* operator new(std::size_t n__)
+{
+    num_new.fetch_add(1, std::memory_order_relaxed);
+    if (auto ptr = std::malloc(n__ ? n__ : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr__) noexcept
+{
+    std::free(ptr__);
+}
+
+void operator delete(void* ptr__, std::size_t) noexcept
+{
+    std::free(ptr__);
+}
+
+/* time the XC potential of the PAW sphere for a synthetic density and count the memory allocations */
+int test_xc_mt_paw(cmd_args const& args__)
+{
+    auto lmax         = args__.value<int>("lmax", 4);
+    auto num_points   = args__.value<int>("num_points", 1000);
+    auto num_mag_dims = args__.value<int>("num_mag_dims", 1);
+    auto repeat       = args__.value<int>("repeat", 10);
+    auto xc_names     = args__.value("xc", std::vector<std::string>({"XC_GGA_X_PBE", "XC_GGA_C_PBE"}));
+
+    if (num_mag_dims != 0 && num_mag_dims != 1 && num_mag_dims != 3) {
+        RTE_THROW("wrong number of magnetic dimensions");
+    }
+
+    auto json_conf = R"({
+      "parameters" : {
+        "electronic_structure_method" : "pseudopotential",
+        "use_symmetry" : false,
+        "pw_cutoff" : 8
+      }
+    })"_json;
+
+    /* the context is needed only to create the XC functionals */
+    auto ctx = create_simulation_context(json_conf, {{5, 0, 0}, {0, 5, 0}, {0, 0, 5}}, 0,
+            std::vector<r3::vector<double>>(), false, false);
+
+    int num_spins = (num_mag_dims == 0) ? 1 : 2;
+    std::vector<XC_functional> xc_func;
+    for (auto& e : xc_names) {
+        xc_func.emplace_back(XC_functional(ctx->spfft<double>(), ctx->unit_cell().lattice_vectors(), e, num_spins));
+    }
+
+    Radial_grid_lin_exp<double> rgrid(num_points, 1e-6, 2.0);
+    SHT sht(sddk::device_t::CPU, lmax);
+    int lmmax = utils::lmmax(lmax);
+    auto l_by_lm = utils::l_by_lm(lmax);
+
+    std::vector<Flm> rho;
+    for (int j = 0; j < num_mag_dims + 1; j++) {
+        rho.emplace_back(lmmax, rgrid);
+        rho[j].zero();
+        for (int ir = 0; ir < rgrid.num_points(); ir++) {
+            double r = rgrid[ir];
+            rho[j](0, ir) = ((j == 0) ? 10 : 2) * std::exp(-2 * r) / y00;
+            for (int lm = 1; lm < lmmax; lm++) {
+                rho[j](lm, ir) = 0.1 * std::exp(-2 * r) * std::pow(r, l_by_lm[lm]) / (lm + 1);
+            }
+        }
+    }
+    std::vector<Flm const*> rho_ptr;
+    for (auto& e : rho) {
+        rho_ptr.push_back(&e);
+    }
+
+    std::vector<double> rho_core(rgrid.num_points());
+    for (int ir = 0; ir < rgrid.num_points(); ir++) {
+        rho_core[ir] = 5 * std::exp(-10 * rgrid[ir]);
+    }
+
+    std::vector<Flm> vxc;
+    for (int j = 0; j < num_mag_dims + 1; j++) {
+        vxc.emplace_back(lmmax, rgrid);
+    }
+    Flm exc(lmmax, rgrid);
+
+    double exc_tot{0};
+    auto num_arrays0 = sddk::num_host_allocations().load();
+    auto num_new0    = num_new.load();
+    double t = -utils::wtime();
+    for (int i = 0; i < repeat; i++) {
+        exc_tot = xc_mt_paw(xc_func, lmax, num_mag_dims, sht, rgrid, rho_ptr, rho_core, vxc, exc);
+    }
+    t += utils::wtime();
+    auto num_arrays = sddk::num_host_allocations().load() - num_arrays0;
+    auto num_news   = num_new.load() - num_new0;
+
+    double vxc_norm{0};
+    for (auto& e : vxc) {
+        vxc_norm += inner(e, e);
+    }
+
+    printf("lmax: %i, number of radial points: %i, number of angular points: %i, number of magnetic dimensions: %i\n",
+           lmax, rgrid.num_points(), sht.num_points(), num_mag_dims);
+    printf("XC energy: %18.12f, norm of Vxc: %18.12f\n", exc_tot, vxc_norm);
+    printf("time per call: %f sec.\n", t / repeat);
+    printf("allocations per call: %.1f arrays, %.1f calls to operator new\n", double(num_arrays) / repeat,
+           double(num_news) / repeat);
+
+    if (exc_tot != exc_tot || vxc_norm != vxc_norm) {
+        printf("NaN in the XC potential\n");
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argn, char** argv)
+{
+    cmd_args args;
+    args.register_key("--lmax=", "{int} maximum orbital quantum number of the expansion");
+    args.register_key("--num_points=", "{int} number of radial points");
+    args.register_key("--num_mag_dims=", "{int} number of magnetic dimensions (0, 1 or 3)");
+    args.register_key("--repeat=", "{int} number of repetitions");
+    args.register_key("--xc=", "{string list} names of the XC functionals");
+
+    args.parse_args(argn, argv);
+    if (args.exist("help")) {
+        printf("Usage: %s [options]\n", argv[0]);
+        args.print_help();
+        return 0;
+    }
+
+    sirius::initialize(1);
+    int result = test_xc_mt_paw(args);
+    sirius::finalize();
+
+    return result;
+}
@@ -1,4 +1,5 @@
 #include <sirius.hpp>
+#include "linalg/inverse_sqrt.hpp"
 
 using namespace sirius;
 using namespace sddk;
@@ -96,6 +97,41 @@ void test2()
         printf("test2 passed!\n");
     }
 }
+/* compare inverse square root computed with the eigen-decomposition and with the Newton-Schulz iteration */
+template <typename T>
+void test_inverse_sqrt()
+{
+    int N = 200;
+    la::dmatrix<T> A(N, N);
+    la::dmatrix<T> B(N, N);
+    /* diagonally dominant Hermitian matrix, similar to the overlap matrix of atomic orbitals */
+    for (int i = 0; i < N; i++) {
+        for (int j = 0; j <= i; j++) {
+            T v = (i == j) ? T(1) : utils::random<T>() * 0.2 / static_cast<double>(N);
+            A(j, i) = v;
+            A(i, j) = utils::conj(v);
+        }
+    }
+    sddk::copy(A, B);
+
+    auto Z1 = std::get<0>(inverse_sqrt(A, N));
+    auto Z2 = inverse_sqrt_newton_schulz(B, N, 1e-12);
+
+    double diff{0};
+    for (int i = 0; i < N; i++) {
+        for (int j = 0; j < N; j++) {
+            diff = std::max(diff, std::abs((*Z1)(j, i) - (*Z2)(j, i)));
+        }
+    }
+
+    if (diff > 1e-10) {
+        printf("test_inverse_sqrt failed! diff = %18.12e\n", diff);
+        exit(1);
+    } else {
+        printf("test_inverse_sqrt passed!\n");
+    }
+}
+
 //#ifdef SIRIUS_SCALAPACK
 //template <typename T>
 //void test3()
@@ -158,6 +194,8 @@ int main(int argn, char** argv)
     test1();
     test2<double>();
     test2<std::complex<double>>();
+    test_inverse_sqrt<double>();
+    test_inverse_sqrt<std::complex<double>>();
     //#ifdef SIRIUS_SCALAPACK
     //test3<std::complex<double>>();
     //#endif
@@ -0,0 +1,41 @@
+#include <complex>
+#include "utils/mapped_file.hpp"
+#include "testing.hpp"
+
+int run_test(cmd_args const& args)
+{
+    auto path = args.value<std::string>("path", ".");
+    int n = args.value<int>("n", 1 << 20);
+
+    utils::mapped_file f(path, n * sizeof(std::complex<double>));
+
+    auto ptr = static_cast<std::complex<double>*>(f.data());
+    for (int i = 0; i < n; i++) {
+        ptr[i] = std::complex<double>(i, -i);
+    }
+    /* release the second half and read it back */
+    size_t half = (n / 2) * sizeof(std::complex<double>);
+    f.evict(half, f.size() - half);
+    f.prefetch(half, f.size() - half);
+    for (int i = 0; i < n; i++) {
+        if (ptr[i] != std::complex<double>(i, -i)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main(int argn, char** argv)
+{
+    cmd_args args;
+    args.register_key("--path=", "{string} directory for the scratch file");
+    args.register_key("--n=", "{int} number of complex numbers");
+
+    args.parse_args(argn, argv);
+    if (args.exist("help")) {
+        printf("Usage: %s [options]\n", argv[0]);
+        args.print_help();
+        return 0;
+    }
+    return sirius::call_test(argv[0], run_test, args);
+}
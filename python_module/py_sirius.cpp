@@ -11,6 +11,7 @@
 #include <vector>
 #include <utility>
 #include <memory>
+#include <map>
 #include <stdexcept>
 #include <omp.h>
 #include <mpi.h>
@@ -22,6 +23,7 @@
 #include "unit_cell_accessors.hpp"
 #include "make_sirius_comm.hpp"
 #include "dft/smearing.hpp"
+#include "dft/multi_image.hpp"
 #include "wave_functions.hpp"
 
 using namespace pybind11::literals;
@@ -133,6 +135,121 @@ apply_hamiltonian(Hamiltonian0<double>& H0, K_point<double>& kp, wf::Wave_functi
     }
 }
 
+/// Persistent Hamiltonian operator for the Python minimisers.
+/** Hamiltonian0 and the k-point dependent parts of the Hamiltonian (beta-projectors, Hubbard operator) are created
+ *  once and stay valid until the potential changes; update() must be called after each new potential. The work
+ *  arrays for the input and output wave-functions are allocated once per local k-point. */
+class Hamiltonian_handle
+{
+  private:
+    Potential& potential_;
+    K_point_set& kset_;
+    std::unique_ptr<Hamiltonian0<double>> H0_;
+    /// Hamiltonian for each local k-point.
+    std::vector<std::unique_ptr<Hamiltonian_k<double>>> Hk_;
+    /// Work arrays for the input wave-functions.
+    std::vector<std::unique_ptr<wf::Wave_functions<double>>> psi_in_;
+    /// Work arrays for the output wave-functions.
+    std::vector<std::unique_ptr<wf::Wave_functions<double>>> psi_out_;
+
+  public:
+    using coeffs_t = std::map<std::pair<int, int>, py::array_t<complex_double, py::array::f_style | py::array::forcecast>>;
+
+    Hamiltonian_handle(Potential& potential__, K_point_set& kset__)
+        : potential_(potential__)
+        , kset_(kset__)
+    {
+        auto& ctx = kset_.ctx();
+        for (int ikloc = 0; ikloc < kset_.spl_num_kpoints().local_size(); ikloc++) {
+            auto kp = kset_.get<double>(kset_.spl_num_kpoints(ikloc));
+            for (auto psi : {&psi_in_, &psi_out_}) {
+                psi->emplace_back(std::make_unique<wf::Wave_functions<double>>(kp->gkvec_sptr(),
+                        wf::num_mag_dims(ctx.num_mag_dims()), wf::num_bands(ctx.num_bands()), sddk::memory_t::host));
+            }
+        }
+        this->update();
+    }
+
+    /// Refresh the Hamiltonian for a new potential.
+    void update()
+    {
+        /* destroy the old k-point Hamiltonians first, they reference H0 and hold the Hubbard operator */
+        Hk_.clear();
+        if (H0_) {
+            H0_->update(false);
+        } else {
+            H0_ = std::make_unique<Hamiltonian0<double>>(potential_, false);
+        }
+        for (int ikloc = 0; ikloc < kset_.spl_num_kpoints().local_size(); ikloc++) {
+            auto kp = kset_.get<double>(kset_.spl_num_kpoints(ikloc));
+            Hk_.emplace_back(std::make_unique<Hamiltonian_k<double>>(*H0_, *kp));
+        }
+    }
+
+    /// Apply Hamiltonian to the plane-wave coefficients of all local k-points.
+    /** Input is a dictionary {(ikloc, ispn): coefficients}; the output has the same structure. */
+    auto apply(coeffs_t const& cn__)
+    {
+        auto& ctx = kset_.ctx();
+
+        /* number of wave-functions for each local k-point */
+        std::vector<int> num_wf(Hk_.size(), 0);
+        for (auto const& e : cn__) {
+            int ikloc = e.first.first;
+            int ispn  = e.first.second;
+            auto& arr = e.second;
+            if (ikloc < 0 || ikloc >= static_cast<int>(Hk_.size()) || ispn < 0 || ispn >= psi_in_[ikloc]->num_sc() ||
+                arr.ndim() != 2 || arr.shape(0) != psi_in_[ikloc]->ld() || arr.shape(1) > psi_in_[ikloc]->num_wf()) {
+                throw std::runtime_error("Hamiltonian_handle::apply(): wrong input coefficients");
+            }
+            int nwf = static_cast<int>(arr.shape(1));
+            for (int i = 0; i < nwf; i++) {
+                std::copy(arr.data(0, i), arr.data(0, i) + arr.shape(0),
+                          psi_in_[ikloc]->at(sddk::memory_t::host, 0, wf::spin_index(ispn), wf::band_index(i)));
+            }
+            num_wf[ikloc] = std::max(num_wf[ikloc], nwf);
+        }
+
+        {
+            py::gil_scoped_release release;
+
+            for (int ikloc = 0; ikloc < static_cast<int>(Hk_.size()); ikloc++) {
+                if (num_wf[ikloc] == 0) {
+                    continue;
+                }
+                auto kp = kset_.get<double>(kset_.spl_num_kpoints(ikloc));
+                /* local operator is shared between k-points */
+                H0_->local_op().prepare_k(kp->gkvec_fft());
+
+                auto mg_in  = psi_in_[ikloc]->memory_guard(ctx.processing_unit_memory_t(), wf::copy_to::device);
+                auto mg_out = psi_out_[ikloc]->memory_guard(ctx.processing_unit_memory_t(), wf::copy_to::host);
+
+                for (int ispn_step = 0; ispn_step < ctx.num_spinors(); ispn_step++) {
+                    auto spins = wf::spin_range((ctx.num_mag_dims() == 3) ? 2 : ispn_step);
+                    Hk_[ikloc]->apply_h_s<complex_double>(spins, wf::band_range(0, num_wf[ikloc]), *psi_in_[ikloc],
+                            psi_out_[ikloc].get(), nullptr);
+                }
+            }
+        }
+
+        std::map<std::pair<int, int>, py::array_t<complex_double>> result;
+        for (auto const& e : cn__) {
+            int ikloc = e.first.first;
+            int ispn  = e.first.second;
+            int nrows = static_cast<int>(e.second.shape(0));
+            int ncols = static_cast<int>(e.second.shape(1));
+            py::array_t<complex_double> out({nrows, ncols},
+                                            {1 * sizeof(complex_double), nrows * sizeof(complex_double)});
+            for (int i = 0; i < ncols; i++) {
+                auto ptr = psi_out_[ikloc]->at(sddk::memory_t::host, 0, wf::spin_index(ispn), wf::band_index(i));
+                std::copy(ptr, ptr + nrows, out.mutable_data(0, i));
+            }
+            result[e.first] = std::move(out);
+        }
+        return result;
+    }
+};
+
 void
 initialize_subspace(DFT_ground_state& dft_gs, Simulation_context& ctx)
 {
@@ -358,7 +475,12 @@ PYBIND11_MODULE(py_sirius, m)
         .def(py::init<Simulation_context&>(), py::keep_alive<1, 2>(), "ctx"_a)
         .def("generate", &Potential::generate, "density"_a, "use_sym"_a, "transform_to_rg"_a)
         .def("symmetrize", py::overload_cast<>(&Potential::symmetrize))
-        .def("fft_transform", &Potential::fft_transform)
+        .def("fft_transform",
+             [](Potential& obj, int direction) {
+                 obj.fft_transform(direction);
+                 /* components might have been modified through f_pw_local() or f_rg() */
+                 obj.invalidate_theta_veff();
+             })
         .def("save", &Potential::save)
         .def("load", &Potential::load)
         .def_property("vxc", py::overload_cast<>(&Potential::xc_potential),
@@ -452,6 +574,17 @@ PYBIND11_MODULE(py_sirius, m)
         .def("update", &DFT_ground_state::update)
         .def("energy_kin_sum_pw", &DFT_ground_state::energy_kin_sum_pw);
 
+    py::class_<Multi_image>(m, "Multi_image")
+        .def(py::init<std::string const&, mpi::Communicator const&, int>(), "config"_a, "comm"_a, "num_groups"_a)
+        .def(
+            "find",
+            [](Multi_image& mi, std::vector<std::vector<std::array<double, 3>>> const& positions, bool warm_start) {
+                json js = mi.find(positions, warm_start);
+                return pj_convert(js);
+            },
+            "positions"_a, "warm_start"_a = true)
+        .def("ctx", &Multi_image::ctx, py::return_value_policy::reference_internal);
+
     py::class_<K_point<double>>(m, "K_point")
         .def("band_energy", py::overload_cast<int, int>(&K_point<double>::band_energy, py::const_))
         .def_property_readonly("vk", &K_point<double>::vk, py::return_value_policy::copy)
@@ -532,6 +665,12 @@ PYBIND11_MODULE(py_sirius, m)
     py::class_<Hamiltonian_k<double>>(m, "Hamiltonian_k")
         .def(py::init<Hamiltonian0<double>&, K_point<double>&>(), py::keep_alive<1, 2>(), py::keep_alive<1, 3>());
 
+    py::class_<Hamiltonian_handle>(m, "Hamiltonian_handle")
+        .def(py::init<Potential&, K_point_set&>(), "potential"_a, "kpointset"_a, py::keep_alive<1, 2>(),
+             py::keep_alive<1, 3>())
+        .def("update", &Hamiltonian_handle::update)
+        .def("apply", &Hamiltonian_handle::apply, "cn"_a);
+
     py::class_<Stress>(m, "Stress")
         .def(py::init<Simulation_context&, Density&, Potential&, K_point_set&>())
         .def("calc_stress_total", &Stress::calc_stress_total, py::return_value_policy::reference_internal)
@@ -6,7 +6,6 @@ from ..py_sirius import (
     Wave_functions,
     MemoryEnum,
     CopyEnum,
-    Hamiltonian0,
     total_energy
 )
 from ..coefficient_array import PwCoeffs
@@ -84,6 +83,8 @@ class Energy:
         self.potential.generate(
             self.density, use_sym=self.ctx.use_symmetry(), transform_to_rg=True
         )
+        # Hamiltonian must be rebuilt for the new potential
+        self.H.update()
 
         yn = self.H(X, scale=False)
 
@@ -118,6 +119,14 @@ class ApplyHamiltonian:
         assert not isinstance(potential, ApplyHamiltonian)
         self.potential = potential
         self.kpointset = kpointset
+        self._handle = None
+
+    def update(self):
+        """
+        Rebuild the Hamiltonian after the potential has changed.
+        """
+        if self._handle is not None:
+            self._handle.update()
 
     def apply(self, cn, scale=True, ki=None, ispn=None):
         """
@@ -125,48 +134,25 @@ class ApplyHamiltonian:
         cn -- input coefficient array
         """
         from ..coefficient_array import PwCoeffs
-        from ..py_sirius import apply_hamiltonian, num_mag_dims, num_bands
+        from ..py_sirius import Hamiltonian_handle
+
+        if self._handle is None:
+            self._handle = Hamiltonian_handle(self.potential, self.kpointset)
 
-        ctx = self.kpointset.ctx()
-        pmem_t = ctx.processing_unit_memory_t()
-        num_sc = ctx.num_spins()
-        H0 = Hamiltonian0(self.potential, False)
         if isinstance(cn, PwCoeffs):
             assert ki is None
             assert ispn is None
+            # apply to all k-points in one call
+            yn = self._handle.apply({key: np.asfortranarray(val) for key, val in cn.items()})
             out = PwCoeffs(dtype=cn.dtype)
-            for k, ispn_coeffs in cn.by_k().items():
-                kpoint = self.kpointset[k]
-                # spins might have different number of bands ...
-                # num_wf = max(ispn_coeffs, key=lambda x: x[1].shape[1])[1].shape[1]
-                md = num_mag_dims(ctx.num_mag_dims())
-                nb = num_bands(ctx.num_bands())
-                Psi_x = Wave_functions(
-                    kpoint.gkvec(), md, nb, MemoryEnum.host
-                )
-                Psi_y = Wave_functions(
-                    kpoint.gkvec(), md, nb, MemoryEnum.host
-                )
-                for i, val in ispn_coeffs:
-                    Psi_x.pw_coeffs(i)[:, : val.shape[1]] = val
-
-                apply_hamiltonian(H0, kpoint, Psi_y, Psi_x)
-
-                w = kpoint.weight()
-                # copy coefficients from Psi_y
-                for i, _ in ispn_coeffs:
-                    num_wf = cn[(k, i)].shape[1]
-                    if scale:
-                        bnd_occ = np.array(kpoint.band_occupancy(i))
-                        out[(k, i)] = (
-                            np.array(Psi_y.pw_coeffs(i), copy=False)[:, :num_wf]
-                            * bnd_occ
-                            * w
-                        )
-                    else:
-                        out[(k, i)] = np.array(Psi_y.pw_coeffs(i), copy=False)[
-                            :, :num_wf
-                        ]
+            for key, val in yn.items():
+                k, i = key
+                if scale:
+                    kpoint = self.kpointset[k]
+                    bnd_occ = np.array(kpoint.band_occupancy(i))[: val.shape[1]]
+                    out[key] = val * bnd_occ * kpoint.weight()
+                else:
+                    out[key] = val
             return out
 
     def __matmul__(self, cn):
@@ -26,6 +26,8 @@
 #define __HDF5_TREE_HPP__
 
 #include <fstream>
+#include <algorithm>
+#include <map>
 #include <hdf5.h>
 #include "memory.hpp"
 
@@ -37,6 +39,55 @@ enum class hdf5_access_t {
     read_only
 };
 
+/// Lossless compression filter of a chunked dataset.
+enum class hdf5_filter_t
+{
+    /// No compression.
+    none,
+
+    /// Deflate (zlib) compression, which is available in any HDF5 build.
+    deflate,
+
+    /// SZIP compression, available if HDF5 is built with libaec or szip.
+    szip,
+
+    /// Zstandard compression, available if the HDF5 zstd filter plugin (id 32015) can be loaded.
+    zstd
+};
+
+inline hdf5_filter_t get_hdf5_filter_t(std::string name__)
+{
+    std::transform(name__.begin(), name__.end(), name__.begin(), ::tolower);
+    std::map<std::string, hdf5_filter_t> const m = {
+        {"none", hdf5_filter_t::none},
+        {"deflate", hdf5_filter_t::deflate},
+        {"szip", hdf5_filter_t::szip},
+        {"zstd", hdf5_filter_t::zstd}
+    };
+
+    if (m.count(name__) == 0) {
+        std::stringstream s;
+        s << "get_hdf5_filter_t(): wrong label of the hdf5_filter_t enumerator: " << name__;
+        throw std::runtime_error(s.str());
+    }
+    return m.at(name__);
+}
+
+/// Storage layout of a dataset.
+/** The dataset is stored in chunks if the chunk dimensions are given or if a compression filter is set;
+ *  otherwise it is contiguous. Dimensions of the chunk follow the order of the array dimensions (first index
+ *  runs fastest) and are clamped to the dimensions of the dataset. If the chunk dimensions are not given,
+ *  chunks of about one megabyte are formed from the slowest dimensions of the array. */
+struct hdf5_layout_t
+{
+    /// Dimensions of the chunk.
+    std::vector<int> chunk;
+    /// Compression filter.
+    hdf5_filter_t filter{hdf5_filter_t::none};
+    /// Compression level of the deflate and zstd filters.
+    int level{4};
+};
+
 template <typename T>
 struct hdf5_type_wrapper;
 
@@ -110,6 +161,9 @@ class HDF5_tree
     /// True if this is a root node
     bool root_node_{true};
 
+    /// Default storage layout of the new datasets of this node and its branches.
+    hdf5_layout_t layout_;
+
     /// Auxiliary class to handle HDF5 Group object
     class HDF5_group
     {
@@ -174,6 +228,14 @@ class HDF5_tree
             }
         }
 
+        /// Constructor which gets the dataspace of the existing dataset.
+        explicit HDF5_dataspace(hid_t dataset_id__)
+        {
+            if ((id_ = H5Dget_space(dataset_id__)) < 0) {
+                TERMINATE("error in H5Dget_space()");
+            }
+        }
+
         /// Destructor.
         ~HDF5_dataspace()
         {
@@ -189,6 +251,138 @@ class HDF5_tree
         }
     };
 
+    /// Auxiliary class to handle HDF5 dataset creation property list
+    class HDF5_dataset_properties
+    {
+      private:
+        /// HDF5 id of the current object
+        hid_t id_;
+
+        /// Check if the filter is registered and can be used for writing.
+        static bool filter_avail(H5Z_filter_t filter__)
+        {
+            if (H5Zfilter_avail(filter__) <= 0) {
+                return false;
+            }
+            unsigned int config{0};
+            if (H5Zget_filter_info(filter__, &config) < 0) {
+                return false;
+            }
+            return (config & H5Z_FILTER_CONFIG_ENCODE_ENABLED) != 0;
+        }
+
+      public:
+        /// Registered id of the zstd filter plugin.
+        static const H5Z_filter_t zstd_filter_id = 32015;
+
+        /// Constructor which creates the property list of a given layout.
+        /** \param [in] dims__       Dimensions of the dataset.
+         *  \param [in] layout__     Storage layout.
+         *  \param [in] type_size__  Size of the dataset element in bytes.
+         */
+        HDF5_dataset_properties(std::vector<int> const& dims__, hdf5_layout_t const& layout__, size_t type_size__)
+        {
+            if ((id_ = H5Pcreate(H5P_DATASET_CREATE)) < 0) {
+                TERMINATE("error in H5Pcreate()");
+            }
+
+            size_t size{1};
+            for (auto d : dims__) {
+                size *= d;
+            }
+            /* empty datasets are always contiguous */
+            if (size == 0 || (layout__.chunk.empty() && layout__.filter == hdf5_filter_t::none)) {
+                return;
+            }
+
+            int ndims = static_cast<int>(dims__.size());
+            std::vector<hsize_t> chunk(ndims);
+            if (layout__.chunk.size()) {
+                if (static_cast<int>(layout__.chunk.size()) != ndims) {
+                    TERMINATE("wrong number of chunk dimensions");
+                }
+                for (int i = 0; i < ndims; i++) {
+                    chunk[i] = std::max(1, std::min(layout__.chunk[i], dims__[i]));
+                }
+            } else {
+                /* about 1Mb in a chunk; keep the fastest dimensions whole and split the slowest */
+                size_t target = std::max(size_t(1), (size_t(1) << 20) / type_size__);
+                for (int i = 0; i < ndims; i++) {
+                    chunk[i] = dims__[i];
+                }
+                size_t chunk_size = size;
+                for (int i = ndims - 1; i >= 0 && chunk_size > target; i--) {
+                    size_t rest = chunk_size / chunk[i];
+                    chunk[i]    = std::max(size_t(1), target / rest);
+                    chunk_size  = rest * chunk[i];
+                }
+            }
+            size_t chunk_size{1};
+            for (auto c : chunk) {
+                chunk_size *= c;
+            }
+            /* HDF5 stores the slowest index first */
+            std::reverse(chunk.begin(), chunk.end());
+            if (H5Pset_chunk(id_, ndims, chunk.data()) < 0) {
+                TERMINATE("error in H5Pset_chunk()");
+            }
+
+            auto filter = layout__.filter;
+            /* szip encodes blocks of 16 elements */
+            if (filter == hdf5_filter_t::szip && !(filter_avail(H5Z_FILTER_SZIP) && chunk_size >= 32)) {
+                filter = hdf5_filter_t::deflate;
+            }
+            if (filter == hdf5_filter_t::zstd && !filter_avail(zstd_filter_id)) {
+                filter = hdf5_filter_t::deflate;
+            }
+            if (filter == hdf5_filter_t::deflate && !filter_avail(H5Z_FILTER_DEFLATE)) {
+                filter = hdf5_filter_t::none;
+            }
+
+            switch (filter) {
+                case hdf5_filter_t::none: {
+                    break;
+                }
+                case hdf5_filter_t::deflate: {
+                    /* byte shuffle makes floating point data much more compressible */
+                    if (H5Pset_shuffle(id_) < 0 ||
+                        H5Pset_deflate(id_, static_cast<unsigned int>(std::max(0, std::min(layout__.level, 9)))) < 0) {
+                        TERMINATE("error in H5Pset_deflate()");
+                    }
+                    break;
+                }
+                case hdf5_filter_t::szip: {
+                    if (H5Pset_szip(id_, H5_SZIP_NN_OPTION_MASK, 16) < 0) {
+                        TERMINATE("error in H5Pset_szip()");
+                    }
+                    break;
+                }
+                case hdf5_filter_t::zstd: {
+                    unsigned int level = std::max(1, std::min(layout__.level, 22));
+                    if (H5Pset_shuffle(id_) < 0 ||
+                        H5Pset_filter(id_, zstd_filter_id, H5Z_FLAG_OPTIONAL, 1, &level) < 0) {
+                        TERMINATE("error in H5Pset_filter()");
+                    }
+                    break;
+                }
+            }
+        }
+
+        /// Destructor.
+        ~HDF5_dataset_properties()
+        {
+            if (H5Pclose(id_) < 0) {
+                TERMINATE("error in H5Pclose()");
+            }
+        }
+
+        /// Return HDF5 id of the current object.
+        inline hid_t id() const
+        {
+            return id_;
+        }
+    };
+
     /// Auxiliary class to handle HDF5 Dataset object
     class HDF5_dataset
     {
@@ -206,9 +400,10 @@ class HDF5_tree
         }
 
         /// Constructor which creates the new dataset object.
-        HDF5_dataset(HDF5_group& group, HDF5_dataspace& dataspace, const std::string& name, hid_t type_id)
+        HDF5_dataset(HDF5_group& group, HDF5_dataspace& dataspace, const std::string& name, hid_t type_id,
+                     hid_t dcpl_id = H5P_DEFAULT)
         {
-            if ((id_ = H5Dcreate(group.id(), name.c_str(), type_id, dataspace.id(), H5P_DEFAULT, H5P_DEFAULT,
+            if ((id_ = H5Dcreate(group.id(), name.c_str(), type_id, dataspace.id(), H5P_DEFAULT, dcpl_id,
                                  H5P_DEFAULT)) < 0) {
                 TERMINATE("error in H5Dcreate()");
             }
@@ -230,16 +425,24 @@ class HDF5_tree
     };
 
     /// Constructor to create branches of the HDF5 tree.
-    HDF5_tree(hid_t file_id__, const std::string& path__)
+    HDF5_tree(hid_t file_id__, const std::string& path__, hdf5_layout_t const& layout__)
         : path_(path__)
         , file_id_(file_id__)
         , root_node_(false)
+        , layout_(layout__)
     {
     }
 
-    /// Write a multidimensional array.
+    /// Write a multidimensional array with the default layout of the node.
     template <typename T>
     void write(const std::string& name, T const* data, std::vector<int> const& dims)
+    {
+        write(name, data, dims, layout_);
+    }
+
+    /// Write a multidimensional array with a given layout.
+    template <typename T>
+    void write(const std::string& name, T const* data, std::vector<int> const& dims, hdf5_layout_t const& layout)
     {
         /* open group */
         HDF5_group group(file_id_, path_);
@@ -247,8 +450,11 @@ class HDF5_tree
         /* make dataspace */
         HDF5_dataspace dataspace(dims);
 
+        /* chunks and filters */
+        HDF5_dataset_properties dcpl(dims, layout, sizeof(T));
+
         /* create new dataset */
-        HDF5_dataset dataset(group, dataspace, name, hdf5_type_wrapper<T>::type_id());
+        HDF5_dataset dataset(group, dataspace, name, hdf5_type_wrapper<T>::type_id(), dcpl.id());
 
         /* write data */
         if (H5Dwrite(dataset.id(), hdf5_type_wrapper<T>::type_id(), dataspace.id(), H5S_ALL, H5P_DEFAULT, data) < 0) {
@@ -323,6 +529,83 @@ class HDF5_tree
         }
     }
 
+    /// Set the default storage layout of the new datasets of this node and its branches.
+    inline void set_layout(hdf5_layout_t const& layout__)
+    {
+        layout_ = layout__;
+    }
+
+    /// Return the default storage layout of the new datasets.
+    inline auto const& layout() const
+    {
+        return layout_;
+    }
+
+    /// Return dimensions of the existing dataset.
+    /** Dimensions are returned in the order of the array dimensions (first index runs fastest). */
+    std::vector<int> dims(std::string const& name__)
+    {
+        HDF5_group group(file_id_, path_);
+
+        HDF5_dataset dataset(group.id(), name__);
+
+        HDF5_dataspace dataspace(dataset.id());
+
+        int ndims = H5Sget_simple_extent_ndims(dataspace.id());
+        if (ndims < 0) {
+            TERMINATE("error in H5Sget_simple_extent_ndims()");
+        }
+        std::vector<hsize_t> d(ndims);
+        H5Sget_simple_extent_dims(dataspace.id(), d.data(), NULL);
+
+        std::vector<int> result(ndims);
+        for (int i = 0; i < ndims; i++) {
+            result[ndims - i - 1] = static_cast<int>(d[i]);
+        }
+        return result;
+    }
+
+    /// Read a block of a multidimensional array.
+    /** Only the hyperslab of the dataset is read, so for the chunked datasets only the chunks that overlap with
+     *  the block are decompressed.
+     *
+     *  \param [in]  name__    Name of the dataset.
+     *  \param [out] data__    Block of the array, stored contiguously.
+     *  \param [in]  offset__  Starting index of the block along each dimension.
+     *  \param [in]  count__   Size of the block along each dimension.
+     */
+    template <typename T>
+    void read(std::string const& name__, T* data__, std::vector<int> const& offset__, std::vector<int> const& count__)
+    {
+        HDF5_group group(file_id_, path_);
+
+        HDF5_dataset dataset(group.id(), name__);
+
+        HDF5_dataspace file_space(dataset.id());
+
+        int ndims = static_cast<int>(count__.size());
+        if (H5Sget_simple_extent_ndims(file_space.id()) != ndims || static_cast<int>(offset__.size()) != ndims) {
+            TERMINATE("wrong number of dimensions of the block");
+        }
+
+        std::vector<hsize_t> start(ndims);
+        std::vector<hsize_t> count(ndims);
+        for (int i = 0; i < ndims; i++) {
+            start[ndims - i - 1] = offset__[i];
+            count[ndims - i - 1] = count__[i];
+        }
+        if (H5Sselect_hyperslab(file_space.id(), H5S_SELECT_SET, start.data(), NULL, count.data(), NULL) < 0) {
+            TERMINATE("error in H5Sselect_hyperslab()");
+        }
+
+        HDF5_dataspace mem_space(count__);
+
+        if (H5Dread(dataset.id(), hdf5_type_wrapper<T>::type_id(), mem_space.id(), file_space.id(), H5P_DEFAULT,
+                    data__) < 0) {
+            TERMINATE("error in H5Dread()");
+        }
+    }
+
     /// Create node by integer index.
     /** Create node at the current location using integer index as a name. */
     HDF5_tree create_node(int idx)
@@ -366,6 +649,33 @@ class HDF5_tree
         write(name__, data__.at(memory_t::host), dims);
     }
 
+    /// Write a multidimensional complex array by name with a given layout.
+    template <typename T, int N>
+    void write(const std::string& name, mdarray<std::complex<T>, N> const& data, hdf5_layout_t const& layout)
+    {
+        std::vector<int> dims(N + 1);
+        dims[0] = 2;
+        for (int i = 0; i < N; i++) {
+            dims[i + 1] = (int)data.size(i);
+        }
+        auto l = layout;
+        if (l.chunk.size()) {
+            l.chunk.insert(l.chunk.begin(), 2);
+        }
+        write(name, (T*)data.at(memory_t::host), dims, l);
+    }
+
+    /// Write a multidimensional array by name with a given layout.
+    template <typename T, int N>
+    void write(std::string const& name__, mdarray<T, N> const& data__, hdf5_layout_t const& layout__)
+    {
+        std::vector<int> dims(N);
+        for (int i = 0; i < N; i++) {
+            dims[i] = static_cast<int>(data__.size(i));
+        }
+        write(name__, data__.at(memory_t::host), dims, layout__);
+    }
+
     /// Write a multidimensional array by integer index.
     template <typename T, int N>
     void write(int name_id, mdarray<T, N> const& data)
@@ -383,6 +693,15 @@ class HDF5_tree
         write(name, data, dims);
     }
 
+    /// Write a buffer with a given layout.
+    template <typename T>
+    void write(const std::string& name, T const* data, int size, hdf5_layout_t const& layout)
+    {
+        std::vector<int> dims(1);
+        dims[0] = size;
+        write(name, data, dims, layout);
+    }
+
     /// Write a scalar.
     template <typename T>
     void write(const std::string& name, T data)
@@ -428,6 +747,33 @@ class HDF5_tree
         read(name, data.at(memory_t::host), dims);
     }
 
+    /// Read a block of a multidimensional complex array.
+    /** The block starts at offset__ and has the dimensions of data__. */
+    template <int N>
+    void read(const std::string& name, mdarray<std::complex<double>, N>& data, std::vector<int> const& offset)
+    {
+        std::vector<int> count(N + 1);
+        std::vector<int> offs(N + 1, 0);
+        count[0] = 2;
+        for (int i = 0; i < N; i++) {
+            count[i + 1] = (int)data.size(i);
+            offs[i + 1]  = offset[i];
+        }
+        read(name, (double*)data.at(memory_t::host), offs, count);
+    }
+
+    /// Read a block of a multidimensional array.
+    /** The block starts at offset__ and has the dimensions of data__. */
+    template <typename T, int N>
+    void read(const std::string& name, mdarray<T, N>& data, std::vector<int> const& offset)
+    {
+        std::vector<int> count(N);
+        for (int i = 0; i < N; i++) {
+            count[i] = (int)data.size(i);
+        }
+        read(name, data.at(memory_t::host), offset, count);
+    }
+
     template <typename T, int N>
     void read(int name_id, mdarray<T, N>& data)
     {
@@ -460,7 +806,7 @@ class HDF5_tree
     HDF5_tree operator[](const std::string& path__)
     {
         std::string new_path = path_ + path__ + "/";
-        return HDF5_tree(file_id_, new_path);
+        return HDF5_tree(file_id_, new_path, layout_);
     }
 
     HDF5_tree operator[](int idx)
@@ -468,7 +814,7 @@ class HDF5_tree
         std::stringstream s;
         s << idx;
         std::string new_path = path_ + s.str() + "/";
-        return HDF5_tree(file_id_, new_path);
+        return HDF5_tree(file_id_, new_path, layout_);
     }
 };
 
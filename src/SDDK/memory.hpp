@@ -35,6 +35,7 @@
 #include <array>
 #include <complex>
 #include <cassert>
+#include <atomic>
 #include "gpu/acc.hpp"
 
 namespace sddk {
@@ -148,6 +149,14 @@ inline device_t get_device_t(std::string name__)
      return m.at(name__);
 }
 
+/// Number of host memory blocks allocated by allocate().
+/** Used by the tests to count the temporary arrays created in a given piece of code. */
+inline std::atomic<size_t>& num_host_allocations()
+{
+    static std::atomic<size_t> n{0};
+    return n;
+}
+
 /// Allocate n elements in a specified memory.
 /** Allocate a memory block of the memory_t type. Return a nullptr if this memory is not available, otherwise
  *  return a pointer to an allocated block. */
@@ -159,6 +168,7 @@ inline T* allocate(size_t n__, memory_t M__)
             return nullptr;
         }
         case memory_t::host: {
+            num_host_allocations().fetch_add(1, std::memory_order_relaxed);
             return static_cast<T*>(std::malloc(n__ * sizeof(T)));
         }
         case memory_t::host_pinned: {
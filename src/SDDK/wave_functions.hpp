@@ -27,12 +27,14 @@
 
 #include <cstdlib>
 #include <iostream>
+#include <map>
 #include <costa/layout.hpp>
 #include <costa/grid2grid/transformer.hpp>
 #include "linalg/linalg.hpp"
 #include "SDDK/hdf5_tree.hpp"
 #include "fft/gvec.hpp"
 #include "utils/env.hpp"
+#include "utils/mapped_file.hpp"
 #include "utils/rte.hpp"
 #include "strong_type.hpp"
 
@@ -333,6 +335,15 @@ class Wave_functions_base
     /** Wave-functions are stored as two independent arrays for spin-up and spin-dn. The planewave and muffin-tin
         coefficients are stored consecutively. */
     std::array<sddk::mdarray<std::complex<T>, 2>, 2> data_;
+    /// Scratch file which holds the host data in the out-of-core mode.
+    std::unique_ptr<utils::mapped_file> mapped_file_;
+
+    /// Byte range of the band range in the mapped file for a given spin component.
+    inline auto mapped_range(int is__, band_range br__) const
+    {
+        size_t sz = sizeof(std::complex<T>) * this->ld();
+        return std::make_pair(sz * (static_cast<size_t>(is__) * num_wf_.get() + br__.begin()), sz * br__.size());
+    }
 
   public:
     /// Constructor.
@@ -475,6 +486,65 @@ class Wave_functions_base
             data_[s].copy_to(mem__);
         }
     }
+
+    /// Move the host data to a memory-mapped scratch file in a given directory.
+    /** After this call the host coefficients are paged in from the file on demand. The residency of the bands
+     *  can be steered with prefetch() and evict(). Device buffers are not affected. */
+    inline void
+    map_to_file(std::string const& dir__)
+    {
+        if (mapped_file_) {
+            return;
+        }
+        size_t sz = static_cast<size_t>(this->ld()) * num_wf_.get();
+        auto f = std::make_unique<utils::mapped_file>(dir__, sizeof(std::complex<T>) * sz * num_sc_.get());
+        for (int is = 0; is < num_sc_.get(); is++) {
+            auto ptr = static_cast<std::complex<T>*>(f->data()) + is * sz;
+            if (sz) {
+                std::copy(data_[is].at(sddk::memory_t::host), data_[is].at(sddk::memory_t::host) + sz, ptr);
+            }
+            data_[is] = sddk::mdarray<std::complex<T>, 2>(ptr, this->ld(), num_wf_.get(), "Wave_functions_base::data_");
+        }
+        mapped_file_ = std::move(f);
+    }
+
+    /// Return true if the host data is stored in a memory-mapped file.
+    inline bool
+    is_mapped() const
+    {
+        return mapped_file_ != nullptr;
+    }
+
+    /// Start an asynchronous read of a band range from the scratch file.
+    inline void
+    prefetch(band_range br__) const
+    {
+        if (mapped_file_) {
+            for (int is = 0; is < num_sc_.get(); is++) {
+                auto r = mapped_range(is, br__);
+                mapped_file_->prefetch(r.first, r.second);
+            }
+        }
+    }
+
+    /// Write back a band range to the scratch file and release it from the resident memory.
+    inline void
+    evict(band_range br__) const
+    {
+        if (mapped_file_) {
+            for (int is = 0; is < num_sc_.get(); is++) {
+                auto r = mapped_range(is, br__);
+                mapped_file_->evict(r.first, r.second);
+            }
+        }
+    }
+
+    /// Size of the host data in bytes.
+    inline size_t
+    size_in_bytes() const
+    {
+        return sizeof(std::complex<T>) * this->ld() * num_wf_.get() * num_sc_.get();
+    }
 };
 
 /// Wave-functions for the muffin-tin part of LAPW.
@@ -1183,6 +1253,76 @@ class Wave_functions_fft : public Wave_functions_base<T>
     }
 };
 
+/// Storage for the real-space wave-functions.
+/** Wave-functions transformed to real space during the density generation can be reused by the next application
+ *  of the local Hamiltonian, which saves one backward FFT per band. The stored functions carry no information about
+ *  the plane-wave coefficients they were computed from; they are valid only as long as the wave-functions of the
+ *  k-point are not changed. For this reason the storage is used only in the first step of the next band solve, where
+ *  the trial functions phi(0:num_bands) are the exact copy of psi(0:num_bands), and it is cleared right after the
+ *  band solve or when the wave-functions are initialized. The total size of the stored functions is limited by the
+ *  memory budget. */
+template <typename T>
+class Wave_functions_rg_cache
+{
+  private:
+    /// Maximum size of the stored data in bytes.
+    size_t max_size_{0};
+    /// Current size of the stored data in bytes.
+    size_t size_{0};
+    /// Real-space values of each (spin, band) pair.
+    std::map<std::pair<int, int>, sddk::mdarray<T, 1>> data_;
+
+  public:
+    /// Remove all stored functions and set the new memory budget.
+    void reset(size_t max_size__)
+    {
+        data_.clear();
+        size_     = 0;
+        max_size_ = max_size__;
+    }
+
+    void clear()
+    {
+        this->reset(0);
+    }
+
+    inline bool empty() const
+    {
+        return data_.empty();
+    }
+
+    /// Store the real-space function of n values for a given spin and band.
+    /** Return false if there is no more space left. */
+    bool put(spin_index ispn__, band_index j__, T const* f__, int n__)
+    {
+        auto key = std::make_pair(ispn__.get(), j__.get());
+        auto it  = data_.find(key);
+        if (it != data_.end()) {
+            size_ -= sizeof(T) * it->second.size();
+            data_.erase(it);
+        }
+        size_t sz = sizeof(T) * n__;
+        if (size_ + sz > max_size_) {
+            return false;
+        }
+        auto& e = data_[key];
+        e       = sddk::mdarray<T, 1>(n__);
+        std::copy(f__, f__ + n__, e.at(sddk::memory_t::host));
+        size_ += sz;
+        return true;
+    }
+
+    /// Return pointer to the real-space function or nullptr if it was not stored.
+    T const* find(spin_index ispn__, band_index j__) const
+    {
+        auto it = data_.find(std::make_pair(ispn__.get(), j__.get()));
+        if (it == data_.end()) {
+            return nullptr;
+        }
+        return it->second.at(sddk::memory_t::host);
+    }
+};
+
 /// For real-type F (double or float).
 template <typename T, typename F>
 static inline std::enable_if_t<std::is_scalar<F>::value, F>
@@ -1441,6 +1441,7 @@ sirius_set_periodic_function(void* const* handler__, char const* label__, double
                 smooth_periodic_function_ptr_t<double> rg_ptr(f_rg__, size_x, size_y, size_z, offset_z);
                 copy(rg_ptr, func_map[label]->rg());
             }
+            gs.potential().invalidate_theta_veff();
         },
         error_code__);
 }
@@ -2630,6 +2631,7 @@ sirius_set_pw_coeffs(void* const* handler__, char const* label__, std::complex<d
                 if (transform_to_rg__ && *transform_to_rg__) {
                     func.at(label)->fft_transform(1);
                 }
+                gs.potential().invalidate_theta_veff();
             }
         },
         error_code__);
@@ -5240,6 +5242,7 @@ sirius_set_rg_values(void* const* handler__, char const* label__, int const* gri
             if (transform_to_pw__ && *transform_to_pw__) {
                 f->fft_transform(-1);
             }
+            gs.potential().invalidate_theta_veff();
         },
         error_code__);
 }
@@ -5342,7 +5345,7 @@ sirius_get_rg_values(void* const* handler__, char const* label__, int const* gri
                 if (rank == fft_comm.rank()) {
                     std::copy(&f->value(0), &f->value(0) + f->spfft().local_slice_size(), &buf[0]);
                 }
-                fft_comm.bcast(&buf[0], static_cast<int>(buf.size()), rank);
+                fft_comm.bcast(&buf[0], buf.size(), rank);
 
                 /* ranks on the F90 side */
                 int r = comm.rank();
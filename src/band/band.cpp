@@ -56,6 +56,8 @@ Band::initialize_subspace(K_point_set& kset__, Hamiltonian0<T>& H0__) const
     for (int ikloc = 0; ikloc < kset__.spl_num_kpoints().local_size(); ikloc++) {
         int ik  = kset__.spl_num_kpoints(ikloc);
         auto kp = kset__.get<T>(ik);
+        /* wave-functions are replaced; real-space copies from the last density generation are not valid */
+        kp->psi_rg_cache().clear();
         auto Hk = H0__(*kp);
         if (ctx_.gamma_point() && (ctx_.so_correction() == false)) {
             ::sirius::initialize_subspace<T, T>(Hk, N);
@@ -203,17 +203,38 @@ davidson(Hamiltonian_k<T>& Hk__, wf::num_bands num_bands__, wf::num_mag_dims num
 
     /* auxiliary wave-functions */
     auto phi = wave_function_factory(ctx, kp, wf::num_bands(num_phi), num_md, mt_part);
-    mg.emplace_back(phi->memory_guard(mem));
 
     /* Hamiltonian, applied to auxiliary wave-functions */
     std::unique_ptr<wf_t> hphi{nullptr};
     if (what == davidson_evp_t::hamiltonian) {
         hphi = wave_function_factory(ctx, kp, wf::num_bands(num_phi), num_md, mt_part);
-        mg.emplace_back(hphi->memory_guard(mem));
     }
 
     /* S operator, applied to auxiliary wave-functions */
     auto sphi = wave_function_factory(ctx, kp, wf::num_bands(num_phi), num_md, mt_part);
+
+    /* out-of-core mode: the subspace is kept in the scratch files if it doesn't fit into the memory limit
+     * together with the wave-functions */
+    bool ooc{false};
+    if (!ctx.cfg().control().ooc_path().empty()) {
+        size_t n = psi__.size_in_bytes() + phi->size_in_bytes() * (hphi ? 3 : 2);
+        if (n > ctx.cfg().control().ooc_memory_limit() * std::pow(2, 30)) {
+            ooc = true;
+            for (auto w : {phi.get(), hphi.get(), sphi.get()}) {
+                if (w) {
+                    w->map_to_file(ctx.cfg().control().ooc_path());
+                }
+            }
+            if (verbosity__ >= 1) {
+                RTE_OUT(out__) << "subspace of " << (n >> 20) << " Mb is stored in "
+                               << ctx.cfg().control().ooc_path() << std::endl;
+            }
+        }
+    }
+    mg.emplace_back(phi->memory_guard(mem));
+    if (hphi) {
+        mg.emplace_back(hphi->memory_guard(mem));
+    }
     mg.emplace_back(sphi->memory_guard(mem));
 
     /* Hamiltonain, applied to new Psi wave-functions */
@@ -396,7 +417,11 @@ davidson(Hamiltonian_k<T>& Hk__, wf::num_bands num_bands__, wf::num_mag_dims num
                                 *sphi_extra, s, wf::band_range(0, num_extra_phi));
                     }
                 } else {
-                    Hk__.template apply_h_s<F>(sr, wf::band_range(0, num_bands__.get()), *phi, hphi.get(), sphi.get());
+                    /* phi(0:num_bands) is the copy of psi, so the real-space wave-functions stored in the last
+                     * density generation can be used; this is the only place where they are valid */
+                    auto psi_rg = (&psi__ == &kp.spinor_wave_functions()) ? &kp.psi_rg_cache() : nullptr;
+                    Hk__.template apply_h_s<F>(sr, wf::band_range(0, num_bands__.get()), *phi, hphi.get(), sphi.get(),
+                            psi_rg);
                 }
                 break;
             }
@@ -583,6 +608,12 @@ davidson(Hamiltonian_k<T>& Hk__, wf::num_bands num_bands__, wf::num_mag_dims num
                 num_lockable           = result.num_consecutive_smallest_converged;
                 current_frobenius_norm = result.frobenius_norm;
 
+                /* hphi is not needed until the orthogonalization of the new block: release it and read it back
+                 * while the Hamiltonian is applied to the new block */
+                if (ooc && hphi) {
+                    hphi->evict(wf::band_range(0, N));
+                }
+
                 /* set the relative tolerance convergence criterion */
                 if (iter_step == 0) {
                     relative_frobenius_tolerance = std::abs(current_frobenius_norm) * itso.relative_tolerance();
@@ -740,6 +771,9 @@ davidson(Hamiltonian_k<T>& Hk__, wf::num_bands num_bands__, wf::num_mag_dims num
              *
              * N is the number of previous basis functions
              * expand_with is the number of new basis functions */
+            if (ooc && hphi) {
+                hphi->prefetch(wf::band_range(0, N));
+            }
             switch (what) {
                 case davidson_evp_t::hamiltonian: {
                     if (ctx.full_potential()) {
@@ -400,6 +400,32 @@ void Band::diag_full_potential_second_variation(Hamiltonian_k<double>& Hk__) con
 
     auto mem = ctx_.processing_unit_memory_t();
 
+    /* number of second-variational states to compute for a given spin channel; in the partial-spectrum mode
+     * these are the states occupied in the previous iteration (or estimated from the number of electrons)
+     * plus a number of empty states */
+    auto num_sv_states = [&](int ispn__, int matrix_size__)
+    {
+        if (!ctx_.cfg().settings().sv_partial()) {
+            return matrix_size__;
+        }
+        int n_est = static_cast<int>(std::ceil(ctx_.unit_cell().num_valence_electrons() /
+                                               (ctx_.max_occupancy() * ctx_.num_spinors())));
+        int n_occ = std::max(kp.num_occupied_bands(ispn__), n_est);
+        return std::max(1, std::min(matrix_size__, n_occ + ctx_.cfg().settings().sv_num_empty_states()));
+    };
+
+    /* states above nev are not computed: their eigen-vectors are set to zero and their energies are placed
+     * far above the computed spectrum; this way they get zero occupancy for any smearing, do not contribute
+     * to the band and entropy sums and do not increase the number of occupied bands of the next iteration */
+    auto complete_spectrum = [&](int ispn__, int nev__, int matrix_size__)
+    {
+        /* shift of the uncomputed states with respect to the highest computed eigen-value (Ha) */
+        const double de{1e3};
+        for (int j = nev__; j < matrix_size__; j++) {
+            band_energies(j, ispn__) = band_energies(nev__ - 1, ispn__) + de;
+        }
+    };
+
     if (ctx_.num_mag_dims() != 3) {
         la::dmatrix<std::complex<double>> h(nfv, nfv, ctx_.blacs_grid(), bs, bs);
         if (ctx_.blacs_grid().comm().size() == 1 && ctx_.processing_unit() == sddk::device_t::GPU) {
@@ -426,7 +452,12 @@ void Band::diag_full_potential_second_variation(Hamiltonian_k<double>& Hk__) con
                 h.add(i, i, kp.fv_eigen_value(i));
             }
             PROFILE("sirius::Band::diag_sv|stdevp");
-            std_solver.solve(nfv, nfv, h, &band_energies(0, ispn), kp.sv_eigen_vectors(ispn));
+            int nev = num_sv_states(ispn, nfv);
+            if (nev < nfv) {
+                kp.sv_eigen_vectors(ispn).zero();
+            }
+            std_solver.solve(nfv, nev, h, &band_energies(0, ispn), kp.sv_eigen_vectors(ispn));
+            complete_spectrum(ispn, nev, nfv);
         }
     } else {
         int nb = ctx_.num_bands();
@@ -456,7 +487,12 @@ void Band::diag_full_potential_second_variation(Hamiltonian_k<double>& Hk__) con
             h.add(i + nfv, i + nfv, kp.fv_eigen_value(i));
         }
         PROFILE("sirius::Band::diag_sv|stdevp");
-        std_solver.solve(nb, nb, h, &band_energies(0, 0), kp.sv_eigen_vectors(0));
+        int nev = num_sv_states(0, nb);
+        if (nev < nb) {
+            kp.sv_eigen_vectors(0).zero();
+        }
+        std_solver.solve(nb, nev, h, &band_energies(0, 0), kp.sv_eigen_vectors(0));
+        complete_spectrum(0, nev, nb);
     }
 
     for (int ispn = 0; ispn < ctx_.num_spinors(); ispn++) {
@@ -105,6 +105,8 @@ Band::solve_pseudo_potential(Hamiltonian_k<T>& Hk__, double itsol_tol__, double
                 wf::num_mag_dims(ctx_.num_mag_dims()), kp.spinor_wave_functions(), tolerance,
                 itso.residual_tolerance(), itso.num_steps(), itso.locking(), itso.subspace_size(),
                 itso.converge_by_energy(), itso.extra_ortho(), *out, 0);
+        /* wave-functions have changed; real-space copies are not needed any more */
+        kp.psi_rg_cache().clear();
         niter = result.niter;
         for (int ispn = 0; ispn < ctx_.num_spinors(); ispn++) {
             for (int j = 0; j < ctx_.num_bands(); j++) {
@@ -148,6 +150,11 @@ Band::solve(K_point_set& kset__, Hamiltonian0<T>& H0__, double itsol_tol__) cons
         int ik  = kset__.spl_num_kpoints(ikloc);
         auto kp = kset__.get<T>(ik);
 
+        /* in the out-of-core mode read the wave-functions of the next k-point while this one is processed */
+        if (ikloc + 1 < kset__.spl_num_kpoints().local_size()) {
+            kset__.get<T>(kset__.spl_num_kpoints(ikloc + 1))->prefetch_wave_functions();
+        }
+
         auto Hk = H0__(*kp);
         if (ctx_.full_potential()) {
             solve_full_potential<T>(Hk, itsol_tol__);
@@ -158,6 +165,7 @@ Band::solve(K_point_set& kset__, Hamiltonian0<T>& H0__, double itsol_tol__) cons
                 num_dav_iter += solve_pseudo_potential<T, std::complex<F>>(Hk, itsol_tol__, empy_tol);
             }
         }
+        kp->evict_wave_functions();
     }
     kset__.comm().allreduce(&num_dav_iter, 1);
     ctx_.num_itsol_steps(num_dav_iter);
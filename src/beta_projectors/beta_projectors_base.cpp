@@ -102,7 +102,8 @@ void Beta_projectors_base<T>::split_in_chunks()
 }
 
 template <typename T>
-Beta_projectors_base<T>::Beta_projectors_base(Simulation_context& ctx__, fft::Gvec const& gkvec__, int N__)
+Beta_projectors_base<T>::Beta_projectors_base(Simulation_context& ctx__, fft::Gvec const& gkvec__, int N__,
+                                              int num_comp_t__)
     : ctx_(ctx__)
     , gkvec_(gkvec__)
     , N_(N__)
@@ -114,8 +115,9 @@ Beta_projectors_base<T>::Beta_projectors_base(Simulation_context& ctx__, fft::Gv
     }
 
     /* allocate memory */
-    pw_coeffs_t_ = sddk::mdarray<std::complex<T>, 3>(num_gkvec_loc(), num_beta_t(), N__, sddk::memory_t::host,
-                                                     "pw_coeffs_t_");
+    pw_coeffs_t_ = sddk::mdarray<std::complex<T>, 3>(num_gkvec_loc(), num_beta_t(),
+                                                     (num_comp_t__ < 0) ? N__ : num_comp_t__,
+                                                     sddk::memory_t::host, "pw_coeffs_t_");
 
     if (ctx_.processing_unit() == sddk::device_t::GPU) {
         gkvec_coord_ = sddk::mdarray<double, 2>(3, num_gkvec_loc());
@@ -111,7 +111,14 @@ class Beta_projectors_base
     void split_in_chunks();
 
   public:
-    Beta_projectors_base(Simulation_context& ctx__, fft::Gvec const& gkvec__, int N__);
+    /// Constructor.
+    /** \param [in] ctx         Simulation context.
+     *  \param [in] gkvec       List of G+k vectors.
+     *  \param [in] N           Number of components.
+     *  \param [in] num_comp_t  Number of components stored in pw_coeffs_t_; if it is smaller than N, the derived
+     *                          class generates the remaining components on demand.
+     */
+    Beta_projectors_base(Simulation_context& ctx__, fft::Gvec const& gkvec__, int N__, int num_comp_t__ = -1);
 
     /// Calculate inner product between beta-projectors and wave-functions.
     /** The following is matrix computed: <beta|phi>
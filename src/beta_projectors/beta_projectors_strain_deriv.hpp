@@ -29,27 +29,54 @@
 
 namespace sirius {
 
+/// Strain derivatives of beta-projectors.
+/** Only one component of the phase-factor independent coefficients is stored at a time; it is generated on
+ *  demand from the spherical harmonics and radial integrals which are computed once. If the symmetric flag is set,
+ *  only the six symmetric combinations \f$ \frac{1}{2}(\partial_{\mu\nu} + \partial_{\nu\mu}) \f$ are generated;
+ *  this is sufficient for the stress tensor which is symmetric. */
 template <typename T>
 class Beta_projectors_strain_deriv : public Beta_projectors_base<T>
 {
   private:
+    /// True if only the symmetric combinations of the derivatives are generated.
+    bool symmetric_{false};
 
-    void generate_pw_coefs_t()
-    {
-        PROFILE("sirius::Beta_projectors_strain_deriv::generate_pw_coefs_t");
+    /// Index of the component which is currently stored in pw_coeffs_t_.
+    int comp_t_{-1};
 
-        if (!this->num_beta_t()) {
-            return;
-        }
+    /// Real spherical harmonics for each G+k vector.
+    sddk::mdarray<double, 2> rlm_g_;
+
+    /// Derivatives of the real spherical harmonics for each G+k vector.
+    sddk::mdarray<double, 3> rlm_dg_;
+
+    /// Radial integrals of beta-projectors for each atom type.
+    std::vector<sddk::mdarray<double, 2>> ri0_;
+
+    /// Radial integrals with the derivative of spherical Bessel functions for each atom type.
+    std::vector<sddk::mdarray<double, 2>> ri1_;
+
+    void init()
+    {
+        PROFILE("sirius::Beta_projectors_strain_deriv::init");
 
         auto& beta_ri0 = this->ctx_.beta_ri();
         auto& beta_ri1 = this->ctx_.beta_ri_djl();
 
-        int lmax = this->ctx_.unit_cell().lmax();
+        auto& uc  = this->ctx_.unit_cell();
+        int lmax  = uc.lmax();
         int lmmax = utils::lmmax(lmax);
 
-        sddk::mdarray<double, 2> rlm_g(lmmax, this->num_gkvec_loc());
-        sddk::mdarray<double, 3> rlm_dg(lmmax, 3, this->num_gkvec_loc());
+        rlm_g_  = sddk::mdarray<double, 2>(lmmax, this->num_gkvec_loc());
+        rlm_dg_ = sddk::mdarray<double, 3>(lmmax, 3, this->num_gkvec_loc());
+
+        ri0_.resize(uc.num_atom_types());
+        ri1_.resize(uc.num_atom_types());
+        for (int iat = 0; iat < uc.num_atom_types(); iat++) {
+            int nrf   = uc.atom_type(iat).mt_radial_basis_size();
+            ri0_[iat] = sddk::mdarray<double, 2>(nrf, this->num_gkvec_loc());
+            ri1_[iat] = sddk::mdarray<double, 2>(nrf, this->num_gkvec_loc());
+        }
 
         /* array of real spherical harmonics and derivatives for each G-vector */
         #pragma omp parallel for schedule(static)
@@ -60,56 +87,111 @@ class Beta_projectors_strain_deriv : public Beta_projectors_base<T>
             double theta = rtp[1];
             double phi   = rtp[2];
 
-            sf::spherical_harmonics(lmax, theta, phi, &rlm_g(0, igkloc));
-            sddk::mdarray<double, 2> rlm_dg_tmp(&rlm_dg(0, 0, igkloc), lmmax, 3);
+            sf::spherical_harmonics(lmax, theta, phi, &rlm_g_(0, igkloc));
+            sddk::mdarray<double, 2> rlm_dg_tmp(&rlm_dg_(0, 0, igkloc), lmmax, 3);
             sf::dRlm_dr(lmax, gvc, rlm_dg_tmp);
+
+            for (int iat = 0; iat < uc.num_atom_types(); iat++) {
+                auto ri0 = beta_ri0.values(iat, rtp[0]);
+                auto ri1 = beta_ri1.values(iat, rtp[0]);
+                for (int idxrf = 0; idxrf < uc.atom_type(iat).mt_radial_basis_size(); idxrf++) {
+                    ri0_[iat](idxrf, igkloc) = ri0(idxrf);
+                    ri1_[iat](idxrf, igkloc) = ri1(idxrf);
+                }
+            }
         }
+    }
 
-        this->pw_coeffs_t_.zero(sddk::memory_t::host);
+    /// Generate the phase-factor independent coefficients of a given component.
+    void generate_pw_coefs_t(int j__)
+    {
+        if (!this->num_beta_t() || comp_t_ == j__) {
+            return;
+        }
+
+        PROFILE("sirius::Beta_projectors_strain_deriv::generate_pw_coefs_t");
+
+        auto& uc = this->ctx_.unit_cell();
+
+        auto mn = component(j__, symmetric_);
+        /* list of (mu, nu) pairs and their weights */
+        std::vector<std::pair<std::array<int, 2>, double>> terms;
+        if (symmetric_ && mn[0] != mn[1]) {
+            terms.push_back({{mn[0], mn[1]}, 0.5});
+            terms.push_back({{mn[1], mn[0]}, 0.5});
+        } else {
+            terms.push_back({mn, 1.0});
+        }
 
         /* compute d <G+k|beta> / d epsilon_{mu, nu} */
         #pragma omp parallel for schedule(static)
         for (int igkloc = 0; igkloc < this->num_gkvec_loc(); igkloc++) {
             auto gvc = this->gkvec_.template gkvec_cart<sddk::index_domain_t::local>(igkloc);
-            /* vs = {r, theta, phi} */
-            auto gvs = r3::spherical_coordinates(gvc);
+            auto len = gvc.length();
 
-            auto inv_len = (gvs[0] < 1e-10) ? 0 : 1.0 / gvs[0];
+            auto inv_len = (len < 1e-10) ? 0 : 1.0 / len;
 
-            for (int iat = 0; iat < this->ctx_.unit_cell().num_atom_types(); iat++) {
-                auto& atom_type = this->ctx_.unit_cell().atom_type(iat);
+            for (int iat = 0; iat < uc.num_atom_types(); iat++) {
+                auto& atom_type = uc.atom_type(iat);
 
-                auto ri0 = beta_ri0.values(iat, gvs[0]);
-                auto ri1 = beta_ri1.values(iat, gvs[0]);
+                for (int xi = 0; xi < atom_type.mt_basis_size(); xi++) {
+                    int l     = atom_type.indexb(xi).l;
+                    int lm    = atom_type.indexb(xi).lm;
+                    int idxrf = atom_type.indexb(xi).idxrf;
 
-                for (int nu = 0; nu < 3; nu++) {
-                    for (int mu = 0; mu < 3; mu++) {
-                        double p = (mu == nu) ? 0.5 : 0;
-
-                        for (int xi = 0; xi < atom_type.mt_basis_size(); xi++) {
-                            int l     = atom_type.indexb(xi).l;
-                            int lm    = atom_type.indexb(xi).lm;
-                            int idxrf = atom_type.indexb(xi).idxrf;
+                    auto z = std::pow(std::complex<double>(0, -1), l) * fourpi / std::sqrt(uc.omega());
 
-                            auto z = std::pow(std::complex<double>(0, -1), l) * fourpi / std::sqrt(this->ctx_.unit_cell().omega());
+                    double d{0};
+                    for (auto& t : terms) {
+                        int mu   = t.first[0];
+                        int nu   = t.first[1];
+                        double p = (mu == nu) ? 0.5 : 0;
 
-                            auto d1 = ri0(idxrf) * (-gvc[mu] * rlm_dg(lm, nu, igkloc) - p * rlm_g(lm, igkloc));
+                        auto d1 = ri0_[iat](idxrf, igkloc) *
+                                  (-gvc[mu] * rlm_dg_(lm, nu, igkloc) - p * rlm_g_(lm, igkloc));
 
-                            auto d2 = ri1(idxrf) * rlm_g(lm, igkloc) * (-gvc[mu] * gvc[nu] * inv_len);
+                        auto d2 = ri1_[iat](idxrf, igkloc) * rlm_g_(lm, igkloc) * (-gvc[mu] * gvc[nu] * inv_len);
 
-                            this->pw_coeffs_t_(igkloc, atom_type.offset_lo() + xi, mu + nu * 3) = static_cast<std::complex<T>>(z * (d1 + d2));
-                        }
+                        d += t.second * (d1 + d2);
                     }
+                    this->pw_coeffs_t_(igkloc, atom_type.offset_lo() + xi, 0) = static_cast<std::complex<T>>(z * d);
                 }
             }
         }
+        if (this->pw_coeffs_t_.on_device()) {
+            this->pw_coeffs_t_.copy_to(sddk::memory_t::device);
+        }
+        comp_t_ = j__;
     }
 
   public:
-    Beta_projectors_strain_deriv(Simulation_context& ctx__, fft::Gvec const& gkvec__)
-        : Beta_projectors_base<T>(ctx__, gkvec__, 9)
+    Beta_projectors_strain_deriv(Simulation_context& ctx__, fft::Gvec const& gkvec__, bool symmetric__ = false)
+        : Beta_projectors_base<T>(ctx__, gkvec__, symmetric__ ? 6 : 9, 1)
+        , symmetric_(symmetric__)
+    {
+        if (this->num_beta_t()) {
+            init();
+        }
+    }
+
+    /// Return the (mu, nu) indices of the component.
+    /** In the full case the component index is mu + 3 * nu; in the symmetric case the components are
+     *  (0,0), (1,1), (2,2), (0,1), (0,2), (1,2). */
+    static std::array<int, 2> component(int j__, bool symmetric__)
+    {
+        if (symmetric__) {
+            int const idx[6][2] = {{0, 0}, {1, 1}, {2, 2}, {0, 1}, {0, 2}, {1, 2}};
+            return {idx[j__][0], idx[j__][1]};
+        } else {
+            return {j__ % 3, j__ / 3};
+        }
+    }
+
+    /// Generate strain derivatives of beta-projectors for a chunk of atoms.
+    void generate(sddk::memory_t mem__, int ichunk__, int j__)
     {
-        generate_pw_coefs_t();
+        generate_pw_coefs_t(j__);
+        Beta_projectors_base<T>::generate(mem__, ichunk__, 0);
     }
 };
 
@@ -51,6 +51,12 @@ const double y00 = 0.28209479177387814347;
 /// Hartree in electron-volt units.
 const double ha2ev = 27.21138505;
 
+/// Atomic mass unit in units of the electron mass.
+const double amu2me = 1822.888486209;
+
+/// Atomic unit of time in femtoseconds.
+const double au2fs = 0.02418884326585747;
+
 const char* const storage_file_name = "sirius.h5";
 
 /// Pauli matrices in {I, Z, X, Y} order.
@@ -206,6 +206,33 @@ class config_t
             }
             dict_["/settings/itsol_tol_min"_json_pointer] = itsol_tol_min__;
         }
+        /// Compute only the lowest states of the second-variational Hamiltonian
+        /**
+            Occupied states of the previous iteration (or the number estimated from the valence charge) plus sv_num_empty_states are computed. Remaining states get zero eigen-vectors and energies far above the highest computed eigen-value, so they stay empty.
+        */
+        inline auto sv_partial() const
+        {
+            return dict_.at("/settings/sv_partial"_json_pointer).get<bool>();
+        }
+        inline void sv_partial(bool sv_partial__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/settings/sv_partial"_json_pointer] = sv_partial__;
+        }
+        /// Number of empty second-variational states computed in addition to the occupied states when sv_partial is set
+        inline auto sv_num_empty_states() const
+        {
+            return dict_.at("/settings/sv_num_empty_states"_json_pointer).get<int>();
+        }
+        inline void sv_num_empty_states(int sv_num_empty_states__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/settings/sv_num_empty_states"_json_pointer] = sv_num_empty_states__;
+        }
         /// Minimum occupancy below which the band is treated as being 'empty'
         inline auto min_occupancy() const
         {
@@ -811,6 +838,60 @@ class config_t
             }
             dict_["/control/print_performance"_json_pointer] = print_performance__;
         }
+        /// Directory on a node-local storage for the out-of-core wave-functions
+        /**
+            If set, the wave-functions of the local k-points and the Davidson subspace are kept in memory-mapped scratch files when they exceed ooc_memory_limit. Empty string disables the out-of-core mode.
+        */
+        inline auto ooc_path() const
+        {
+            return dict_.at("/control/ooc_path"_json_pointer).get<std::string>();
+        }
+        inline void ooc_path(std::string ooc_path__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/control/ooc_path"_json_pointer] = ooc_path__;
+        }
+        /// Memory (in Gb per MPI rank) for the resident wave-functions in the out-of-core mode
+        inline auto ooc_memory_limit() const
+        {
+            return dict_.at("/control/ooc_memory_limit"_json_pointer).get<double>();
+        }
+        inline void ooc_memory_limit(double ooc_memory_limit__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/control/ooc_memory_limit"_json_pointer] = ooc_memory_limit__;
+        }
+        /// Compression filter of the large datasets in the HDF5 output
+        /**
+            Any value other than `none` switches the densities, potentials and G-vector lists in the HDF5 output to the chunked layout compressed with the given lossless filter. If the filter is not available in the HDF5 library, deflate is used instead.
+        */
+        inline auto hdf5_compression() const
+        {
+            return dict_.at("/control/hdf5_compression"_json_pointer).get<std::string>();
+        }
+        inline void hdf5_compression(std::string hdf5_compression__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/control/hdf5_compression"_json_pointer] = hdf5_compression__;
+        }
+        /// Compression level of the deflate (0-9) or zstd (1-22) filter
+        inline auto hdf5_compression_level() const
+        {
+            return dict_.at("/control/hdf5_compression_level"_json_pointer).get<int>();
+        }
+        inline void hdf5_compression_level(int hdf5_compression_level__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/control/hdf5_compression_level"_json_pointer] = hdf5_compression_level__;
+        }
         /// If true then memory usage will be printed to the standard output.
         inline auto print_memory_usage() const
         {
@@ -955,6 +1036,21 @@ class config_t
             }
             dict_["/control/gvec_chunk_size"_json_pointer] = gvec_chunk_size__;
         }
+        /// Memory budget (in MB per MPI rank) for the real-space wave-functions.
+        /**
+            Wave-functions transformed to real space during the density generation are kept and reused by the first application of the local Hamiltonian in the next band solve, which saves one backward FFT per band. Only CPU FFTs are supported. Zero disables the storage.
+        */
+        inline auto psi_rg_cache_size() const
+        {
+            return dict_.at("/control/psi_rg_cache_size"_json_pointer).get<double>();
+        }
+        inline void psi_rg_cache_size(double psi_rg_cache_size__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/control/psi_rg_cache_size"_json_pointer] = psi_rg_cache_size__;
+        }
       private:
         nlohmann::json& dict_;
     };
@@ -1413,11 +1509,105 @@ class config_t
             }
             dict_["/parameters/precision_gs"_json_pointer] = precision_gs__;
         }
+        /// Method to find the electronic ground state.
+        /**
+            Either the self-consistent Davidson and density mixing cycle or the direct minimization of the total energy (see direct_minimization section).
+        */
+        inline auto ground_state_solver() const
+        {
+            return dict_.at("/parameters/ground_state_solver"_json_pointer).get<std::string>();
+        }
+        inline void ground_state_solver(std::string ground_state_solver__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/parameters/ground_state_solver"_json_pointer] = ground_state_solver__;
+        }
       private:
         nlohmann::json& dict_;
     };
     inline auto const& parameters() const {return parameters_;}
     inline auto& parameters() {return parameters_;}
+    /// Preconditioned conjugate gradient minimization of the total energy on the Grassmann manifold
+    /**
+        By default the occupation numbers of the initial state are kept fixed and only the occupied bands are optimized, which is applicable to insulators only. For metals the free energy is minimized (see ensemble).
+    */
+    class direct_minimization_t
+    {
+      public:
+        direct_minimization_t(nlohmann::json& dict__)
+            : dict_(dict__)
+        {
+        }
+        /// Minimize the free energy with the occupation numbers as the outer-loop variables (metals).
+        /**
+            All bands are optimized. After each num_inner_steps CG steps at fixed occupations (or earlier, if the inner loop is converged) the subspace Hamiltonian is diagonalized, the occupation numbers are recomputed from its eigen-values with the smearing function and the entropy term is updated.
+        */
+        inline auto ensemble() const
+        {
+            return dict_.at("/direct_minimization/ensemble"_json_pointer).get<bool>();
+        }
+        inline void ensemble(bool ensemble__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/direct_minimization/ensemble"_json_pointer] = ensemble__;
+        }
+        /// Maximum number of CG steps at fixed occupation numbers in the ensemble minimization.
+        inline auto num_inner_steps() const
+        {
+            return dict_.at("/direct_minimization/num_inner_steps"_json_pointer).get<int>();
+        }
+        inline void num_inner_steps(int num_inner_steps__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/direct_minimization/num_inner_steps"_json_pointer] = num_inner_steps__;
+        }
+        /// Initial trial step of the line search along the preconditioned direction.
+        inline auto trial_step() const
+        {
+            return dict_.at("/direct_minimization/trial_step"_json_pointer).get<double>();
+        }
+        inline void trial_step(double trial_step__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/direct_minimization/trial_step"_json_pointer] = trial_step__;
+        }
+        /// Number of CG steps after which the search direction is reset to the steepest descent.
+        inline auto restart() const
+        {
+            return dict_.at("/direct_minimization/restart"_json_pointer).get<int>();
+        }
+        inline void restart(int restart__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/direct_minimization/restart"_json_pointer] = restart__;
+        }
+        /// Tolerance for the norm of the energy gradient.
+        inline auto residual_tol() const
+        {
+            return dict_.at("/direct_minimization/residual_tol"_json_pointer).get<double>();
+        }
+        inline void residual_tol(double residual_tol__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/direct_minimization/residual_tol"_json_pointer] = residual_tol__;
+        }
+      private:
+        nlohmann::json& dict_;
+    };
+    inline auto const& direct_minimization() const {return direct_minimization_;}
+    inline auto& direct_minimization() {return direct_minimization_;}
     /// Non-linear conjugate gradient minimisation
     class nlcg_t
     {
@@ -1607,11 +1797,189 @@ class config_t
             }
             dict_["/vcsqnm/num_steps"_json_pointer] = num_steps__;
         }
+        /// Derive SCF tolerances of each relaxation step from the current forces and stress
+        /**
+            SCF density and energy tolerances are loosened by a factor that is proportional to the ratio between the residual forces (stress) and forces_tol (stress_tol). The charge density of the previous step is extrapolated to the new geometry.
+        */
+        inline auto adaptive_scf_tol() const
+        {
+            return dict_.at("/vcsqnm/adaptive_scf_tol"_json_pointer).get<bool>();
+        }
+        inline void adaptive_scf_tol(bool adaptive_scf_tol__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/vcsqnm/adaptive_scf_tol"_json_pointer] = adaptive_scf_tol__;
+        }
+        /// Ratio between the loosening factor of SCF tolerances and the relative residual of forces and stress
+        inline auto scf_tol_scale() const
+        {
+            return dict_.at("/vcsqnm/scf_tol_scale"_json_pointer).get<double>();
+        }
+        inline void scf_tol_scale(double scf_tol_scale__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/vcsqnm/scf_tol_scale"_json_pointer] = scf_tol_scale__;
+        }
+        /// Maximum loosening factor of SCF tolerances
+        inline auto scf_tol_max_factor() const
+        {
+            return dict_.at("/vcsqnm/scf_tol_max_factor"_json_pointer).get<double>();
+        }
+        inline void scf_tol_max_factor(double scf_tol_max_factor__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/vcsqnm/scf_tol_max_factor"_json_pointer] = scf_tol_max_factor__;
+        }
+        /// Preconditioner of the quasi Newton method
+        /**
+            'exp' is the exponential force-field Hessian built from the nearest neighbour list of the unit cell (Packwood et al., J. Chem. Phys. 144, 164109 (2016)). It is rebuilt when the bond topology changes.
+        */
+        inline auto preconditioner() const
+        {
+            return dict_.at("/vcsqnm/preconditioner"_json_pointer).get<std::string>();
+        }
+        inline void preconditioner(std::string preconditioner__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/vcsqnm/preconditioner"_json_pointer] = preconditioner__;
+        }
+        /// Energy scale of the exponential preconditioner (Ha/bohr^2)
+        inline auto precond_mu() const
+        {
+            return dict_.at("/vcsqnm/precond_mu"_json_pointer).get<double>();
+        }
+        inline void precond_mu(double precond_mu__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/vcsqnm/precond_mu"_json_pointer] = precond_mu__;
+        }
+        /// Decay parameter of the exponential preconditioner
+        inline auto precond_A() const
+        {
+            return dict_.at("/vcsqnm/precond_A"_json_pointer).get<double>();
+        }
+        inline void precond_A(double precond_A__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/vcsqnm/precond_A"_json_pointer] = precond_A__;
+        }
+        /// Cutoff radius of the exponential preconditioner in units of the nearest neighbour distance
+        inline auto precond_r_cut() const
+        {
+            return dict_.at("/vcsqnm/precond_r_cut"_json_pointer).get<double>();
+        }
+        inline void precond_r_cut(double precond_r_cut__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/vcsqnm/precond_r_cut"_json_pointer] = precond_r_cut__;
+        }
+        /// Stabilisation shift of the exponential preconditioner in units of precond_mu
+        inline auto precond_c_stab() const
+        {
+            return dict_.at("/vcsqnm/precond_c_stab"_json_pointer).get<double>();
+        }
+        inline void precond_c_stab(double precond_c_stab__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/vcsqnm/precond_c_stab"_json_pointer] = precond_c_stab__;
+        }
       private:
         nlohmann::json& dict_;
     };
     inline auto const& vcsqnm() const {return vcsqnm_;}
     inline auto& vcsqnm() {return vcsqnm_;}
+    /// Born-Oppenheimer molecular dynamics
+    class md_t
+    {
+      public:
+        md_t(nlohmann::json& dict__)
+            : dict_(dict__)
+        {
+        }
+        /// Number of molecular dynamics steps
+        inline auto num_steps() const
+        {
+            return dict_.at("/md/num_steps"_json_pointer).get<int>();
+        }
+        inline void num_steps(int num_steps__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/md/num_steps"_json_pointer] = num_steps__;
+        }
+        /// Time step (atomic units of time)
+        inline auto dt() const
+        {
+            return dict_.at("/md/dt"_json_pointer).get<double>();
+        }
+        inline void dt(double dt__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/md/dt"_json_pointer] = dt__;
+        }
+        /// Use the extended Lagrangian formulation
+        /**
+            An auxiliary density is propagated together with the nuclei by the dissipative time-reversible integrator of Niklasson et al., J. Chem. Phys. 130, 214109 (2009). It is used as the input density of a short SCF at each step. If false, each step runs a fully converged SCF starting from the density of the previous step.
+        */
+        inline auto xlbomd() const
+        {
+            return dict_.at("/md/xlbomd"_json_pointer).get<bool>();
+        }
+        inline void xlbomd(bool xlbomd__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/md/xlbomd"_json_pointer] = xlbomd__;
+        }
+        /// Number of previous auxiliary densities in the dissipation term
+        inline auto xlbomd_K() const
+        {
+            return dict_.at("/md/xlbomd_K"_json_pointer).get<int>();
+        }
+        inline void xlbomd_K(int xlbomd_K__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/md/xlbomd_K"_json_pointer] = xlbomd_K__;
+        }
+        /// Maximum number of SCF iterations per step in the extended Lagrangian mode
+        inline auto num_scf_steps() const
+        {
+            return dict_.at("/md/num_scf_steps"_json_pointer).get<int>();
+        }
+        inline void num_scf_steps(int num_scf_steps__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/md/num_scf_steps"_json_pointer] = num_scf_steps__;
+        }
+      private:
+        nlohmann::json& dict_;
+    };
+    inline auto const& md() const {return md_;}
+    inline auto& md() {return md_;}
     /// Hubbard U correction
     class hubbard_t
     {
@@ -1644,6 +2012,48 @@ class config_t
             }
             dict_["/hubbard/full_orthogonalization"_json_pointer] = full_orthogonalization__;
         }
+        /// Method to compute the inverse square root of the overlap matrix of atomic orbitals.
+        /**
+            'eigen' uses the full eigen-decomposition of the overlap matrix; 'newton_schulz' uses the coupled Newton-Schulz iteration which requires only matrix-matrix multiplications.
+        */
+        inline auto inverse_sqrt() const
+        {
+            return dict_.at("/hubbard/inverse_sqrt"_json_pointer).get<std::string>();
+        }
+        inline void inverse_sqrt(std::string inverse_sqrt__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/hubbard/inverse_sqrt"_json_pointer] = inverse_sqrt__;
+        }
+        /// Tolerance of the Newton-Schulz iteration for the inverse square root of the overlap matrix.
+        inline auto inverse_sqrt_tol() const
+        {
+            return dict_.at("/hubbard/inverse_sqrt_tol"_json_pointer).get<double>();
+        }
+        inline void inverse_sqrt_tol(double inverse_sqrt_tol__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/hubbard/inverse_sqrt_tol"_json_pointer] = inverse_sqrt_tol__;
+        }
+        /// Threshold for the overlap between atomic orbitals of different atoms.
+        /**
+            If positive, the atoms are split into groups coupled by overlap matrix elements larger than the threshold and the inverse square root is computed independently for each group.
+        */
+        inline auto overlap_threshold() const
+        {
+            return dict_.at("/hubbard/overlap_threshold"_json_pointer).get<double>();
+        }
+        inline void overlap_threshold(double overlap_threshold__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/hubbard/overlap_threshold"_json_pointer] = overlap_threshold__;
+        }
         /// If true, normalization is applied to Hubbard orbitals.
         inline auto normalize() const
         {
@@ -1850,8 +2260,10 @@ class config_t
     iterative_solver_t iterative_solver_{dict_};
     control_t control_{dict_};
     parameters_t parameters_{dict_};
+    direct_minimization_t direct_minimization_{dict_};
     nlcg_t nlcg_{dict_};
     vcsqnm_t vcsqnm_{dict_};
+    md_t md_{dict_};
     hubbard_t hubbard_{dict_};
   protected:
     nlohmann::json dict_;
@@ -1280,7 +1280,7 @@ Simulation_context::create_storage_file() const
             }
         }
         fout["parameters"].write("num_gvec", gvec().num_gvec());
-        fout["parameters"].write("gvec", gv);
+        fout["parameters"].write("gvec", gv, hdf5_layout());
 
         fout.create_node("unit_cell");
         fout["unit_cell"].create_node("atoms");
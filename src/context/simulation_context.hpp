@@ -38,6 +38,7 @@
 #include "gpu/acc.hpp"
 #include "symmetry/rotation.hpp"
 #include "fft/fft.hpp"
+#include "SDDK/hdf5_tree.hpp"
 
 #ifdef SIRIUS_GPU
 extern "C" void generate_phase_factors_gpu(int num_gvec_loc__, int num_atoms__, int const* gvec__,
@@ -526,6 +527,15 @@ class Simulation_context : public Simulation_parameters
 
     void create_storage_file() const;
 
+    /// Storage layout of the large datasets (densities, potentials, lists of G-vectors) in the HDF5 output.
+    inline sddk::hdf5_layout_t hdf5_layout() const
+    {
+        sddk::hdf5_layout_t layout;
+        layout.filter = sddk::get_hdf5_filter_t(cfg().control().hdf5_compression());
+        layout.level  = cfg().control().hdf5_compression_level();
+        return layout;
+    }
+
     inline std::string const& start_time_tag() const
     {
         return start_time_tag_;
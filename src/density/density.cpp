@@ -117,6 +117,10 @@ Density::update()
 {
     PROFILE("sirius::Density::update");
 
+    /* symmetry operations might have changed */
+    dm_sym_rotm_.clear();
+    dm_sym_atom_orbits_.clear();
+
     if (!ctx_.full_potential()) {
         rho_pseudo_core_->zero();
         bool is_empty{true};
@@ -165,6 +169,49 @@ Density::initial_density()
     }
 }
 
+void
+Density::initial_density(Density const& src__)
+{
+    PROFILE("sirius::Density::initial_density");
+
+    if (ctx_.full_potential()) {
+        RTE_THROW("interpolation of the density is implemented only for the pseudopotential case");
+    }
+    if (src__.ctx().num_mag_dims() != ctx_.num_mag_dims()) {
+        RTE_THROW("source density has a different number of magnetic components");
+    }
+
+    zero();
+
+    /* global list of the source G-vectors */
+    auto& gv_src = src__.ctx().gvec();
+    sddk::mdarray<int, 2> gv(3, gv_src.num_gvec());
+    for (int ig = 0; ig < gv_src.num_gvec(); ig++) {
+        auto G = gv_src.gvec<sddk::index_domain_t::global>(ig);
+        for (int x : {0, 1, 2}) {
+            gv(x, ig) = G[x];
+        }
+    }
+
+    for (int j = 0; j < ctx_.num_mag_dims() + 1; j++) {
+        auto f_pw = src__.component(j).rg().gather_f_pw();
+        component(j).set_f_pw(gv, f_pw.data());
+        component(j).rg().fft_transform(1);
+    }
+
+    /* atomic quantities don't depend on the plane-wave cutoff */
+    copy(src__.density_matrix(), density_matrix());
+
+    generate_paw_loc_density();
+
+    if (occupation_matrix_) {
+        copy(src__.occupation_matrix(), occupation_matrix());
+    }
+    if (ctx_.use_symmetry()) {
+        this->symmetrize();
+    }
+}
+
 void
 Density::initial_density_pseudo()
 {
@@ -261,6 +308,44 @@ Density::initial_density_pseudo()
     }
 }
 
+std::vector<std::complex<double>>
+Density::atomic_density_pw() const
+{
+    auto q  = ctx_.gvec().shells_len();
+    auto ff = ctx_.ps_rho_ri().values(q, ctx_.comm());
+    return ctx_.make_periodic_function<sddk::index_domain_t::local>(ff);
+}
+
+void
+Density::extrapolate_density(std::vector<std::complex<double>> const& rho_at_old__)
+{
+    PROFILE("sirius::Density::extrapolate_density");
+
+    if (ctx_.full_potential()) {
+        RTE_THROW("density extrapolation is implemented only for the pseudopotential case");
+    }
+    if (static_cast<int>(rho_at_old__.size()) != ctx_.gvec().count()) {
+        RTE_THROW("wrong size of the old atomic density");
+    }
+
+    auto rho_at = this->atomic_density_pw();
+
+    rho().rg().fft_transform(-1);
+    #pragma omp parallel for schedule(static)
+    for (int igloc = 0; igloc < ctx_.gvec().count(); igloc++) {
+        rho().rg().f_pw_local(igloc) += rho_at[igloc] - rho_at_old__[igloc];
+    }
+    rho().rg().fft_transform(1);
+
+    /* remove possible negative noise */
+    for (int ir = 0; ir < ctx_.spfft<double>().local_slice_size(); ir++) {
+        rho().rg().value(ir) = std::max(rho().rg().value(ir), 0.0);
+    }
+    /* renormalize charge */
+    normalize();
+    rho().rg().fft_transform(-1);
+}
+
 void
 Density::initial_density_full_pot()
 {
@@ -572,7 +657,7 @@ Density::generate_paw_loc_density()
 template <typename T>
 static void
 add_k_point_contribution_rg_collinear(fft::spfft_transform_type<T>& fft__, int ispn__, T w__, T const* inp_wf__, int nr__,
-        bool gamma__, sddk::mdarray<T, 2>& density_rg__)
+        bool gamma__, sddk::mdarray<T, 2>& density_rg__, wf::Wave_functions_rg_cache<T>* psi_rg__, wf::band_index j__)
 {
     /* transform to real space */
     fft__.backward(inp_wf__, fft__.processing_unit());
@@ -580,6 +665,11 @@ add_k_point_contribution_rg_collinear(fft::spfft_transform_type<T>& fft__, int i
     /* location of the real-space wave-functions psi(r) */
     auto data_ptr = fft__.space_domain_data(fft__.processing_unit());
 
+    /* keep psi(r) for the next application of the Hamiltonian */
+    if (psi_rg__) {
+        psi_rg__->put(wf::spin_index(ispn__), j__, data_ptr, gamma__ ? nr__ : 2 * nr__);
+    }
+
     switch (fft__.processing_unit()) {
         case SPFFT_PU_HOST: {
             if (gamma__) {
@@ -615,7 +705,8 @@ add_k_point_contribution_rg_collinear(fft::spfft_transform_type<T>& fft__, int i
 template <typename T>
 static
 void add_k_point_contribution_rg_noncollinear(fft::spfft_transform_type<T>& fft__, T w__, T const* inp_wf_up__,
-        T const* inp_wf_dn__, int nr__, sddk::mdarray<std::complex<T>, 1>& psi_r_up__, sddk::mdarray<T, 2>& density_rg__)
+        T const* inp_wf_dn__, int nr__, sddk::mdarray<std::complex<T>, 1>& psi_r_up__, sddk::mdarray<T, 2>& density_rg__,
+        wf::Wave_functions_rg_cache<T>* psi_rg__, wf::band_index j__)
 {
     /* location of the real-space wave-functions psi(r) */
     auto data_ptr = fft__.space_domain_data(fft__.processing_unit());
@@ -643,6 +734,13 @@ void add_k_point_contribution_rg_noncollinear(fft::spfft_transform_type<T>& fft_
     auto psi_r_dn = reinterpret_cast<std::complex<T>*>(data_ptr);
     auto& psi_r_up = psi_r_up__;
 
+    /* keep both components of psi(r) for the next application of the Hamiltonian */
+    if (psi_rg__) {
+        psi_rg__->put(wf::spin_index(0), j__, reinterpret_cast<T const*>(psi_r_up.at(sddk::memory_t::host)),
+                2 * nr__);
+        psi_rg__->put(wf::spin_index(1), j__, data_ptr, 2 * nr__);
+    }
+
     switch (fft__.processing_unit()) {
         case SPFFT_PU_HOST: {
             #pragma omp parallel for
@@ -697,6 +795,12 @@ Density::add_k_point_contribution_rg(K_point<T>* kp__, std::array<wf::Wave_funct
         density_rg.allocate(get_memory_pool(sddk::memory_t::device)).zero(sddk::memory_t::device);
     }
 
+    /* real-space wave-functions are stored only on the host and only if the memory budget is set */
+    wf::Wave_functions_rg_cache<T>* psi_rg{nullptr};
+    if (fft.processing_unit() == SPFFT_PU_HOST && ctx_.cfg().control().psi_rg_cache_size() > 0) {
+        psi_rg = &kp__->psi_rg_cache();
+    }
+
     /* non-magnetic or collinear case */
     if (ctx_.num_mag_dims() != 3) {
         /* loop over pure spinor components */
@@ -711,7 +815,8 @@ Density::add_k_point_contribution_rg(K_point<T>* kp__, std::array<wf::Wave_funct
 
                 auto inp_wf = wf_fft__[ispn].pw_coeffs_spfft(wf_mem, wf::band_index(i));
 
-                add_k_point_contribution_rg_collinear(kp__->spfft_transform(), ispn, w, inp_wf, nr, ctx_.gamma_point(), density_rg);
+                add_k_point_contribution_rg_collinear(kp__->spfft_transform(), ispn, w, inp_wf, nr, ctx_.gamma_point(),
+                        density_rg, psi_rg, wf::band_index(j));
             }
         } // ispn
     } else { /* non-collinear case */
@@ -736,7 +841,7 @@ Density::add_k_point_contribution_rg(K_point<T>* kp__, std::array<wf::Wave_funct
             auto inp_wf_dn = wf_fft__[1].pw_coeffs_spfft(wf_mem_dn, wf::band_index(i));
 
             add_k_point_contribution_rg_noncollinear(kp__->spfft_transform(), w, inp_wf_up, inp_wf_dn, nr, psi_r_up,
-                    density_rg);
+                    density_rg, psi_rg, wf::band_index(j));
         }
     }
 
@@ -1266,6 +1371,10 @@ Density::generate_valence(K_point_set const& ks__)
             mg.emplace_back(kp->hubbard_wave_functions_S().memory_guard(mem, wf::copy_to::device));
         }
 
+        /* memory budget for the real-space wave-functions is evenly split between the local k-points */
+        kp->psi_rg_cache().reset(static_cast<size_t>(ctx_.cfg().control().psi_rg_cache_size() * (1 << 20)) /
+                ks__.spl_num_kpoints().local_size());
+
         for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
             int nbnd = kp->num_occupied_bands(ispn);
             /* swap wave functions for the FFT transformation */
@@ -1278,11 +1387,14 @@ Density::generate_valence(K_point_set const& ks__)
         } else {
             if (ctx_.gamma_point() && (ctx_.so_correction() == false)) {
                 add_k_point_contribution_dm_pwpp<T, T>(ctx_, *kp, density_matrix_);
+                if (occupation_matrix_) {
+                    occupation_matrix_->add_k_point_contribution<T, T>(*kp);
+                }
             } else {
                 add_k_point_contribution_dm_pwpp<T, std::complex<T>>(ctx_, *kp, density_matrix_);
-            }
-            if (occupation_matrix_) {
-                occupation_matrix_->add_k_point_contribution(*kp);
+                if (occupation_matrix_) {
+                    occupation_matrix_->add_k_point_contribution<T, std::complex<T>>(*kp);
+                }
             }
         }
 
@@ -1291,7 +1403,7 @@ Density::generate_valence(K_point_set const& ks__)
     }
 
     if (density_matrix_.size()) {
-        ctx_.comm().allreduce(density_matrix_.at(sddk::memory_t::host), static_cast<int>(density_matrix_.size()));
+        ctx_.comm().allreduce(density_matrix_.at(sddk::memory_t::host), density_matrix_.size());
     }
 
     if (occupation_matrix_ && (ks__.num_kpoints() != ks__.spl_num_kpoints().local_size())) {
@@ -1698,6 +1810,61 @@ Density::generate_valence_mt()
     }
 }
 
+void
+Density::init_density_matrix_symmetrization()
+{
+    PROFILE("sirius::Density::init_density_matrix_symmetrization");
+
+    auto& sym = unit_cell_.symmetry();
+    int nsym  = sym.size();
+
+    int lmax  = unit_cell_.lmax();
+    int lmmax = utils::lmmax(lmax);
+    sddk::mdarray<double, 2> rotm(lmmax, lmmax);
+
+    /* rotation matrices of the full basis of each atom type; they are block-diagonal in (l, order) indices */
+    dm_sym_rotm_ = std::vector<std::vector<sddk::mdarray<std::complex<double>, 2>>>(unit_cell_.num_atom_types());
+    for (int isym = 0; isym < nsym; isym++) {
+        sht::rotation_matrix(lmax, sym[isym].spg_op.euler_angles, sym[isym].spg_op.proper, rotm);
+
+        for (int iat = 0; iat < unit_cell_.num_atom_types(); iat++) {
+            auto& indexb = unit_cell_.atom_type(iat).indexb();
+            int nbf      = indexb.size();
+
+            sddk::mdarray<std::complex<double>, 2> R(nbf, nbf);
+            R.zero();
+            for (int xi1 = 0; xi1 < nbf; xi1++) {
+                int l1  = indexb[xi1].l;
+                int lm1 = indexb[xi1].lm;
+                int o1  = indexb[xi1].order;
+                for (int m3 = -l1; m3 <= l1; m3++) {
+                    int lm3 = utils::lm(l1, m3);
+                    R(xi1, indexb.index_by_lm_order(lm3, o1)) = rotm(lm1, lm3);
+                }
+            }
+            dm_sym_rotm_[iat].push_back(std::move(R));
+        }
+    }
+
+    /* orbits of atoms under the symmetry operations */
+    dm_sym_atom_orbits_.clear();
+    std::vector<int> visited(unit_cell_.num_atoms(), 0);
+    for (int ia = 0; ia < unit_cell_.num_atoms(); ia++) {
+        if (visited[ia]) {
+            continue;
+        }
+        std::vector<int> orbit;
+        for (int isym = 0; isym < nsym; isym++) {
+            int ja = sym[isym].spg_op.sym_atom[ia];
+            if (!visited[ja]) {
+                visited[ja] = 1;
+                orbit.push_back(ja);
+            }
+        }
+        dm_sym_atom_orbits_.push_back(orbit);
+    }
+}
+
 void
 Density::symmetrize_density_matrix()
 {
@@ -1705,40 +1872,148 @@ Density::symmetrize_density_matrix()
 
     auto& sym = unit_cell_.symmetry();
 
-    int ndm = ctx_.num_mag_comp();
+    int ndm  = ctx_.num_mag_comp();
+    int nsym = sym.size();
 
     if (unit_cell_.mt_lo_basis_size() == 0) {
         return;
     }
 
+    if (dm_sym_rotm_.empty()) {
+        init_density_matrix_symmetrization();
+    }
+
+    /* Spin transformation of each symmetry operation. Rotated components uu, dd, ud are extended with
+     * du = conj(ud) and the new components are linear combinations of the four. */
+    sddk::mdarray<std::complex<double>, 3> spin_rotm(ndm, 4, nsym);
+    spin_rotm.zero();
+    for (int isym = 0; isym < nsym; isym++) {
+        if (ndm == 1) {
+            spin_rotm(0, 0, isym) = 1;
+        } else {
+            auto& spin_rot_su2 = sym[isym].spin_rotation_su2;
+            /* spin indices of the extended components */
+            int const s1[] = {0, 1, 0, 1};
+            int const s2[] = {0, 1, 1, 0};
+            /* for the new component k the first spin index is k & 1 and the second is min(k, 1) */
+            for (int k = 0; k < ndm; k++) {
+                for (int kp = 0; kp < 4; kp++) {
+                    spin_rotm(k, kp, isym) = spin_rot_su2(k & 1, s1[kp]) *
+                                             std::conj(spin_rot_su2(std::min(k, 1), s2[kp]));
+                }
+            }
+        }
+    }
+
     sddk::mdarray<std::complex<double>, 4> dm(unit_cell_.max_mt_basis_size(), unit_cell_.max_mt_basis_size(), ndm,
-                                  unit_cell_.num_atoms());
+                                              unit_cell_.num_atoms());
     dm.zero();
 
-    int lmax  = unit_cell_.lmax();
-    int lmmax = utils::lmmax(lmax);
-    sddk::mdarray<double, 2> rotm(lmmax, lmmax);
-
-    for (int i = 0; i < sym.size(); i++) {
-        int pr    = sym[i].spg_op.proper;
-        auto eang = sym[i].spg_op.euler_angles;
-        sht::rotation_matrix(lmax, eang, pr, rotm);
-        auto& spin_rot_su2 = sym[i].spin_rotation_su2;
+    auto const& one  = la::constant<std::complex<double>>::one();
+    auto const& zero = la::constant<std::complex<double>>::zero();
+
+    /* orbits are distributed between MPI ranks; the density matrix of the atom is symmetrized using only
+     * the density matrices of atoms from the same orbit */
+    auto& comm = ctx_.comm();
+    for (int io = comm.rank(); io < static_cast<int>(dm_sym_atom_orbits_.size()); io += comm.size()) {
+        auto const& orbit = dm_sym_atom_orbits_[io];
+        int norb = static_cast<int>(orbit.size());
+        int iat  = unit_cell_.atom(orbit[0]).type_id();
+        int nbf  = unit_cell_.atom_type(iat).mt_basis_size();
+
+        /* position of the atom in the orbit */
+        std::map<int, int> pos;
+        for (int i = 0; i < norb; i++) {
+            pos[orbit[i]] = i;
+        }
+
+        /* pack density matrices of the orbit */
+        sddk::mdarray<std::complex<double>, 4> dm_in(nbf, nbf, ndm, norb);
+        for (int i = 0; i < norb; i++) {
+            for (int j = 0; j < ndm; j++) {
+                for (int xi2 = 0; xi2 < nbf; xi2++) {
+                    for (int xi1 = 0; xi1 < nbf; xi1++) {
+                        dm_in(xi1, xi2, j, i) = density_matrix_(xi1, xi2, j, orbit[i]);
+                    }
+                }
+            }
+        }
 
-        for (int ia = 0; ia < unit_cell_.num_atoms(); ia++) {
-            int ja = sym[i].spg_op.sym_atom[ia];
+        /* time-reversed density matrices for the antiunitary operations: sigma_y dm^{*} sigma_y, which in terms of
+         * the stored components is uu -> dd^{*}, dd -> uu^{*}, ud -> -ud (du = ud^{*} is not stored) */
+        sddk::mdarray<std::complex<double>, 4> dm_in_tr;
+        if (sym.num_antiunitary()) {
+            dm_in_tr = sddk::mdarray<std::complex<double>, 4>(nbf, nbf, ndm, norb);
+            for (int i = 0; i < norb; i++) {
+                for (int xi2 = 0; xi2 < nbf; xi2++) {
+                    for (int xi1 = 0; xi1 < nbf; xi1++) {
+                        if (ndm == 1) {
+                            dm_in_tr(xi1, xi2, 0, i) = std::conj(dm_in(xi1, xi2, 0, i));
+                        } else {
+                            dm_in_tr(xi1, xi2, 0, i) = std::conj(dm_in(xi1, xi2, 1, i));
+                            dm_in_tr(xi1, xi2, 1, i) = std::conj(dm_in(xi1, xi2, 0, i));
+                        }
+                        if (ndm == 3) {
+                            dm_in_tr(xi1, xi2, 2, i) = -dm_in(xi1, xi2, 2, i);
+                        }
+                    }
+                }
+            }
+        }
 
-            sirius::symmetrize(density_matrix_, unit_cell_.atom(ia).type().indexb(), ia, ja, ndm, rotm, spin_rot_su2,
-                               dm, false);
+        sddk::mdarray<std::complex<double>, 4> dm_tmp(nbf, nbf, ndm, norb);
+        sddk::mdarray<std::complex<double>, 4> dm_rot(nbf, nbf, ndm, norb);
+        sddk::mdarray<std::complex<double>, 4> dm_out(nbf, nbf, ndm, norb);
+        dm_out.zero();
+
+        for (int isym = 0; isym < nsym; isym++) {
+            auto& R = dm_sym_rotm_[iat][isym];
+            auto& dm_src = sym[isym].time_reversal ? dm_in_tr : dm_in;
+            /* R * dm for all components and atoms of the orbit at once */
+            la::wrap(la::lib_t::blas).gemm('N', 'N', nbf, nbf * ndm * norb, nbf, &one, R.at(sddk::memory_t::host),
+                    R.ld(), dm_src.at(sddk::memory_t::host), nbf, &zero, dm_tmp.at(sddk::memory_t::host), nbf);
+            /* (R * dm) * R^T for each block */
+            for (int i = 0; i < norb; i++) {
+                for (int j = 0; j < ndm; j++) {
+                    la::wrap(la::lib_t::blas).gemm('N', 'T', nbf, nbf, nbf, &one,
+                            dm_tmp.at(sddk::memory_t::host, 0, 0, j, i), nbf, R.at(sddk::memory_t::host), R.ld(),
+                            &zero, dm_rot.at(sddk::memory_t::host, 0, 0, j, i), nbf);
+                }
+            }
+            /* apply spin rotation and add to the image atom */
+            for (int i = 0; i < norb; i++) {
+                int ja = pos.at(sym[isym].spg_op.sym_atom[orbit[i]]);
+                for (int k = 0; k < ndm; k++) {
+                    for (int xi2 = 0; xi2 < nbf; xi2++) {
+                        for (int xi1 = 0; xi1 < nbf; xi1++) {
+                            std::complex<double> z{0};
+                            for (int kp = 0; kp < ndm; kp++) {
+                                z += spin_rotm(k, kp, isym) * dm_rot(xi1, xi2, kp, i);
+                            }
+                            if (ndm == 3) {
+                                z += spin_rotm(k, 3, isym) * std::conj(dm_rot(xi1, xi2, 2, i));
+                            }
+                            dm_out(xi1, xi2, k, ja) += z;
+                        }
+                    }
+                }
+            }
         }
-    }
 
-    double alpha = 1.0 / double(sym.size());
-    /* multiply by alpha which is the inverse of the number of symmetries */
-    auto a = dm.at(sddk::memory_t::host);
-    for (auto i = 0u; i < dm.size(); i++) {
-        a[i] *= alpha;
+        /* multiply by the inverse of the number of symmetries */
+        double alpha = 1.0 / double(nsym);
+        for (int i = 0; i < norb; i++) {
+            for (int j = 0; j < ndm; j++) {
+                for (int xi2 = 0; xi2 < nbf; xi2++) {
+                    for (int xi1 = 0; xi1 < nbf; xi1++) {
+                        dm(xi1, xi2, j, orbit[i]) = dm_out(xi1, xi2, j, i) * alpha;
+                    }
+                }
+            }
+        }
     }
+    /* density matrix is a global array */
+    comm.allreduce(dm.at(sddk::memory_t::host), dm.size());
 
     sddk::copy(dm, density_matrix_);
 
@@ -1777,7 +2052,7 @@ Density::compute_atomic_mag_mom() const
             mmom(j, ia) *= (unit_cell_.omega() / fft::spfft_grid_size(ctx_.spfft<double>()));
         }
     }
-    mpi::Communicator(ctx_.spfft<double>().communicator()).allreduce(&mmom(0, 0), static_cast<int>(mmom.size()));
+    mpi::Communicator(ctx_.spfft<double>().communicator()).allreduce(&mmom(0, 0), mmom.size());
     return mmom;
 }
 
@@ -217,6 +217,13 @@ class Density : public Field4D
     /** This is a global matrix, meaning that each MPI rank holds the full copy. This simplifies the symmetrization. */
     sddk::mdarray<std::complex<double>, 4> density_matrix_;
 
+    /// Rotation matrices of the atom type basis for each symmetry operation; used to symmetrize the density matrix.
+    /** Computed once for the given geometry. */
+    std::vector<std::vector<sddk::mdarray<std::complex<double>, 2>>> dm_sym_rotm_;
+
+    /// Orbits of atoms under the symmetry operations.
+    std::vector<std::vector<int>> dm_sym_atom_orbits_;
+
     /// Local fraction of atoms with PAW correction.
     std::unique_ptr<PAW_density<double>> paw_density_;
 
@@ -348,8 +355,25 @@ class Density : public Field4D
     /// Generate initial charge density and magnetization
     void initial_density();
 
+    /// Initial charge density and magnetization from the density computed with a different plane-wave cutoff.
+    /** Plane-wave coefficients are mapped by G-vectors (zero-padding in G); density and occupation matrices are
+     *  copied. Only the pseudopotential case is supported. */
+    void initial_density(Density const& src__);
+
     void initial_density_pseudo();
 
+    /// Plane-wave coefficients of the superposition of atomic valence densities for the current geometry.
+    /** Only the local fraction of G-vectors is returned. */
+    std::vector<std::complex<double>> atomic_density_pw() const;
+
+    /// Extrapolate the charge density to the new atomic positions.
+    /** The superposition of atomic densities of the old geometry is replaced by the one of the current geometry:
+     *  \f[
+     *    \rho({\bf G}) \leftarrow \rho({\bf G}) - \rho^{at}_{old}({\bf G}) + \rho^{at}({\bf G})
+     *  \f]
+     *  The density is then made non-negative and renormalized. Only the pseudopotential case is supported. */
+    void extrapolate_density(std::vector<std::complex<double>> const& rho_at_old__);
+
     void initial_density_full_pot();
 
     void normalize();
@@ -503,6 +527,9 @@ class Density : public Field4D
     std::tuple<std::array<double, 3>, std::array<double, 3>, std::vector<std::array<double, 3>>>
     get_magnetisation() const;
 
+    /// Compute the rotation matrices and the orbits of atoms used in the symmetrization of the density matrix.
+    void init_density_matrix_symmetrization();
+
     /// Symmetrize density matrix.
     /** We start from the spectral represntation of the occupancy operator defined for the irreducible Brillouin
      *  zone:
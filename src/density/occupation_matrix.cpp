@@ -49,14 +49,15 @@ Occupation_matrix::Occupation_matrix(Simulation_context& ctx__)
             auto Ttot = sym[isym].spg_op.inv_sym_atom_T[ja] - sym[isym].spg_op.inv_sym_atom_T[ia] +
                         dot(sym[isym].spg_op.invR, r3::vector<int>(T));
             if (!occ_mtrx_T_.count(Ttot)) {
-                occ_mtrx_T_[Ttot] = sddk::mdarray<std::complex<double>, 3>(nhwf, nhwf, ctx_.num_mag_comp());
+                occ_mtrx_T_[Ttot] = sddk::mdarray<std::complex<double>, 3>(nhwf, nhwf,
+                        (ctx_.num_mag_dims() == 3) ? 4 : ctx_.num_spins());
                 occ_mtrx_T_[Ttot].zero();
             }
         }
     }
 }
 
-template <typename T>
+template <typename T, typename F>
 void
 Occupation_matrix::add_k_point_contribution(K_point<T>& kp__)
 {
@@ -80,7 +81,10 @@ Occupation_matrix::add_k_point_contribution(K_point<T>& kp__)
 
     int nwfu = r.first;
 
-    sddk::matrix<std::complex<T>> occ_mtrx(nwfu, nwfu, get_memory_pool(sddk::memory_t::host), "occ_mtrx");
+    /* in the non-collinear case the occupation matrix has the (2 x nwfu) x (2 x nwfu) spinor structure */
+    int nso = (ctx_.num_mag_dims() == 3) ? 2 : 1;
+
+    sddk::matrix<F> occ_mtrx(nso * nwfu, nso * nwfu, get_memory_pool(sddk::memory_t::host), "occ_mtrx");
     if (is_device_memory(mem)) {
         occ_mtrx.allocate(get_memory_pool(mem));
     }
@@ -89,17 +93,21 @@ Occupation_matrix::add_k_point_contribution(K_point<T>& kp__)
 
     /* full non collinear magnetism */
     if (ctx_.num_mag_dims() == 3) {
-        la::dmatrix<std::complex<T>> dm(kp__.num_occupied_bands(), nwfu, get_memory_pool(mem_host), "dm");
+        /* Hubbard orbitals are scalar functions; compute <psi_{n,sigma} | phi_m> for each spin component
+         * and store it in the column sigma * nwfu + m */
+        la::dmatrix<F> dm(kp__.num_occupied_bands(), 2 * nwfu, get_memory_pool(mem_host), "dm");
         if (is_device_memory(mem)) {
             dm.allocate(get_memory_pool(mem));
         }
-        wf::inner(ctx_.spla_context(), mem, wf::spin_range(0, 2), kp__.spinor_wave_functions(),
-                wf::band_range(0, kp__.num_occupied_bands()), kp__.hubbard_wave_functions_S(),
-                wf::band_range(0, nwfu), dm, 0, 0);
+        for (int s = 0; s < ctx_.num_spins(); s++) {
+            wf::inner(ctx_.spla_context(), mem, wf::spin_range(s), kp__.spinor_wave_functions(),
+                    wf::band_range(0, kp__.num_occupied_bands()), kp__.hubbard_wave_functions_S(),
+                    wf::band_range(0, nwfu), dm, 0, s * nwfu);
+        }
 
-        la::dmatrix<std::complex<T>> dm1(kp__.num_occupied_bands(), nwfu, get_memory_pool(mem_host), "dm1");
+        la::dmatrix<F> dm1(kp__.num_occupied_bands(), 2 * nwfu, get_memory_pool(mem_host), "dm1");
         #pragma omp parallel for
-        for (int m = 0; m < nwfu; m++) {
+        for (int m = 0; m < 2 * nwfu; m++) {
             for (int j = 0; j < kp__.num_occupied_bands(); j++) {
                 dm1(j, m) = dm(j, m) * static_cast<T>(kp__.band_occupancy(j, 0));
             }
@@ -109,9 +117,9 @@ Occupation_matrix::add_k_point_contribution(K_point<T>& kp__)
         }
 
         /* now compute O_{ij}^{sigma,sigma'} = \sum_{nk} <psi_nk|phi_{i,sigma}><phi_{j,sigma^'}|psi_nk> f_{nk} */
-        auto alpha = std::complex<T>(kp__.weight(), 0.0);
-        la::wrap(la).gemm('C', 'N', nwfu, nwfu, kp__.num_occupied_bands(), &alpha, dm.at(mem), dm.ld(), dm1.at(mem),
-                        dm1.ld(), &la::constant<std::complex<T>>::zero(), occ_mtrx.at(mem), occ_mtrx.ld());
+        F alpha = kp__.weight();
+        la::wrap(la).gemm('C', 'N', 2 * nwfu, 2 * nwfu, kp__.num_occupied_bands(), &alpha, dm.at(mem), dm.ld(),
+                        dm1.at(mem), dm1.ld(), &la::constant<F>::zero(), occ_mtrx.at(mem), occ_mtrx.ld());
         if (is_device_memory(mem)) {
             occ_mtrx.copy_to(sddk::memory_t::host);
         }
@@ -143,13 +151,30 @@ Occupation_matrix::add_k_point_contribution(K_point<T>& kp__)
                 }
             }
         }
+
+        int s_idx[2][2] = {{0, 3}, {2, 1}};
+        for (auto& e : this->occ_mtrx_T_) {
+            /* e^{-i k T} */
+            auto z1 = std::exp(std::complex<double>(0, -twopi * dot(e.first, kp__.vk())));
+            for (int s1 = 0; s1 < ctx_.num_spins(); s1++) {
+                for (int s2 = 0; s2 < ctx_.num_spins(); s2++) {
+                    for (int j = 0; j < nwfu; j++) {
+                        for (int i = 0; i < nwfu; i++) {
+                            e.second(i, j, s_idx[s1][s2]) +=
+                                static_cast<std::complex<T>>(occ_mtrx(r.first * s1 + i, r.first * s2 + j)) *
+                                static_cast<std::complex<T>>(z1);
+                        }
+                    }
+                }
+            }
+        }
     } else {
         /* SLDA + U, we need to do the explicit calculation. The hubbard
            orbitals only have one component while the bloch wave functions
            have two. The inner product takes care of this case internally. */
 
         for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
-            la::dmatrix<std::complex<T>> dm(kp__.num_occupied_bands(ispn), nwfu, get_memory_pool(mem_host), "dm");
+            la::dmatrix<F> dm(kp__.num_occupied_bands(ispn), nwfu, get_memory_pool(mem_host), "dm");
             if (is_device_memory(mem)) {
                 dm.allocate(get_memory_pool(mem));
             }
@@ -158,7 +183,7 @@ Occupation_matrix::add_k_point_contribution(K_point<T>& kp__)
                     wf::band_range(0, kp__.num_occupied_bands(ispn)), kp__.hubbard_wave_functions_S(),
                     wf::band_range(0, nwfu), dm, 0, 0);
 
-            la::dmatrix<std::complex<T>> dm1(kp__.num_occupied_bands(ispn), nwfu, get_memory_pool(mem_host), "dm1");
+            la::dmatrix<F> dm1(kp__.num_occupied_bands(ispn), nwfu, get_memory_pool(mem_host), "dm1");
             #pragma omp parallel for
             for (int m = 0; m < nwfu; m++) {
                 for (int j = 0; j < kp__.num_occupied_bands(ispn); j++) {
@@ -173,9 +198,9 @@ Occupation_matrix::add_k_point_contribution(K_point<T>& kp__)
              * calculations of E and U consider occupancies <= 1.  Sirius for the LDA+U has a factor 2 in the
              * band occupancies. We need to compensate for it because it is taken into account in the
              * calculation of the hubbard potential */
-            auto alpha = std::complex<T>(kp__.weight() / ctx_.max_occupancy(), 0.0);
+            F alpha = kp__.weight() / ctx_.max_occupancy();
             la::wrap(la).gemm('C', 'N', nwfu, nwfu, kp__.num_occupied_bands(ispn), &alpha, dm.at(mem), dm.ld(),
-                            dm1.at(mem), dm1.ld(), &la::constant<std::complex<T>>::zero(), occ_mtrx.at(mem),
+                            dm1.at(mem), dm1.ld(), &la::constant<F>::zero(), occ_mtrx.at(mem),
                             occ_mtrx.ld());
             if (is_device_memory(mem)) {
                 occ_mtrx.copy_to(sddk::memory_t::host);
@@ -213,9 +238,11 @@ Occupation_matrix::add_k_point_contribution(K_point<T>& kp__)
     }
 }
 
-template void Occupation_matrix::add_k_point_contribution<double>(K_point<double>& kp__);
+template void Occupation_matrix::add_k_point_contribution<double, double>(K_point<double>& kp__);
+template void Occupation_matrix::add_k_point_contribution<double, std::complex<double>>(K_point<double>& kp__);
 #ifdef USE_FP32
-template void Occupation_matrix::add_k_point_contribution<float>(K_point<float>& kp__);
+template void Occupation_matrix::add_k_point_contribution<float, float>(K_point<float>& kp__);
+template void Occupation_matrix::add_k_point_contribution<float, std::complex<float>>(K_point<float>& kp__);
 #endif
 
 void
@@ -225,215 +252,240 @@ Occupation_matrix::symmetrize()
         return;
     }
 
-    auto& sym      = ctx_.unit_cell().symmetry();
-    const double f = 1.0 / sym.size();
-    std::vector<sddk::mdarray<std::complex<double>, 3>> local_tmp;
+    PROFILE("sirius::Occupation_matrix::symmetrize");
 
-    local_tmp.resize(local_.size());
+    auto& sym = ctx_.unit_cell().symmetry();
+    int nsym  = sym.size();
+    /* number of spin components; in the non-collinear case they are stored as uu, dd, du, ud */
+    int nc = (ctx_.num_mag_dims() == 3) ? 4 : ctx_.num_spins();
 
+    int lmax{0};
     for (int at_lvl = 0; at_lvl < static_cast<int>(local_.size()); at_lvl++) {
-        const int ia     = atomic_orbitals_[at_lvl].first;
-        auto const& atom = ctx_.unit_cell().atom(ia);
-        // We can skip the symmetrization for this atomic level since it does not contribute to the Hubbard correction
-        // (or U = 0)
-        if (atom.type().lo_descriptor_hub(atomic_orbitals_[at_lvl].second).use_for_calculation()) {
-            local_tmp[at_lvl] = sddk::mdarray<std::complex<double>, 3>(local_[at_lvl].size(0), local_[at_lvl].size(1), 4);
-            // TODO: use std::copy
-            memcpy(local_tmp[at_lvl].at(sddk::memory_t::host), local_[at_lvl].at(sddk::memory_t::host),
-                   sizeof(std::complex<double>) * local_[at_lvl].size());
-        } else {
-            local_tmp[at_lvl].zero();
-        }
+        auto const& atom = ctx_.unit_cell().atom(atomic_orbitals_[at_lvl].first);
+        lmax = std::max(lmax, atom.type().lo_descriptor_hub(atomic_orbitals_[at_lvl].second).l());
+    }
+    for (int i = 0; i < static_cast<int>(ctx_.cfg().hubbard().nonlocal().size()); i++) {
+        auto nl = ctx_.cfg().hubbard().nonlocal(i);
+        lmax    = std::max(lmax, std::max(nl.l()[0], nl.l()[1]));
     }
 
-    for (int at_lvl = 0; at_lvl < static_cast<int>(local_.size()); at_lvl++) {
-        const int ia     = atomic_orbitals_[at_lvl].first;
-        const auto& atom = ctx_.unit_cell().atom(ia);
-        local_[at_lvl].zero();
-        // we can skip the symmetrization for this atomic level since it does not contribute to the Hubbard correction
-        // (or U = 0)
-        if (atom.type().lo_descriptor_hub(atomic_orbitals_[at_lvl].second).use_for_calculation()) {
-            int il             = atom.type().lo_descriptor_hub(atomic_orbitals_[at_lvl].second).l();
-            const int lmmax_at = 2 * il + 1;
-            // local_[at_lvl].zero();
-            sddk::mdarray<std::complex<double>, 3> dm_ia(lmmax_at, lmmax_at, 4);
-            for (int isym = 0; isym < sym.size(); isym++) {
-                int pr            = sym[isym].spg_op.proper;
-                auto eang         = sym[isym].spg_op.euler_angles;
-                auto rotm         = sht::rotation_matrix<double>(4, eang, pr);
-                auto spin_rot_su2 = rotation_matrix_su2(sym[isym].spin_rotation);
-
-                int iap = sym[isym].spg_op.inv_sym_atom[ia];
-                dm_ia.zero();
-
-                int at_lvl1 =
-                    find_orbital_index(iap, atom.type().lo_descriptor_hub(atomic_orbitals_[at_lvl].second).n(),
-                                       atom.type().lo_descriptor_hub(atomic_orbitals_[at_lvl].second).l());
-
-                for (int ispn = 0; ispn < ((ctx_.num_mag_dims() == 3) ? (4) : ctx_.num_spins()); ispn++) {
-                    for (int m1 = 0; m1 < lmmax_at; m1++) {
-                        for (int m2 = 0; m2 < lmmax_at; m2++) {
-                            for (int m1p = 0; m1p < lmmax_at; m1p++) {
-                                for (int m2p = 0; m2p < lmmax_at; m2p++) {
-                                    dm_ia(m1, m2, ispn) +=
-                                        rotm[il](m1, m1p) * rotm[il](m2, m2p) * local_tmp[at_lvl1](m1p, m2p, ispn) * f;
-                                }
-                            }
-                        }
-                    }
-                }
-
-                if (ctx_.num_mag_dims() == 0) {
-                    for (int m1 = 0; m1 < lmmax_at; m1++) {
-                        for (int m2 = 0; m2 < lmmax_at; m2++) {
-                            local_[at_lvl](m1, m2, 0) += dm_ia(m1, m2, 0);
-                        }
-                    }
+    /* spatial rotation matrices and spin transformation of each symmetry operation;
+     * the spin part is stored as a stacked matrix of size (nc * nsym) x nc such that the spin rotation and
+     * the sum over symmetry operations is done with a single GEMM */
+    std::vector<std::vector<sddk::mdarray<double, 2>>> rotm(nsym);
+    sddk::mdarray<std::complex<double>, 3> spin_rotm(nc, nsym, nc);
+    spin_rotm.zero();
+    for (int isym = 0; isym < nsym; isym++) {
+        rotm[isym] = sht::rotation_matrix<double>(lmax, sym[isym].spg_op.euler_angles, sym[isym].spg_op.proper);
+
+        if (ctx_.num_mag_dims() == 0) {
+            spin_rotm(0, isym, 0) = 1;
+        } else {
+            auto spin_rot_su2 = rotation_matrix_su2(sym[isym].spin_rotation);
+            /* spin indices of each component */
+            int const s1[] = {0, 1, 1, 0};
+            int const s2[] = {0, 1, 0, 1};
+            /* n'^{s1,s2} = \sum_{s1',s2'} U_{s1,s1'} n^{s1',s2'} U^{*}_{s2,s2'}; in the collinear case the
+             * off-diagonal components of the input are zero and are not stored */
+            for (int k = 0; k < nc; k++) {
+                for (int kp = 0; kp < nc; kp++) {
+                    spin_rotm(kp, isym, k) = spin_rot_su2(s1[k], s1[kp]) * std::conj(spin_rot_su2(s2[k], s2[kp]));
                 }
+            }
+        }
+    }
 
-                if (ctx_.num_mag_dims() == 1) {
-                    int const map_s[3][2] = {{0, 0}, {1, 1}, {0, 1}};
-                    for (int j = 0; j < 2; j++) {
-                        int s1 = map_s[j][0];
-                        int s2 = map_s[j][1];
-
-                        for (int m1 = 0; m1 < lmmax_at; m1++) {
-                            for (int m2 = 0; m2 < lmmax_at; m2++) {
-                                std::complex<double> dm[2][2] = {{dm_ia(m1, m2, 0), 0}, {0, dm_ia(m1, m2, 1)}};
-
-                                for (int s1p = 0; s1p < 2; s1p++) {
-                                    for (int s2p = 0; s2p < 2; s2p++) {
-                                        local_[at_lvl](m1, m2, j) +=
-                                            dm[s1p][s2p] * spin_rot_su2(s1, s1p) * std::conj(spin_rot_su2(s2, s2p));
-                                    }
-                                }
-                            }
+    /* Symmetrize a group of (2 l1 + 1) x (2 l2 + 1) blocks. Input array contains the unsymmetrized blocks of the
+     * pre-image atoms for each symmetry operation and for each block of the group. The spatial rotation
+     * R_{l1} n R_{l2}^{T} is real and is applied to the real and imaginary parts of all spin components and all
+     * blocks of the group with two real GEMMs per symmetry operation. */
+    auto symmetrize_blocks = [&](int l1, int l2, sddk::mdarray<std::complex<double>, 4> const& dm__,
+            std::vector<sddk::mdarray<std::complex<double>, 3>*> const& dm_sym__)
+    {
+        int n1   = 2 * l1 + 1;
+        int n2   = 2 * l2 + 1;
+        int n    = n1 * n2;
+        int nblk = static_cast<int>(dm__.size(3));
+        /* number of real n1 x n2 matrices rotated at once */
+        int nm = 2 * nc * nblk;
+
+        /* matrices are stored as x(m1, k, m2) such that x is a (n1 * nm) x n2 matrix for the right multiplication
+         * and a n1 x (nm * n2) matrix for the left multiplication */
+        sddk::mdarray<double, 3> x(n1, nm, n2);
+        sddk::mdarray<double, 3> z(n1, nm, n2);
+        sddk::mdarray<std::complex<double>, 4> dm_rot(n, nc, nsym, nblk);
+        for (int isym = 0; isym < nsym; isym++) {
+            for (int iblk = 0; iblk < nblk; iblk++) {
+                for (int ispn = 0; ispn < nc; ispn++) {
+                    int k = 2 * (ispn + nc * iblk);
+                    for (int m2 = 0; m2 < n2; m2++) {
+                        for (int m1 = 0; m1 < n1; m1++) {
+                            auto v = dm__(m1 + n1 * m2, ispn, isym, iblk);
+                            x(m1, k, m2)     = v.real();
+                            x(m1, k + 1, m2) = v.imag();
                         }
                     }
                 }
-
-                if (ctx_.num_mag_dims() == 3) {
-                    int s_idx[2][2] = {{0, 3}, {2, 1}};
-                    for (int m1 = 0; m1 < lmmax_at; m1++) {
-                        for (int m2 = 0; m2 < lmmax_at; m2++) {
-
-                            std::complex<double> dm[2][2];
-                            std::complex<double> dm1[2][2] = {{0.0, 0.0}, {0.0, 0.0}};
-                            for (int s1 = 0; s1 < ctx_.num_spins(); s1++) {
-                                for (int s2 = 0; s2 < ctx_.num_spins(); s2++) {
-                                    dm[s1][s2] = dm_ia(m1, m2, s_idx[s1][s2]);
-                                }
-                            }
-
-                            for (int i = 0; i < 2; i++) {
-                                for (int j = 0; j < 2; j++) {
-                                    for (int s1p = 0; s1p < 2; s1p++) {
-                                        for (int s2p = 0; s2p < 2; s2p++) {
-                                            dm1[i][j] +=
-                                                dm[s1p][s2p] * spin_rot_su2(i, s1p) * std::conj(spin_rot_su2(j, s2p));
-                                        }
-                                    }
-                                }
-                            }
-
-                            for (int s1 = 0; s1 < ctx_.num_spins(); s1++) {
-                                for (int s2 = 0; s2 < ctx_.num_spins(); s2++) {
-                                    local_[at_lvl](m1, m2, s_idx[s1][s2]) += dm1[s1][s2];
-                                }
-                            }
+            }
+            auto const& R1 = rotm[isym][l1];
+            auto const& R2 = rotm[isym][l2];
+            /* z = x R_{l2}^{T} */
+            la::wrap(la::lib_t::blas).gemm('N', 'T', n1 * nm, n2, n2, &la::constant<double>::one(),
+                    x.at(sddk::memory_t::host), n1 * nm, R2.at(sddk::memory_t::host), R2.ld(),
+                    &la::constant<double>::zero(), z.at(sddk::memory_t::host), n1 * nm);
+            /* x = R_{l1} z */
+            la::wrap(la::lib_t::blas).gemm('N', 'N', n1, nm * n2, n1, &la::constant<double>::one(),
+                    R1.at(sddk::memory_t::host), R1.ld(), z.at(sddk::memory_t::host), n1,
+                    &la::constant<double>::zero(), x.at(sddk::memory_t::host), n1);
+            for (int iblk = 0; iblk < nblk; iblk++) {
+                for (int ispn = 0; ispn < nc; ispn++) {
+                    int k = 2 * (ispn + nc * iblk);
+                    for (int m2 = 0; m2 < n2; m2++) {
+                        for (int m1 = 0; m1 < n1; m1++) {
+                            dm_rot(m1 + n1 * m2, ispn, isym, iblk) = std::complex<double>(x(m1, k, m2),
+                                                                                          x(m1, k + 1, m2));
                         }
                     }
                 }
             }
         }
+        /* apply spin rotation and average over symmetry operations */
+        std::complex<double> alpha(1.0 / nsym, 0);
+        for (int iblk = 0; iblk < nblk; iblk++) {
+            dm_sym__[iblk]->zero();
+            la::wrap(la::lib_t::blas).gemm('N', 'N', n, nc, nc * nsym, &alpha,
+                    dm_rot.at(sddk::memory_t::host, 0, 0, 0, iblk), n, spin_rotm.at(sddk::memory_t::host), nc * nsym,
+                    &la::constant<std::complex<double>>::zero(), dm_sym__[iblk]->at(sddk::memory_t::host), n);
+        }
+    };
+
+    /* apply the time reversal sigma_y n^{*} sigma_y to the block of the pre-image atom if the symmetry operation is
+     * antiunitary; components are stored as uu, dd, du, ud */
+    auto time_reversal = [&](int isym, int iblk, int n, sddk::mdarray<std::complex<double>, 4>& dm__)
+    {
+        if (!sym[isym].time_reversal) {
+            return;
+        }
+        for (int i = 0; i < n; i++) {
+            if (nc == 1) {
+                dm__(i, 0, isym, iblk) = std::conj(dm__(i, 0, isym, iblk));
+                continue;
+            }
+            auto uu = dm__(i, 0, isym, iblk);
+            auto dd = dm__(i, 1, isym, iblk);
+            dm__(i, 0, isym, iblk) = std::conj(dd);
+            dm__(i, 1, isym, iblk) = std::conj(uu);
+            if (nc == 4) {
+                auto du = dm__(i, 2, isym, iblk);
+                auto ud = dm__(i, 3, isym, iblk);
+                dm__(i, 2, isym, iblk) = -std::conj(ud);
+                dm__(i, 3, isym, iblk) = -std::conj(du);
+            }
+        }
+    };
+
+    std::vector<sddk::mdarray<std::complex<double>, 3>> local_tmp(local_.size());
+    for (int at_lvl = 0; at_lvl < static_cast<int>(local_.size()); at_lvl++) {
+        local_tmp[at_lvl] = sddk::mdarray<std::complex<double>, 3>(local_[at_lvl].size(0), local_[at_lvl].size(1), 4);
+        sddk::copy(local_[at_lvl], local_tmp[at_lvl]);
     }
 
-    if (ctx_.cfg().hubbard().nonlocal().size() && ctx_.num_mag_dims() == 3) {
-        RTE_THROW("non-collinear nonlocal occupancy symmetrization is not implemented");
+    /* group the atomic levels by orbital quantum number; blocks of the same size are rotated together */
+    std::map<int, std::vector<int>> local_groups;
+    for (int at_lvl = 0; at_lvl < static_cast<int>(local_.size()); at_lvl++) {
+        auto const& atom = ctx_.unit_cell().atom(atomic_orbitals_[at_lvl].first);
+        auto const& lo   = atom.type().lo_descriptor_hub(atomic_orbitals_[at_lvl].second);
+        // we can skip the symmetrization for this atomic level since it does not contribute to the Hubbard correction
+        // (or U = 0)
+        if (!lo.use_for_calculation()) {
+            local_[at_lvl].zero();
+            continue;
+        }
+        local_groups[lo.l()].push_back(at_lvl);
     }
 
-    /* a pair of "total number, offests" for the Hubbard orbitals indexing */
-    auto r = ctx_.unit_cell().num_hubbard_wf();
+    for (auto const& g : local_groups) {
+        int il       = g.first;
+        int lmmax_at = 2 * il + 1;
+        int nblk     = static_cast<int>(g.second.size());
+
+        /* collect the blocks of the pre-image atoms */
+        sddk::mdarray<std::complex<double>, 4> dm(lmmax_at * lmmax_at, nc, nsym, nblk);
+        std::vector<sddk::mdarray<std::complex<double>, 3>*> dm_sym(nblk);
+        for (int iblk = 0; iblk < nblk; iblk++) {
+            int at_lvl     = g.second[iblk];
+            const int ia   = atomic_orbitals_[at_lvl].first;
+            auto const& lo = ctx_.unit_cell().atom(ia).type().lo_descriptor_hub(atomic_orbitals_[at_lvl].second);
+            for (int isym = 0; isym < nsym; isym++) {
+                int iap     = sym[isym].spg_op.inv_sym_atom[ia];
+                int at_lvl1 = find_orbital_index(iap, lo.n(), il);
+                std::copy(local_tmp[at_lvl1].at(sddk::memory_t::host),
+                          local_tmp[at_lvl1].at(sddk::memory_t::host) + lmmax_at * lmmax_at * nc,
+                          dm.at(sddk::memory_t::host, 0, 0, isym, iblk));
+                time_reversal(isym, iblk, lmmax_at * lmmax_at, dm);
+            }
+            dm_sym[iblk] = &local_[at_lvl];
+        }
+        symmetrize_blocks(il, il, dm, dm_sym);
+    }
 
+    /* group the inter-site blocks by the pair of orbital quantum numbers */
+    std::map<std::pair<int, int>, std::vector<int>> nonlocal_groups;
     for (int i = 0; i < static_cast<int>(ctx_.cfg().hubbard().nonlocal().size()); i++) {
         auto nl = ctx_.cfg().hubbard().nonlocal(i);
-        int ia  = nl.atom_pair()[0];
-        int ja  = nl.atom_pair()[1];
-        int il  = nl.l()[0];
-        int jl  = nl.l()[1];
-        int n1  = nl.n()[0];
-        int n2  = nl.n()[1];
-        int ib  = 2 * il + 1;
-        int jb  = 2 * jl + 1;
-        auto T  = nl.T();
-        nonlocal_[i].zero();
-        for (int isym = 0; isym < sym.size(); isym++) {
-            int pr            = sym[isym].spg_op.proper;
-            auto eang         = sym[isym].spg_op.euler_angles;
-            auto rotm         = sht::rotation_matrix<double>(4, eang, pr);
-            auto spin_rot_su2 = rotation_matrix_su2(sym[isym].spin_rotation);
-
-            int iap = sym[isym].spg_op.inv_sym_atom[ia];
-            int jap = sym[isym].spg_op.inv_sym_atom[ja];
+        nonlocal_groups[std::make_pair(nl.l()[0], nl.l()[1])].push_back(i);
+    }
 
-            auto Ttot = sym[isym].spg_op.inv_sym_atom_T[ja] - sym[isym].spg_op.inv_sym_atom_T[ia] +
-                        dot(sym[isym].spg_op.invR, r3::vector<int>(T));
+    for (auto const& g : nonlocal_groups) {
+        int il   = g.first.first;
+        int jl   = g.first.second;
+        int ib   = 2 * il + 1;
+        int jb   = 2 * jl + 1;
+        int nblk = static_cast<int>(g.second.size());
+
+        /* collect the blocks of the pre-image atom pairs */
+        sddk::mdarray<std::complex<double>, 4> dm(ib * jb, nc, nsym, nblk);
+        std::vector<sddk::mdarray<std::complex<double>, 3>*> dm_sym(nblk);
+        for (int iblk = 0; iblk < nblk; iblk++) {
+            int i   = g.second[iblk];
+            auto nl = ctx_.cfg().hubbard().nonlocal(i);
+            int ia  = nl.atom_pair()[0];
+            int ja  = nl.atom_pair()[1];
+            int n1  = nl.n()[0];
+            int n2  = nl.n()[1];
+            auto T  = nl.T();
+
+            for (int isym = 0; isym < nsym; isym++) {
+                int iap = sym[isym].spg_op.inv_sym_atom[ia];
+                int jap = sym[isym].spg_op.inv_sym_atom[ja];
 
-            /* we must search for the right hubbard subspace since we may have
-             * multiple orbitals involved in the hubbard correction */
+                auto Ttot = sym[isym].spg_op.inv_sym_atom_T[ja] - sym[isym].spg_op.inv_sym_atom_T[ia] +
+                            dot(sym[isym].spg_op.invR, r3::vector<int>(T));
 
-            /* NOTE : the atom order is important here. */
-            int at1_lvl    = find_orbital_index(iap, n1, il);
-            int at2_lvl    = find_orbital_index(jap, n2, jl);
-            auto& occ_mtrx = occ_mtrx_T_[Ttot];
+                /* we must search for the right hubbard subspace since we may have
+                 * multiple orbitals involved in the hubbard correction */
 
-            sddk::mdarray<std::complex<double>, 3> dm_ia_ja(2 * il + 1, 2 * jl + 1, ctx_.num_spins());
-            dm_ia_ja.zero();
-            /* apply spatial rotation */
-            for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
-                for (int m1 = 0; m1 < ib; m1++) {
-                    for (int m2 = 0; m2 < jb; m2++) {
-                        for (int m1p = 0; m1p < ib; m1p++) {
-                            for (int m2p = 0; m2p < jb; m2p++) {
-                                dm_ia_ja(m1, m2, ispn) +=
-                                    rotm[il](m1, m1p) * rotm[jl](m2, m2p) *
-                                    occ_mtrx(offset_[at1_lvl] + m1p, offset_[at2_lvl] + m2p, ispn) * f;
-                            }
-                        }
-                    }
-                }
-            }
+                /* NOTE : the atom order is important here. */
+                int at1_lvl    = find_orbital_index(iap, n1, il);
+                int at2_lvl    = find_orbital_index(jap, n2, jl);
+                auto& occ_mtrx = occ_mtrx_T_[Ttot];
 
-            if (ctx_.num_mag_dims() == 0) {
-                for (int m1 = 0; m1 < ib; m1++) {
+                for (int ispn = 0; ispn < nc; ispn++) {
                     for (int m2 = 0; m2 < jb; m2++) {
-                        nonlocal_[i](m1, m2, 0) += dm_ia_ja(m1, m2, 0);
-                    }
-                }
-            }
-            if (ctx_.num_mag_dims() == 1) {
-                int const map_s[3][2] = {{0, 0}, {1, 1}, {0, 1}};
-                for (int j = 0; j < 2; j++) {
-                    int s1 = map_s[j][0];
-                    int s2 = map_s[j][1];
-
-                    for (int m1 = 0; m1 < ib; m1++) {
-                        for (int m2 = 0; m2 < jb; m2++) {
-                            std::complex<double> dm[2][2] = {{dm_ia_ja(m1, m2, 0), 0}, {0, dm_ia_ja(m1, m2, 1)}};
-
-                            for (int s1p = 0; s1p < 2; s1p++) {
-                                for (int s2p = 0; s2p < 2; s2p++) {
-                                    nonlocal_[i](m1, m2, j) +=
-                                        dm[s1p][s2p] * spin_rot_su2(s1, s1p) * std::conj(spin_rot_su2(s2, s2p));
-                                }
-                            }
+                        for (int m1 = 0; m1 < ib; m1++) {
+                            dm(m1 + ib * m2, ispn, isym, iblk) =
+                                occ_mtrx(offset_[at1_lvl] + m1, offset_[at2_lvl] + m2, ispn);
                         }
                     }
                 }
+                time_reversal(isym, iblk, ib * jb, dm);
             }
+            dm_sym[iblk] = &nonlocal_[i];
         }
+        symmetrize_blocks(il, jl, dm, dm_sym);
     }
 }
+
 void
 Occupation_matrix::init()
 {
@@ -36,7 +36,11 @@ class Occupation_matrix : public Hubbard_matrix
   public:
     Occupation_matrix(Simulation_context& ctx__);
 
-    template <typename T>
+    /// Add contribution of a k-point to the occupation matrix.
+    /** \tparam T  Precision of the wave-functions.
+     *  \tparam F  Type of the subspace (real for the Gamma-point calculation, complex otherwise).
+     */
+    template <typename T, typename F>
     void add_k_point_contribution(K_point<T>& kp__);
 
     /** The initial occupancy is calculated following Hund rules. We first
@@ -62,7 +66,7 @@ class Occupation_matrix : public Hubbard_matrix
 
         /* reduce occ_mtrx_T_ (not nonlocal - it is computed during symmetrization from occ_mtrx_T_) */
         for (auto& T : this->occ_mtrx_T_) {
-            ctx_.comm().allreduce(T.second.at(sddk::memory_t::host), static_cast<int>(T.second.size()));
+            ctx_.comm().allreduce(T.second.at(sddk::memory_t::host), T.second.size());
         }
     }
 
@@ -51,6 +51,103 @@ DFT_ground_state::initial_state()
     }
 }
 
+void
+DFT_ground_state::initial_state(DFT_ground_state& src__)
+{
+    PROFILE("sirius::DFT_ground_state::initial_state");
+
+    if (ctx_.full_potential()) {
+        RTE_THROW("continuation from a different calculation is implemented only for the pseudopotential case");
+    }
+
+    density_.initial_density(src__.density());
+    potential_.generate(density_, ctx_.use_symmetry(), true);
+
+    if (ctx_.cfg().parameters().precision_wf() == "fp32") {
+#if defined(USE_FP32)
+        Hamiltonian0<float> H0(potential_, true);
+        Band(ctx_).initialize_subspace(kset_, H0);
+#else
+        RTE_THROW("not compiled with FP32 support");
+#endif
+        return;
+    }
+
+    Hamiltonian0<double> H0(potential_, true);
+    Band(ctx_).initialize_subspace(kset_, H0);
+
+    auto& kset_src = src__.k_point_set();
+
+    /* wave-functions can be reused only if both k-point sets are identical and distributed in the same way */
+    bool same_kset = (kset_src.num_kpoints() == kset_.num_kpoints()) &&
+                     (kset_src.comm().size() == kset_.comm().size()) &&
+                     (src__.ctx().cfg().parameters().precision_wf() == "fp64");
+    for (int ik = 0; same_kset && ik < kset_.num_kpoints(); ik++) {
+        auto dk = kset_.get<double>(ik)->vk() - kset_src.get<double>(ik)->vk();
+        if (dk.length() > 1e-10) {
+            same_kset = false;
+        }
+    }
+    if (!same_kset) {
+        std::stringstream s;
+        s << "k-point sets are different; starting from the fresh subspace of wave-functions";
+        ctx_.message(1, __func__, s);
+        return;
+    }
+
+    int nb = std::min(src__.ctx().num_bands(), ctx_.num_bands());
+
+    for (int ikloc = 0; ikloc < kset_.spl_num_kpoints().local_size(); ikloc++) {
+        int ik      = kset_.spl_num_kpoints(ikloc);
+        auto kp     = kset_.get<double>(ik);
+        auto kp_src = kset_src.get<double>(ik);
+
+        auto& gkvec_src = kp_src->gkvec();
+        auto& comm      = gkvec_src.comm();
+
+        /* global index of the source G+k vectors */
+        std::map<r3::vector<int>, int> idx_src;
+        for (int ig = 0; ig < gkvec_src.num_gvec(); ig++) {
+            idx_src[gkvec_src.gvec<sddk::index_domain_t::global>(ig)] = ig;
+        }
+        std::vector<int> idx(kp->num_gkvec_loc(), -1);
+        for (int igloc = 0; igloc < kp->num_gkvec_loc(); igloc++) {
+            auto it = idx_src.find(kp->gkvec().gvec<sddk::index_domain_t::local>(igloc));
+            if (it != idx_src.end()) {
+                idx[igloc] = it->second;
+            }
+        }
+
+        std::vector<int> counts(comm.size());
+        std::vector<int> offsets(comm.size());
+        for (int r = 0; r < comm.size(); r++) {
+            counts[r]  = gkvec_src.gvec_count(r);
+            offsets[r] = gkvec_src.gvec_offset(r);
+        }
+
+        auto& psi_src = kp_src->spinor_wave_functions();
+        auto& psi     = kp->spinor_wave_functions();
+
+        std::vector<std::complex<double>> tmp(gkvec_src.num_gvec());
+        for (int is = 0; is < psi.num_sc().get(); is++) {
+            for (int i = 0; i < nb; i++) {
+                comm.allgather(&psi_src.pw_coeffs(0, wf::spin_index(is), wf::band_index(i)), gkvec_src.count(),
+                               tmp.data(), counts.data(), offsets.data());
+                for (int igloc = 0; igloc < kp->num_gkvec_loc(); igloc++) {
+                    psi.pw_coeffs(igloc, wf::spin_index(is), wf::band_index(i)) =
+                        (idx[igloc] >= 0) ? tmp[idx[igloc]] : std::complex<double>(0, 0);
+                }
+            }
+        }
+        for (int ispn = 0; ispn < ctx_.num_spinors(); ispn++) {
+            for (int j = 0; j < nb; j++) {
+                kp->band_energy(j, ispn, kp_src->band_energy(j, ispn));
+            }
+        }
+    }
+    kset_.sync_band<double, sync_band_t::energy>();
+}
+
 void
 DFT_ground_state::update()
 {
@@ -183,6 +280,10 @@ json
 DFT_ground_state::find(double density_tol__, double energy_tol__, double iter_solver_tol__, int num_dft_iter__,
                        bool write_state__)
 {
+    if (ctx_.cfg().parameters().ground_state_solver() == "direct_minimization") {
+        return find_direct_minimization(energy_tol__, num_dft_iter__, write_state__);
+    }
+
     PROFILE("sirius::DFT_ground_state::scf_loop");
 
     auto tstart = std::chrono::high_resolution_clock::now();
@@ -197,6 +298,13 @@ DFT_ground_state::find(double density_tol__, double energy_tol__, double iter_so
 
     Density rho1(ctx_);
 
+    /* k-point independent part of the Hamiltonian is kept across iterations and only refreshed from the new
+     * potential; this avoids the reallocation of the local and non-local operators in each iteration */
+#if defined(USE_FP32)
+    std::unique_ptr<Hamiltonian0<float>> H0_fp32;
+#endif
+    std::unique_ptr<Hamiltonian0<double>> H0_fp64;
+
     std::stringstream s;
     s << "density_tol               : " << density_tol__ << std::endl
       << "energy_tol                : " << energy_tol__ << std::endl
@@ -216,7 +324,12 @@ DFT_ground_state::find(double density_tol__, double energy_tol__, double iter_so
 
         if (ctx_.cfg().parameters().precision_wf() == "fp32") {
 #if defined(USE_FP32)
-            Hamiltonian0<float> H0(potential_, true);
+            if (H0_fp32) {
+                H0_fp32->update(true);
+            } else {
+                H0_fp32 = std::make_unique<Hamiltonian0<float>>(potential_, true);
+            }
+            auto& H0 = *H0_fp32;
             /* find new wave-functions */
             if (ctx_.cfg().parameters().precision_hs() == "fp32") {
                 Band(ctx_).solve<float, float>(kset_, H0, iter_solver_tol__);
@@ -231,7 +344,12 @@ DFT_ground_state::find(double density_tol__, double energy_tol__, double iter_so
             RTE_THROW("not compiled with FP32 support");
 #endif
         } else {
-            Hamiltonian0<double> H0(potential_, true);
+            if (H0_fp64) {
+                H0_fp64->update(true);
+            } else {
+                H0_fp64 = std::make_unique<Hamiltonian0<double>>(potential_, true);
+            }
+            auto& H0 = *H0_fp64;
             /* find new wave-functions */
             Band(ctx_).solve<double, double>(kset_, H0, iter_solver_tol__);
             /* find band occupancies */
@@ -272,6 +390,8 @@ DFT_ground_state::find(double density_tol__, double energy_tol__, double iter_so
                     ctx_.cfg().parameters().precision_wf("fp64");
                     ctx_.cfg().parameters().precision_hs("fp64");
                     ctx_.cfg().lock();
+                    /* single precision Hamiltonian is not needed any more */
+                    H0_fp32.reset();
 
                     for (int ikloc = 0; ikloc < kset_.spl_num_kpoints().local_size(); ikloc++) {
                         int ik = kset_.spl_num_kpoints(ikloc);
@@ -411,16 +531,18 @@ DFT_ground_state::print_info(std::ostream& out__) const
     double evalsum1     = kset_.valence_eval_sum();
     double evalsum2     = core_eval_sum(ctx_.unit_cell());
     double s_sum        = kset_.entropy_sum();
-    double ekin         = energy_kin(ctx_, kset_, density_, potential_);
-    double evxc         = energy_vxc(density_, potential_);
-    double eexc         = energy_exc(density_, potential_);
-    double ebxc         = energy_bxc(density_, potential_);
-    double evha         = energy_vha(potential_);
+    auto e              = energy_integrals(density_, potential_);
+    double ekin         = energy_kin(ctx_, kset_, e);
+    double evxc         = e.vxc;
+    double eexc         = e.exc;
+    double ebxc         = e.bxc;
+    double evha         = e.vha;
     double hub_one_elec = one_electron_energy_hubbard(density_, potential_);
-    double etot         = total_energy();
+    double etot         = sirius::total_energy(ctx_, kset_, density_, potential_, ewald_energy_, e) +
+                          this->scf_correction_energy_;
     double gap          = kset_.band_gap() * ha2ev;
     double ef           = kset_.energy_fermi();
-    double enuc         = energy_enuc(ctx_, potential_);
+    double enuc         = e.enuc;
 
     double one_elec_en = evalsum1 - (evxc + evha + ebxc);
 
@@ -72,6 +72,10 @@ class DFT_ground_state
     /// Correction to total energy from the SCF density minimisation.
     double scf_correction_energy_{0};
 
+    /// Minimize the total energy with respect to the wave-functions; F is the type of the subspace matrices.
+    template <typename F>
+    json direct_minimization(double energy_tol__, int num_steps__, bool write_state__);
+
   public:
     /// Constructor.
     DFT_ground_state(K_point_set& kset__)
@@ -153,12 +157,21 @@ class DFT_ground_state
     /// Generate initial density, potential and a subspace of wave-functions.
     void initial_state();
 
+    /// Generate initial state from the ground state of a cheaper calculation.
+    /** The source calculation can have lower cutoffs and a coarser k-point mesh. Density is interpolated by the
+     *  zero-padding in G. Wave-functions are re-indexed by G+k vectors if both k-point sets are identical,
+     *  otherwise a fresh subspace is generated in the new potential. */
+    void initial_state(DFT_ground_state& src__);
+
     /// Update the parameters after the change of lattice vectors or atomic positions.
     void update();
 
     /// Run the SCF ground state calculation and find a total energy minimum.
     json find(double density_tol, double energy_tol, double initial_tolerance, int num_dft_iter, bool write_state);
 
+    /// Find the ground state by the direct minimization of the total energy with the preconditioned CG method.
+    json find_direct_minimization(double energy_tol, int num_steps, bool write_state);
+
     /// Print the basic information (total energy, charges, moments, etc.).
     void print_info(std::ostream& out__) const;
 
@@ -0,0 +1,511 @@
+// Copyright (c) 2013-2023 Anton Kozhevnikov, Thomas Schulthess
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+// the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+//    following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+//    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** \file direct_minimization.cpp
+ *
+ *  \brief Direct minimization of the Kohn-Sham total energy with the preconditioned conjugate gradient method.
+ *
+ *  For insulators the occupation numbers are fixed and the energy is minimized with respect to the occupied
+ *  wave-functions. For metals (ensemble = true) the free energy E - TS is minimized: the inner CG loop optimizes
+ *  all bands at fixed occupation numbers, the outer loop diagonalizes the subspace Hamiltonian and sets the
+ *  occupation numbers and the entropy term from its eigen-values with the smearing function.
+ */
+
+#include <iomanip>
+#include "dft_ground_state.hpp"
+#include "band/band.hpp"
+#include "band/residuals.hpp"
+#include "linalg/inverse_sqrt.hpp"
+#include "multi_cg/multi_cg.hpp"
+#include "utils/profiler.hpp"
+
+namespace sirius {
+
+/// Work arrays of the direct minimization for a single k-point.
+template <typename T, typename F>
+struct direct_minimization_kp_data
+{
+    /// Wave-functions at the beginning of the line search.
+    std::unique_ptr<wf::Wave_functions<T>> psi0;
+    /// Hamiltonian applied to the wave-functions.
+    std::unique_ptr<wf::Wave_functions<T>> hpsi;
+    /// S-operator applied to the wave-functions.
+    std::unique_ptr<wf::Wave_functions<T>> spsi;
+    /// Gradient of the energy (without occupation numbers and k-point weight).
+    std::unique_ptr<wf::Wave_functions<T>> grad;
+    /// Preconditioned gradient, projected to the tangent space.
+    std::unique_ptr<wf::Wave_functions<T>> pgrad;
+    /// Preconditioned gradient of the previous step.
+    std::unique_ptr<wf::Wave_functions<T>> pgrad_old;
+    /// Search direction.
+    std::unique_ptr<wf::Wave_functions<T>> dir;
+    /// Number of optimized bands for each spinor index.
+    std::array<int, 2> nb{{0, 0}};
+    /// Subspace Hamiltonian <psi|H|psi> for each spinor index.
+    std::array<std::unique_ptr<la::dmatrix<F>>, 2> lambda;
+};
+
+json
+DFT_ground_state::find_direct_minimization(double energy_tol__, int num_steps__, bool write_state__)
+{
+    if (ctx_.full_potential()) {
+        RTE_THROW("direct minimization is implemented only for the pseudopotential case");
+    }
+    if (ctx_.processing_unit() != sddk::device_t::CPU) {
+        RTE_THROW("direct minimization is implemented only for the CPU");
+    }
+    if (ctx_.cfg().parameters().precision_wf() != "fp64") {
+        RTE_THROW("direct minimization requires fp64 wave-functions");
+    }
+
+    if (ctx_.gamma_point()) {
+        return direct_minimization<double>(energy_tol__, num_steps__, write_state__);
+    } else {
+        return direct_minimization<std::complex<double>>(energy_tol__, num_steps__, write_state__);
+    }
+}
+
+template <typename F>
+json
+DFT_ground_state::direct_minimization(double energy_tol__, int num_steps__, bool write_state__)
+{
+    PROFILE("sirius::DFT_ground_state::direct_minimization");
+
+    using T = double;
+
+    auto tstart = std::chrono::high_resolution_clock::now();
+
+    auto const& cfg = ctx_.cfg().direct_minimization();
+    auto& spla_ctx  = ctx_.spla_context();
+    auto mem        = sddk::memory_t::host;
+
+    const bool nc_mag      = (ctx_.num_mag_dims() == 3);
+    const int num_spinors  = (ctx_.num_mag_dims() == 1) ? 2 : 1;
+    const bool ensemble    = cfg.ensemble();
+    const int nk           = kset_.spl_num_kpoints().local_size();
+    auto num_md            = wf::num_mag_dims(ctx_.num_mag_dims());
+
+    /* energy is variational; there is no correction from the density mixing */
+    scf_correction_energy_ = 0;
+
+    /* Hamiltonian is updated in place after each change of the wave-functions */
+    Hamiltonian0<T> H0(potential_, true);
+
+    /* band energies in the initial potential define the occupied subspace; initialize_subspace() leaves them
+     * at zero */
+    Band(ctx_).solve<T, T>(kset_, H0, ctx_.cfg().iterative_solver().energy_tolerance());
+    kset_.find_band_occupancies<T>();
+
+    /* smearing contribution -TS to the free energy; it depends only on the occupation numbers and is updated
+     * together with them */
+    double ts_sum = kset_.entropy_sum();
+
+    std::vector<direct_minimization_kp_data<T, F>> kpd(nk);
+    for (int ikloc = 0; ikloc < nk; ikloc++) {
+        auto kp = kset_.get<T>(kset_.spl_num_kpoints(ikloc));
+        auto& d = kpd[ikloc];
+        for (auto w : {&d.psi0, &d.hpsi, &d.spsi, &d.grad, &d.pgrad, &d.pgrad_old, &d.dir}) {
+            *w = wave_function_factory(ctx_, *kp, wf::num_bands(ctx_.num_bands()), num_md, false);
+        }
+        for (int ispn_step = 0; ispn_step < num_spinors; ispn_step++) {
+            if (ensemble) {
+                /* occupation numbers change in the outer loop, so all bands are optimized */
+                d.nb[ispn_step] = ctx_.num_bands();
+            } else {
+                /* only occupied bands are optimized; occupation numbers are kept fixed, so they must be integer */
+                for (int j = 0; j < ctx_.num_bands(); j++) {
+                    auto f = kp->band_occupancy(j, ispn_step);
+                    if (f > ctx_.min_occupancy() * ctx_.max_occupancy()) {
+                        d.nb[ispn_step] = j + 1;
+                        if (std::abs(f - ctx_.max_occupancy()) > 1e-2 * ctx_.max_occupancy()) {
+                            RTE_THROW("fractional occupation numbers: use direct_minimization.ensemble = true");
+                        }
+                    }
+                }
+            }
+            if (d.nb[ispn_step]) {
+                d.lambda[ispn_step] = std::make_unique<la::dmatrix<F>>(d.nb[ispn_step], d.nb[ispn_step]);
+            }
+        }
+    }
+
+    /* execute function for each non-empty block of bands */
+    auto for_each_block = [&](auto&& func__)
+    {
+        for (int ikloc = 0; ikloc < nk; ikloc++) {
+            auto kp = kset_.get<T>(kset_.spl_num_kpoints(ikloc));
+            for (int ispn_step = 0; ispn_step < num_spinors; ispn_step++) {
+                if (kpd[ikloc].nb[ispn_step] == 0) {
+                    continue;
+                }
+                auto sr = nc_mag ? wf::spin_range(0, 2) : wf::spin_range(ispn_step);
+                func__(*kp, kpd[ikloc], ispn_step, sr, wf::band_range(0, kpd[ikloc].nb[ispn_step]));
+            }
+        }
+    };
+
+    /* Y <- alpha * X * M + beta * Y */
+    auto transform = [&](la::dmatrix<F> const& M__, T alpha__, wf::Wave_functions<T> const& X__, T beta__,
+                         wf::Wave_functions<T>& Y__, wf::spin_range sr__, wf::band_range br__)
+    {
+        for (auto s = sr__.begin(); s != sr__.end(); s++) {
+            auto sp = X__.actual_spin_index(s);
+            wf::transform<T, F>(spla_ctx, mem, M__, 0, 0, alpha__, X__, sp, br__, beta__, Y__, sp, br__);
+        }
+    };
+
+    auto copy = [&](wf::Wave_functions<T> const& X__, wf::Wave_functions<T>& Y__, wf::spin_range sr__,
+                    wf::band_range br__)
+    {
+        for (auto s = sr__.begin(); s != sr__.end(); s++) {
+            auto sp = X__.actual_spin_index(s);
+            wf::copy(mem, X__, sp, br__, Y__, sp, br__);
+        }
+    };
+
+    /* Y <- a * X + b * Y */
+    auto axpby = [&](F a__, wf::Wave_functions<T> const& X__, F b__, wf::Wave_functions<T>& Y__,
+                     wf::spin_range sr__, wf::band_range br__)
+    {
+        std::vector<F> a(br__.size(), a__);
+        std::vector<F> b(br__.size(), b__);
+        wf::axpby(mem, sr__, br__, a.data(), &X__, b.data(), &Y__);
+    };
+
+    /* X <- X - psi <psi|S|X>; projection to the tangent space at psi */
+    auto project = [&](K_point<T>& kp__, direct_minimization_kp_data<T, F>& d__, wf::Wave_functions<T>& X__,
+                       wf::spin_range sr__, wf::band_range br__)
+    {
+        la::dmatrix<F> o(br__.size(), br__.size());
+        wf::inner(spla_ctx, mem, sr__, *d__.spsi, br__, X__, br__, o, 0, 0);
+        transform(o, -1.0, kp__.spinor_wave_functions(), 1.0, X__, sr__, br__);
+    };
+
+    /* sum_k w_k sum_i f_i 2 Re <X_i|Y_i>; this is the directional derivative of the energy when X is the
+     * gradient and Y is the direction */
+    using wf_ptr_t = std::unique_ptr<wf::Wave_functions<T>> direct_minimization_kp_data<T, F>::*;
+    auto wdot = [&](wf_ptr_t X__, wf_ptr_t Y__)
+    {
+        double result{0};
+        for_each_block([&](K_point<T>& kp, direct_minimization_kp_data<T, F>& d, int ispn_step, wf::spin_range sr,
+                           wf::band_range br)
+        {
+            auto v = wf::inner_diag<T, F>(mem, *(d.*X__), *(d.*Y__), sr, wf::num_bands(br.size()));
+            for (int i = 0; i < br.size(); i++) {
+                result += 2 * kp.weight() * kp.band_occupancy(i, ispn_step) * std::real(v[i]);
+            }
+        });
+        ctx_.comm_k().allreduce(&result, 1);
+        return result;
+    };
+
+    /* Compute the energy for the current wave-functions. Wave-functions are S-orthonormalized first, then the
+     * density and potential are generated and the new Hamiltonian is applied. If requested, the gradient and the
+     * preconditioned gradient are computed. */
+    auto evaluate = [&](bool compute_gradient__)
+    {
+        PROFILE("sirius::DFT_ground_state::direct_minimization|evaluate");
+
+        /* Loewdin orthonormalization of the optimized bands; S-operator doesn't depend on the potential */
+        for_each_block([&](K_point<T>& kp, direct_minimization_kp_data<T, F>& d, int ispn_step, wf::spin_range sr,
+                           wf::band_range br)
+        {
+            auto Hk = H0(kp);
+            auto& psi = kp.spinor_wave_functions();
+            Hk.template apply_h_s<F>(sr, br, psi, nullptr, d.spsi.get());
+            la::dmatrix<F> o(br.size(), br.size());
+            wf::inner(spla_ctx, mem, sr, psi, br, *d.spsi, br, o, 0, 0);
+            auto B = std::move(std::get<0>(inverse_sqrt(o, br.size())));
+            /* grad is used as a temporary storage */
+            transform(*B, 1.0, psi, 0.0, *d.grad, sr, br);
+            copy(*d.grad, psi, sr, br);
+        });
+
+        density_.generate<T>(kset_, ctx_.use_symmetry(), true, true);
+        potential_.generate(density_, ctx_.use_symmetry(), true);
+        H0.update(true);
+
+        for_each_block([&](K_point<T>& kp, direct_minimization_kp_data<T, F>& d, int ispn_step, wf::spin_range sr,
+                           wf::band_range br)
+        {
+            auto Hk = H0(kp);
+            auto& psi = kp.spinor_wave_functions();
+            Hk.template apply_h_s<F>(sr, br, psi, d.hpsi.get(), d.spsi.get());
+
+            auto& lambda = *d.lambda[ispn_step];
+            wf::inner(spla_ctx, mem, sr, psi, br, *d.hpsi, br, lambda, 0, 0);
+
+            /* diagonal of the subspace Hamiltonian enters the band energy sum */
+            sddk::mdarray<T, 1> eval(br.size());
+            for (int i = 0; i < br.size(); i++) {
+                eval[i] = std::real(lambda(i, i));
+                kp.band_energy(i, ispn_step, eval[i]);
+            }
+
+            if (compute_gradient__) {
+                /* grad = H|psi> - S|psi> <psi|H|psi> */
+                copy(*d.hpsi, *d.grad, sr, br);
+                transform(lambda, -1.0, *d.spsi, 1.0, *d.grad, sr, br);
+
+                /* pgrad = K grad */
+                auto h_o_diag = Hk.template get_h_o_diag_pw<T, 3>();
+                lr::Smoothed_diagonal_preconditioner precond{std::move(h_o_diag.first), std::move(h_o_diag.second),
+                                                             std::move(eval), br.size(), sr};
+                lr::Wave_functions_wrap pgrad_wrap{d.pgrad.get()};
+                precond.apply(pgrad_wrap, lr::Wave_functions_wrap{d.grad.get()});
+                project(kp, d, *d.pgrad, sr, br);
+            }
+        });
+
+        kset_.sync_band<T, sync_band_t::energy>();
+
+        /* band energies are the diagonal of the subspace Hamiltonian and don't define the occupation numbers here;
+         * the entropy term of the current occupation numbers is used instead */
+        return sirius::total_energy(ctx_, kset_, density_, potential_, ewald_energy_) - kset_.entropy_sum() + ts_sum;
+    };
+
+    /* psi <- psi0 + t * dir */
+    auto move_along = [&](double t__)
+    {
+        for_each_block([&](K_point<T>& kp, direct_minimization_kp_data<T, F>& d, int ispn_step, wf::spin_range sr,
+                           wf::band_range br)
+        {
+            copy(*d.psi0, kp.spinor_wave_functions(), sr, br);
+            axpby(static_cast<F>(t__), *d.dir, static_cast<F>(1.0), kp.spinor_wave_functions(), sr, br);
+        });
+    };
+
+    /* rotate to the eigen-vectors of the subspace Hamiltonian and set the band energies */
+    auto subspace_rotation = [&]()
+    {
+        auto solver = la::Eigensolver_factory("lapack");
+        for_each_block([&](K_point<T>& kp, direct_minimization_kp_data<T, F>& d, int ispn_step, wf::spin_range sr,
+                           wf::band_range br)
+        {
+            la::dmatrix<F> evec(br.size(), br.size());
+            std::vector<T> eval(br.size());
+            if (solver->solve(br.size(), br.size(), *d.lambda[ispn_step], eval.data(), evec)) {
+                RTE_THROW("error in diagonalization of the subspace Hamiltonian");
+            }
+            auto& psi = kp.spinor_wave_functions();
+            transform(evec, 1.0, psi, 0.0, *d.grad, sr, br);
+            copy(*d.grad, psi, sr, br);
+            for (int i = 0; i < br.size(); i++) {
+                kp.band_energy(i, ispn_step, eval[i]);
+            }
+        });
+        kset_.sync_band<T, sync_band_t::energy>();
+    };
+
+    auto set_steepest_descent = [&]()
+    {
+        for_each_block([&](K_point<T>& kp, direct_minimization_kp_data<T, F>& d, int ispn_step, wf::spin_range sr,
+                           wf::band_range br)
+        {
+            copy(*d.pgrad, *d.dir, sr, br);
+            axpby(static_cast<F>(0.0), *d.pgrad, static_cast<F>(-1.0), *d.dir, sr, br);
+        });
+    };
+
+    using kpd_t = direct_minimization_kp_data<T, F>;
+
+    /* norm of the energy gradient per electron */
+    auto residual = [&]()
+    {
+        return std::sqrt(std::abs(wdot(&kpd_t::grad, &kpd_t::grad)) / 2 / std::max(1.0, unit_cell_.num_electrons()));
+    };
+
+    /* new occupation numbers from the eigen-values of the subspace Hamiltonian; this minimizes the free energy
+     * with respect to the occupation numbers (the outer-loop variables) at fixed wave-functions and potential */
+    auto update_occupancies = [&]()
+    {
+        subspace_rotation();
+        kset_.find_band_occupancies<T>();
+        ts_sum = kset_.entropy_sum();
+    };
+
+    double etot = evaluate(true);
+    set_steepest_descent();
+    double gpg_old = wdot(&kpd_t::grad, &kpd_t::pgrad);
+
+    double trial_step = cfg.trial_step();
+    int num_iter{-1};
+    int num_failed{0};
+    /* number of CG steps since the last update of the occupation numbers */
+    int num_inner{0};
+    std::vector<double> etot_hist;
+    std::vector<double> res_hist;
+
+    for (int iter = 0; iter < num_steps__; iter++) {
+        PROFILE("sirius::DFT_ground_state::direct_minimization|iteration");
+
+        double slope = wdot(&kpd_t::grad, &kpd_t::dir);
+        if (slope >= 0) {
+            /* not a descent direction; restart from the steepest descent */
+            set_steepest_descent();
+            slope = wdot(&kpd_t::grad, &kpd_t::dir);
+        }
+
+        /* keep the preconditioned gradient for the Polak-Ribiere update */
+        for (auto& d : kpd) {
+            std::swap(d.pgrad, d.pgrad_old);
+        }
+        for_each_block([&](K_point<T>& kp, kpd_t& d, int ispn_step, wf::spin_range sr, wf::band_range br)
+        {
+            copy(kp.spinor_wave_functions(), *d.psi0, sr, br);
+        });
+
+        double e0 = etot;
+
+        /* energy at the trial point */
+        move_along(trial_step);
+        double e1 = evaluate(false);
+
+        /* minimum of the parabola E(t) = e0 + slope * t + c * t^2 */
+        double c = (e1 - e0 - slope * trial_step) / std::pow(trial_step, 2);
+        double t = (c > 0) ? std::min(-slope / (2 * c), 4 * trial_step) : 2 * trial_step;
+
+        move_along(t);
+        etot = evaluate(true);
+
+        if (etot > e0) {
+            if (e1 < e0) {
+                /* the trial point is better */
+                t = trial_step;
+                move_along(t);
+                etot = evaluate(true);
+            } else {
+                /* go back and shrink the step */
+                move_along(0);
+                etot = evaluate(true);
+                trial_step *= 0.25;
+                set_steepest_descent();
+                gpg_old = wdot(&kpd_t::grad, &kpd_t::pgrad);
+                if (++num_failed > 5) {
+                    ctx_.message(1, __func__, std::stringstream("line search failed"));
+                    break;
+                }
+                continue;
+            }
+        }
+        num_failed = 0;
+        trial_step = t;
+
+        bool restart = (cfg.restart() > 0 && (iter + 1) % cfg.restart() == 0);
+
+        /* change of the free energy after the update of the occupation numbers */
+        double de_occ{0};
+        bool occ_updated{false};
+        if (ensemble && (++num_inner == cfg.num_inner_steps() ||
+                         (std::abs(etot - e0) < energy_tol__ && residual() < cfg.residual_tol()))) {
+            double e_fixed_occ = etot;
+            update_occupancies();
+            etot        = evaluate(true);
+            de_occ      = etot - e_fixed_occ;
+            occ_updated = true;
+            num_inner   = 0;
+            /* the energy surface has changed; start again from the steepest descent */
+            restart = true;
+        }
+
+        double gpg = wdot(&kpd_t::grad, &kpd_t::pgrad);
+        double beta{0};
+        if (!restart) {
+            /* Polak-Ribiere formula with the automatic restart */
+            beta = std::max(0.0, (gpg - wdot(&kpd_t::grad, &kpd_t::pgrad_old)) / gpg_old);
+        }
+        gpg_old = gpg;
+
+        /* dir <- -pgrad + beta * dir, projected to the tangent space at the new point */
+        for_each_block([&](K_point<T>& kp, kpd_t& d, int ispn_step, wf::spin_range sr, wf::band_range br)
+        {
+            axpby(static_cast<F>(-1.0), *d.pgrad, static_cast<F>(beta), *d.dir, sr, br);
+            project(kp, d, *d.dir, sr, br);
+        });
+
+        double res = residual();
+
+        etot_hist.push_back(etot);
+        res_hist.push_back(res);
+
+        std::stringstream out;
+        out << "iteration : " << iter << ", energy : " << std::setprecision(12) << std::scientific << etot
+            << ", energy difference : " << etot - e0 << ", residual : " << res << ", step : " << t;
+        if (occ_updated) {
+            out << ", occupation update : " << de_occ;
+        }
+        ctx_.message(1, __func__, out);
+
+        /* in the ensemble case the occupation numbers must be converged as well */
+        bool occ_converged = !ensemble || (occ_updated && std::abs(de_occ) < energy_tol__);
+
+        if (std::abs(etot - e0) < energy_tol__ && res < cfg.residual_tol() && occ_converged) {
+            std::stringstream out;
+            out << std::endl;
+            out << "converged after " << iter + 1 << " iterations!";
+            ctx_.message(1, __func__, out);
+            num_iter = iter;
+            break;
+        }
+    }
+
+    if (!ensemble) {
+        /* eigen-states of the occupied subspace; density is not changed by this rotation */
+        subspace_rotation();
+    }
+    /* psi may have been rotated after the last density generation; drop its real-space copies */
+    for (int ikloc = 0; ikloc < nk; ikloc++) {
+        kset_.get<T>(kset_.spl_num_kpoints(ikloc))->psi_rg_cache().clear();
+    }
+
+    std::stringstream out;
+    out << std::endl;
+    print_info(out);
+    ctx_.message(1, __func__, out);
+
+    if (write_state__) {
+        ctx_.create_storage_file();
+        potential_.save();
+        density_.save();
+    }
+
+    auto tstop = std::chrono::high_resolution_clock::now();
+
+    auto dict = serialize();
+
+    dict["scf_time"]     = std::chrono::duration_cast<std::chrono::duration<double>>(tstop - tstart).count();
+    dict["etot_history"] = etot_hist;
+    if (num_iter >= 0) {
+        dict["converged"]          = true;
+        dict["num_scf_iterations"] = num_iter;
+        dict["residual_history"]   = res_hist;
+    } else {
+        dict["converged"] = false;
+    }
+
+    return dict;
+}
+
+template json
+DFT_ground_state::direct_minimization<double>(double energy_tol__, int num_steps__, bool write_state__);
+
+template json
+DFT_ground_state::direct_minimization<std::complex<double>>(double energy_tol__, int num_steps__, bool write_state__);
+
+} // namespace sirius
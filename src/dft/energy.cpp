@@ -22,6 +22,7 @@
  *  \brief Total energy terms.
  */
 
+#include <array>
 #include "energy.hpp"
 
 namespace sirius {
@@ -72,6 +73,91 @@ ewald_energy(const Simulation_context& ctx, const fft::Gvec& gvec, const Unit_ce
     return (ewald_g + ewald_r);
 }
 
+energy_integrals_t
+energy_integrals(Density const& density, Potential const& potential)
+{
+    PROFILE("sirius::energy_integrals");
+
+    auto& ctx        = density.ctx();
+    auto& unit_cell  = ctx.unit_cell();
+    int num_mag_dims = ctx.num_mag_dims();
+
+    auto& rho  = density.rho().rg();
+    auto& veff = potential.effective_potential().rg();
+    auto& vxc  = potential.xc_potential().rg();
+    auto& exc  = potential.xc_energy_density().rg();
+
+    std::vector<Smooth_periodic_function<double> const*> mag;
+    std::vector<Smooth_periodic_function<double> const*> bxc;
+    for (int j = 0; j < num_mag_dims; j++) {
+        mag.push_back(&density.mag(j).rg());
+        bxc.push_back(&potential.effective_magnetic_field(j).rg());
+    }
+
+    /* local contributions to veff, vxc, exc, bxc, vloc and enuc */
+    std::array<double, 6> e;
+    e.fill(0);
+
+    /* regular grid part */
+    int nrloc = rho.spfft().local_slice_size();
+    if (ctx.full_potential()) {
+        for (int ir = 0; ir < nrloc; ir++) {
+            double t = ctx.theta(ir);
+            double r = rho.value(ir) * t;
+            e[0] += r * veff.value(ir);
+            e[1] += r * vxc.value(ir);
+            e[2] += r * exc.value(ir);
+            for (int j = 0; j < num_mag_dims; j++) {
+                e[3] += mag[j]->value(ir) * bxc[j]->value(ir) * t;
+            }
+        }
+    } else {
+        auto& rho_core = density.rho_pseudo_core();
+        auto& vloc     = potential.local_potential();
+        for (int ir = 0; ir < nrloc; ir++) {
+            double r = rho.value(ir);
+            e[0] += r * veff.value(ir);
+            e[1] += r * vxc.value(ir);
+            e[2] += (r + rho_core.value(ir)) * exc.value(ir);
+            for (int j = 0; j < num_mag_dims; j++) {
+                e[3] += mag[j]->value(ir) * bxc[j]->value(ir);
+            }
+            e[4] += vloc.value(ir) * r;
+        }
+    }
+    for (int i = 0; i < 5; i++) {
+        e[i] *= (rho.gvec().omega() / fft::spfft_grid_size(rho.spfft()));
+    }
+
+    /* muffin-tin part */
+    if (ctx.full_potential()) {
+        for (int ialoc = 0; ialoc < unit_cell.spl_num_atoms().local_size(); ialoc++) {
+            int ia = unit_cell.spl_num_atoms(ialoc);
+            auto& rho_mt = density.rho().mt()[ia];
+            e[0] += inner(rho_mt, potential.effective_potential().mt()[ia]);
+            e[1] += inner(rho_mt, potential.xc_potential().mt()[ia]);
+            e[2] += inner(rho_mt, potential.xc_energy_density().mt()[ia]);
+            for (int j = 0; j < num_mag_dims; j++) {
+                e[3] += inner(density.mag(j).mt()[ia], potential.effective_magnetic_field(j).mt()[ia]);
+            }
+            e[5] -= 0.5 * unit_cell.atom(ia).zn() * potential.vh_el(ia);
+        }
+    }
+
+    ctx.comm().allreduce(e.data(), e.size());
+
+    energy_integrals_t result;
+    result.veff = e[0];
+    result.vxc  = e[1];
+    result.exc  = (1 + potential.add_delta_rho_xc()) * e[2];
+    result.bxc  = e[3];
+    result.vha  = potential.energy_vha();
+    result.vloc = e[4];
+    result.enuc = e[5];
+
+    return result;
+}
+
 double
 energy_vxc(Density const& density, Potential const& potential)
 {
@@ -147,26 +233,38 @@ energy_veff(Density const& density, Potential const& potential)
 double
 energy_kin(Simulation_context const& ctx, K_point_set const& kset, Density const& density, Potential const& potential)
 {
-    return eval_sum(ctx.unit_cell(), kset) - energy_veff(density, potential) - energy_bxc(density, potential);
+    return energy_kin(ctx, kset, energy_integrals(density, potential));
+}
+
+double
+energy_kin(Simulation_context const& ctx, K_point_set const& kset, energy_integrals_t const& e)
+{
+    return eval_sum(ctx.unit_cell(), kset) - e.veff - e.bxc;
 }
 
 double
 total_energy(Simulation_context const& ctx, K_point_set const& kset, Density const& density, Potential const& potential,
              double ewald_energy)
+{
+    return total_energy(ctx, kset, density, potential, ewald_energy, energy_integrals(density, potential));
+}
+
+double
+total_energy(Simulation_context const& ctx, K_point_set const& kset, Density const& density, Potential const& potential,
+             double ewald_energy, energy_integrals_t const& e)
 {
     double tot_en{0};
 
     switch (ctx.electronic_structure_method()) {
         case electronic_structure_method_t::full_potential_lapwlo: {
-            tot_en = (energy_kin(ctx, kset, density, potential) + energy_exc(density, potential) +
-                      0.5 * energy_vha(potential) + energy_enuc(ctx, potential));
+            tot_en = (energy_kin(ctx, kset, e) + e.exc + 0.5 * e.vha + e.enuc);
             break;
         }
 
         case electronic_structure_method_t::pseudopotential: {
-            tot_en = (kset.valence_eval_sum() - energy_vxc(density, potential) - energy_bxc(density, potential) -
-                      potential.PAW_one_elec_energy(density) - one_electron_energy_hubbard(density, potential)) -
-                     0.5 * energy_vha(potential) + energy_exc(density, potential) + potential.PAW_total_energy(density) +
+            tot_en = (kset.valence_eval_sum() - e.vxc - e.bxc - potential.PAW_one_elec_energy(density) -
+                      one_electron_energy_hubbard(density, potential)) -
+                     0.5 * e.vha + e.exc + potential.PAW_total_energy(density) +
                      ewald_energy + kset.entropy_sum() + ::sirius::hubbard_energy(density);
             break;
         }
@@ -188,8 +286,9 @@ hubbard_energy(Density const& density)
 double
 one_electron_energy(Density const& density, Potential const& potential)
 {
-    return energy_vha(potential) + energy_vxc(density, potential) + energy_bxc(density, potential) +
-           potential.PAW_one_elec_energy(density) + one_electron_energy_hubbard(density, potential);
+    auto e = energy_integrals(density, potential);
+    return e.vha + e.vxc + e.bxc + potential.PAW_one_elec_energy(density) +
+           one_electron_energy_hubbard(density, potential);
 }
 
 double
@@ -205,8 +304,8 @@ one_electron_energy_hubbard(Density const& density, Potential const& potential)
 double
 energy_potential(Density const& density, Potential const& potential)
 {
-    const double e = energy_veff(density, potential) + energy_bxc(density, potential) +
-                     potential.PAW_one_elec_energy(density) + ::sirius::hubbard_energy(density);
+    auto ei = energy_integrals(density, potential);
+    const double e = ei.veff + ei.bxc + potential.PAW_one_elec_energy(density) + ::sirius::hubbard_energy(density);
     return e;
 }
 
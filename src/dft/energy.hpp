@@ -112,6 +112,30 @@ namespace sirius {
  */
 double ewald_energy(const Simulation_context& ctx, const fft::Gvec& gvec, const Unit_cell& unit_cell);
 
+/// Integrals of the density and magnetization with the potential components that enter the total energy.
+struct energy_integrals_t
+{
+    /// Integral of \f$ \rho({\bf r}) V^{eff}({\bf r}) \f$.
+    double veff{0};
+    /// Integral of \f$ \rho({\bf r}) V^{XC}({\bf r}) \f$.
+    double vxc{0};
+    /// Exchange-correlation energy.
+    double exc{0};
+    /// Integral of \f$ {\bf m}({\bf r}) {\bf B}^{XC}({\bf r}) \f$.
+    double bxc{0};
+    /// Integral of \f$ \rho({\bf r}) V^{H}({\bf r}) \f$.
+    double vha{0};
+    /// Integral of \f$ \rho({\bf r}) V^{loc}({\bf r}) \f$ (pseudopotential only).
+    double vloc{0};
+    /// Energy of nuclei in the electrostatic field (full-potential only).
+    double enuc{0};
+};
+
+/// Compute all integrals that enter the total energy.
+/** The integrals are computed in a single pass over the local part of the regular grid and over the local
+ *  muffin-tin spheres, followed by a single reduction. The result is identical on all ranks. */
+energy_integrals_t energy_integrals(Density const& density, Potential const& potential);
+
 /// Returns exchange correlation potential.
 double energy_vxc(Density const& density, Potential const& potential);
 
@@ -148,6 +172,9 @@ double energy_veff(Density const& density, Potential const& potential);
 double energy_kin(Simulation_context const& ctx, K_point_set const& kset, Density const& density,
                   Potential const& potential);
 
+/// Return kinetic energy using the precomputed energy integrals.
+double energy_kin(Simulation_context const& ctx, K_point_set const& kset, energy_integrals_t const& e);
+
 double energy_potential(Density const& density, Potential const& potential);
 
 /// Total energy of the electronic subsystem.
@@ -252,6 +279,10 @@ double energy_potential(Density const& density, Potential const& potential);
 double total_energy(Simulation_context const& ctx, K_point_set const& kset, Density const& density,
                     Potential const& potential, double ewald_energy);
 
+/// Total energy of the electronic subsystem using the precomputed energy integrals.
+double total_energy(Simulation_context const& ctx, K_point_set const& kset, Density const& density,
+                    Potential const& potential, double ewald_energy, energy_integrals_t const& e);
+
 double one_electron_energy(Density const& density, Potential const& potential);
 
 double one_electron_energy_hubbard(Density const& density, Potential const& potential);
@@ -265,14 +296,17 @@ energy_dict(Simulation_context const& ctx__, K_point_set const& kset__, Density
 
     dict["energy"] =  nlohmann::json::object();
 
-    dict["energy"]["total"]          = total_energy(ctx__, kset__, density__, potential__, ewald_energy__) + scf_correction__;
-    dict["energy"]["vha"]            = energy_vha(potential__);
-    dict["energy"]["vxc"]            = energy_vxc(density__, potential__);
-    dict["energy"]["exc"]            = energy_exc(density__, potential__);
-    dict["energy"]["bxc"]            = energy_bxc(density__, potential__);
-    dict["energy"]["veff"]           = energy_veff(density__, potential__);
+    auto e = energy_integrals(density__, potential__);
+
+    dict["energy"]["total"]          = total_energy(ctx__, kset__, density__, potential__, ewald_energy__, e) +
+                                       scf_correction__;
+    dict["energy"]["vha"]            = e.vha;
+    dict["energy"]["vxc"]            = e.vxc;
+    dict["energy"]["exc"]            = e.exc;
+    dict["energy"]["bxc"]            = e.bxc;
+    dict["energy"]["veff"]           = e.veff;
     dict["energy"]["eval_sum"]       = eval_sum(ctx__.unit_cell(), kset__);
-    dict["energy"]["kin"]            = energy_kin(ctx__, kset__, density__, potential__);
+    dict["energy"]["kin"]            = energy_kin(ctx__, kset__, e);
     dict["energy"]["ewald"]          = ewald_energy__;
     dict["energy"]["scf_correction"] = scf_correction__;
     dict["energy"]["entropy_sum"]    = kset__.entropy_sum();
@@ -280,10 +314,10 @@ energy_dict(Simulation_context const& ctx__, K_point_set const& kset__, Density
     dict["band_gap"]                 = kset__.band_gap();
     if (ctx__.full_potential()) {
         dict["energy"]["core_eval_sum"] = core_eval_sum(ctx__.unit_cell());
-        dict["energy"]["enuc"]          = energy_enuc(ctx__, potential__);
+        dict["energy"]["enuc"]          = e.enuc;
         dict["core_leakage"]            = density__.core_leakage();
     } else {
-        dict["energy"]["vloc"] = energy_vloc(density__, potential__);
+        dict["energy"]["vloc"] = e.vloc;
     }
 
     return dict;
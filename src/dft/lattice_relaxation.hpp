@@ -25,6 +25,8 @@
 #ifndef __LATTICE_RELAXATION_HPP__
 #define __LATTICE_RELAXATION_HPP__
 
+#include <array>
+#include <limits>
 #include "dft_ground_state.hpp"
 #if defined(SIRIUS_VCSQNM)
 #include "vcsqnm/periodic_optimizer.hpp"
@@ -36,6 +38,77 @@ class Lattice_relaxation
 {
   private:
     DFT_ground_state& dft_;
+
+#if defined(SIRIUS_VCSQNM)
+    /// Exponential preconditioner for the atomic and, optionally, lattice degrees of freedom.
+    /** Force-field Hessian model of Packwood et al., J. Chem. Phys. 144, 164109 (2016). For each pair of atoms
+     *  closer than \f$ r_{cut} \f$ (taken from the nearest neighbour list of the unit cell):
+     *  \f[
+     *    P_{ij} = -\mu e^{-A (r_{ij} / r_{nn} - 1)}, \quad P_{ii} = -\sum_{j \ne i} P_{ij} + \mu c_{stab}
+     *  \f]
+     *  where \f$ r_{nn} \f$ is the shortest interatomic distance. The matrix is applied to each Cartesian
+     *  component. The lattice block of the vc-sqnm coordinates is a diagonal with the average atomic diagonal
+     *  element, since the lattice coordinates are already scaled to match the atomic ones.
+     *
+     *  The sorted list of bonds is returned in bonds__ to detect changes of the topology. */
+    Eigen::MatrixXd exp_preconditioner(bool lattice__, std::vector<std::array<int, 5>>& bonds__) const
+    {
+        auto& uc  = dft_.ctx().unit_cell();
+        auto& inp = dft_.ctx().cfg().vcsqnm();
+
+        int na = uc.num_atoms();
+
+        double r_nn = std::numeric_limits<double>::max();
+        for (int ia = 0; ia < na; ia++) {
+            for (int i = 0; i < uc.num_nearest_neighbours(ia); i++) {
+                /* neighbours are sorted by distance; skip the atom itself */
+                if (uc.nearest_neighbour(i, ia).distance > 1e-8) {
+                    r_nn = std::min(r_nn, uc.nearest_neighbour(i, ia).distance);
+                    break;
+                }
+            }
+        }
+        if (r_nn == std::numeric_limits<double>::max()) {
+            RTE_THROW("nearest neighbour list is empty");
+        }
+        double mu    = inp.precond_mu();
+        double A     = inp.precond_A();
+        double r_cut = inp.precond_r_cut() * r_nn;
+
+        int ndim = 3 * na + (lattice__ ? 9 : 0);
+        Eigen::MatrixXd P = Eigen::MatrixXd::Zero(ndim, ndim);
+
+        bonds__.clear();
+        for (int ia = 0; ia < na; ia++) {
+            for (int i = 0; i < uc.num_nearest_neighbours(ia); i++) {
+                auto& nn = uc.nearest_neighbour(i, ia);
+                if (nn.distance < 1e-8 || nn.distance > r_cut) {
+                    continue;
+                }
+                int ja   = nn.atom_id;
+                double c = mu * std::exp(-A * (nn.distance / r_nn - 1));
+                for (int x : {0, 1, 2}) {
+                    P(3 * ia + x, 3 * ja + x) -= c;
+                    P(3 * ia + x, 3 * ia + x) += c;
+                }
+                bonds__.push_back({ia, ja, nn.translation[0], nn.translation[1], nn.translation[2]});
+            }
+        }
+        std::sort(bonds__.begin(), bonds__.end());
+
+        for (int i = 0; i < 3 * na; i++) {
+            P(i, i) += mu * inp.precond_c_stab();
+        }
+        if (lattice__) {
+            double d = P.diagonal().head(3 * na).mean();
+            for (int i = 3 * na; i < ndim; i++) {
+                P(i, i) = d;
+            }
+        }
+        return P;
+    }
+#endif
+
   public:
     Lattice_relaxation(DFT_ground_state& dft__)
       : dft_{dft__}
@@ -90,6 +163,25 @@ class Lattice_relaxation
                     eps_subsp);
         }
 
+        /* preconditioner and the bond topology it was built for */
+        bool use_precond = (inp.preconditioner() == "exp") && geom_opt;
+        std::vector<std::array<int, 5>> bonds;
+        if (use_precond) {
+            geom_opt->set_preconditioner(exp_preconditioner(compute_stress, bonds));
+        }
+
+        /* in the adaptive mode the SCF tolerances of each step are loosened by a factor that follows the
+         * residual forces and stress; the first step starts with the loosest tolerances */
+        bool adaptive_scf_tol = inp.adaptive_scf_tol();
+        double scf_tol_scale = inp.scf_tol_scale();
+        double scf_tol_max_factor = std::max(inp.scf_tol_max_factor(), 1.0);
+        double scf_tol_factor = adaptive_scf_tol ? scf_tol_max_factor : 1.0;
+        /* extrapolate the density to the new geometry only in the pseudopotential case */
+        bool extrapolate_density = adaptive_scf_tol && !dft_.ctx().full_potential();
+
+        int num_scf_iter_total{0};
+        auto steps = nlohmann::json::array();
+
         bool stress_converged{true};
         bool forces_converged{true};
 
@@ -99,11 +191,29 @@ class Lattice_relaxation
             auto& inp = dft_.ctx().cfg().parameters();
             bool write_state{false};
 
+            double density_tol = inp.density_tol() * scf_tol_factor;
+            double energy_tol  = inp.energy_tol() * scf_tol_factor;
+
             /* launch the calculation */
-            result = dft_.find(inp.density_tol(), inp.energy_tol(), dft_.ctx().cfg().iterative_solver().energy_tolerance(),
+            result = dft_.find(density_tol, energy_tol, dft_.ctx().cfg().iterative_solver().energy_tolerance(),
                 inp.num_dft_iter(), write_state);
 
+            int num_scf_iter = static_cast<int>(result["etot_history"].size());
+            num_scf_iter_total += num_scf_iter;
+
             rte::ostream out(dft_.ctx().out(), __func__);
+            if (adaptive_scf_tol) {
+                out << "SCF tolerances of this step: density_tol: " << density_tol << ", energy_tol: " << energy_tol
+                    << ", SCF iterations: " << num_scf_iter << std::endl;
+            }
+
+            nlohmann::json step;
+            step["density_tol"]        = density_tol;
+            step["energy_tol"]         = energy_tol;
+            step["num_scf_iterations"] = num_scf_iter;
+
+            /* ratio between the residual and the threshold for forces and stress */
+            double res_ratio{0};
 
             if (compute_stress) {
                 dft_.stress().calc_stress_total();
@@ -125,6 +235,9 @@ class Lattice_relaxation
 
                 out << "total stress value: " << d << ", stress threshold: " << stress_thr__
                     << ", converged: " << stress_converged << std::endl;
+
+                res_ratio = std::max(res_ratio, d / stress_thr__);
+                step["stress"] = d;
             }
 
             if (compute_forces) {
@@ -146,14 +259,35 @@ class Lattice_relaxation
                 }
                 out << "total forces value: " << d << ", forces threshold: " << forces_thr__
                     << ", converged: " << forces_converged << std::endl;
+
+                res_ratio = std::max(res_ratio, d / forces_thr__);
+                step["forces"] = d;
             }
+            steps.push_back(step);
+
             auto etot = result["energy"]["total"].get<double>();
 
             if (forces_converged && stress_converged) {
+                if (scf_tol_factor > 1) {
+                    /* forces and stress of the final geometry must come from the fully converged SCF */
+                    out << "converged with loose SCF tolerances; repeating SCF with the target tolerances" << std::endl;
+                    scf_tol_factor = 1;
+                    continue;
+                }
                 out << "lattice relaxation is converged in " << istep << " steps" << std::endl;
                 break;
             }
 
+            if (adaptive_scf_tol) {
+                scf_tol_factor = std::min(std::max(scf_tol_scale * res_ratio, 1.0), scf_tol_max_factor);
+            }
+
+            /* superposition of atomic densities for the current geometry */
+            std::vector<std::complex<double>> rho_at_old;
+            if (extrapolate_density) {
+                rho_at_old = dft_.density().atomic_density_pw();
+            }
+
             /*
              * compute new geometry 
              */
@@ -173,11 +307,32 @@ class Lattice_relaxation
                 ctx.unit_cell().atom(ia).set_position({r(0, ia), r(1, ia), r(2, ia)});
             }
             dft_.update();
+            if (use_precond) {
+                /* rebuild the preconditioner if the topology has changed; this also resets the history */
+                std::vector<std::array<int, 5>> new_bonds;
+                auto P = exp_preconditioner(compute_stress, new_bonds);
+                if (new_bonds != bonds) {
+                    out << "bond topology has changed; preconditioner is rebuilt" << std::endl;
+                    geom_opt->set_preconditioner(P);
+                    bonds = new_bonds;
+                }
+            }
+            if (extrapolate_density) {
+                dft_.density().extrapolate_density(rho_at_old);
+                dft_.potential().generate(dft_.density(), ctx.use_symmetry(), true);
+            }
             ctx.unit_cell().print_geometry_info(out, ctx.verbosity());
         }
         if (!(forces_converged && stress_converged)) {
             RTE_OUT(dft_.ctx().out()) << "lattice relaxation not converged" << std::endl;
         }
+        RTE_OUT(dft_.ctx().out()) << "total number of SCF iterations: " << num_scf_iter_total << std::endl;
+
+        result["relaxation"]["converged"]                = forces_converged && stress_converged;
+        result["relaxation"]["num_steps"]                = static_cast<int>(steps.size());
+        result["relaxation"]["num_scf_iterations_total"] = num_scf_iter_total;
+        result["relaxation"]["adaptive_scf_tol"]         = adaptive_scf_tol;
+        result["relaxation"]["steps"]                    = steps;
 #else
         RTE_THROW("not compiled with vcsqnm support");
 #endif
@@ -0,0 +1,271 @@
+// Copyright (c) 2013-2023 Anton Kozhevnikov, Thomas Schulthess
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+// the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+//    following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+//    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** \file molecular_dynamics.hpp
+ *
+ *  \brief Born-Oppenheimer molecular dynamics.
+ */
+
+#ifndef __MOLECULAR_DYNAMICS_HPP__
+#define __MOLECULAR_DYNAMICS_HPP__
+
+#include <deque>
+#include <map>
+#include <tuple>
+#include "dft_ground_state.hpp"
+
+namespace sirius {
+
+/// Born-Oppenheimer molecular dynamics with the optional extended Lagrangian propagation of the density.
+/** The nuclei are propagated with the velocity Verlet integrator. In the extended Lagrangian mode
+ *  (Niklasson et al., J. Chem. Phys. 130, 214109 (2009)) the auxiliary density is propagated as
+ *  \f[
+ *    n_{k+1} = 2 n_k - n_{k-1} + \kappa (\rho[n_k] - n_k) + \alpha \sum_{m=0}^{K} c_m n_{k-m}
+ *  \f]
+ *  where \f$ \rho[n_k] \f$ is the density after a few SCF iterations started from \f$ n_k \f$. The mixer
+ *  of the SCF loop plays the role of the kernel that approximates the inverse dielectric response.
+ *  Only the plane-wave part of the density is propagated; this is implemented for the pseudopotential case.
+ */
+class Molecular_dynamics
+{
+  private:
+    DFT_ground_state& dft_;
+
+    /// Plane-wave coefficients of all density components.
+    using density_pw_t = std::vector<std::vector<std::complex<double>>>;
+
+    density_pw_t get_density() const
+    {
+        auto& ctx = dft_.ctx();
+        density_pw_t rho(ctx.num_mag_dims() + 1, std::vector<std::complex<double>>(ctx.gvec().count()));
+        for (int j = 0; j < ctx.num_mag_dims() + 1; j++) {
+            for (int igloc = 0; igloc < ctx.gvec().count(); igloc++) {
+                rho[j][igloc] = dft_.density().component(j).rg().f_pw_local(igloc);
+            }
+        }
+        return rho;
+    }
+
+    void set_density(density_pw_t const& rho__)
+    {
+        auto& ctx = dft_.ctx();
+        for (int j = 0; j < ctx.num_mag_dims() + 1; j++) {
+            auto& f = dft_.density().component(j).rg();
+            for (int igloc = 0; igloc < ctx.gvec().count(); igloc++) {
+                f.f_pw_local(igloc) = rho__[j][igloc];
+            }
+            f.fft_transform(1);
+        }
+    }
+
+    /// Cartesian coordinates of atoms.
+    sddk::mdarray<double, 2> positions() const
+    {
+        auto& uc = dft_.ctx().unit_cell();
+        sddk::mdarray<double, 2> r(3, uc.num_atoms());
+        for (int ia = 0; ia < uc.num_atoms(); ia++) {
+            auto rc = uc.get_cartesian_coordinates(uc.atom(ia).position());
+            for (int x : {0, 1, 2}) {
+                r(x, ia) = rc[x];
+            }
+        }
+        return r;
+    }
+
+  public:
+    Molecular_dynamics(DFT_ground_state& dft__)
+        : dft_{dft__}
+    {
+    }
+
+    /// Run the molecular dynamics for a given number of steps.
+    /** The initial velocities are zero. */
+    nlohmann::json run(int num_steps__)
+    {
+        PROFILE("sirius::Molecular_dynamics::run");
+
+        auto& ctx = const_cast<Simulation_context&>(dft_.ctx());
+        auto& uc  = ctx.unit_cell();
+        auto& inp = ctx.cfg().parameters();
+        auto& md  = ctx.cfg().md();
+
+        bool xlbomd = md.xlbomd();
+        if (xlbomd && ctx.full_potential()) {
+            RTE_THROW("extended Lagrangian molecular dynamics is implemented only for the pseudopotential case");
+        }
+
+        /* coefficients of the dissipative integrator for K = 3 ... 7 */
+        static const std::map<int, std::tuple<double, double, std::vector<double>>> xl_coeffs = {
+            {3, std::make_tuple(1.69, 0.150,  std::vector<double>({-2, 3, 0, -1}))},
+            {4, std::make_tuple(1.75, 0.057,  std::vector<double>({-3, 6, -2, -2, 1}))},
+            {5, std::make_tuple(1.82, 0.018,  std::vector<double>({-6, 14, -8, -3, 4, -1}))},
+            {6, std::make_tuple(1.84, 0.0055, std::vector<double>({-14, 36, -27, -2, 12, -6, 1}))},
+            {7, std::make_tuple(1.86, 0.0016, std::vector<double>({-36, 99, -88, 11, 32, -25, 8, -1}))}};
+
+        if (!xl_coeffs.count(md.xlbomd_K())) {
+            RTE_THROW("wrong number of previous densities in the dissipation term");
+        }
+        double kappa = std::get<0>(xl_coeffs.at(md.xlbomd_K()));
+        double alpha = std::get<1>(xl_coeffs.at(md.xlbomd_K()));
+        auto& c      = std::get<2>(xl_coeffs.at(md.xlbomd_K()));
+
+        double dt = md.dt();
+        int na    = uc.num_atoms();
+
+        std::vector<double> mass(na);
+        for (int ia = 0; ia < na; ia++) {
+            mass[ia] = uc.atom(ia).type().mass() * amu2me;
+            if (mass[ia] <= 0) {
+                RTE_THROW("atomic mass of " + uc.atom(ia).type().label() + " is not set");
+            }
+        }
+
+        auto r = positions();
+        sddk::mdarray<double, 2> v(3, na);
+        v.zero();
+        sddk::mdarray<double, 2> f(3, na);
+
+        auto get_forces = [&]()
+        {
+            auto& ft = dft_.forces().calc_forces_total();
+            for (int ia = 0; ia < na; ia++) {
+                for (int x : {0, 1, 2}) {
+                    f(x, ia) = ft(x, ia);
+                }
+            }
+        };
+
+        auto kinetic_energy = [&]()
+        {
+            double ekin{0};
+            for (int ia = 0; ia < na; ia++) {
+                for (int x : {0, 1, 2}) {
+                    ekin += 0.5 * mass[ia] * v(x, ia) * v(x, ia);
+                }
+            }
+            return ekin;
+        };
+
+        /* fully converged ground state of the initial geometry */
+        auto result = dft_.find(inp.density_tol(), inp.energy_tol(),
+                ctx.cfg().iterative_solver().energy_tolerance(), inp.num_dft_iter(), false);
+        get_forces();
+
+        double etot0 = result["energy"]["total"].get<double>();
+
+        /* history of the auxiliary densities n_k, n_{k-1}, ..., n_{k-K} and the SCF density rho[n_k] */
+        std::deque<density_pw_t> n_hist;
+        density_pw_t rho_scf;
+        if (xlbomd) {
+            rho_scf = get_density();
+            n_hist  = std::deque<density_pw_t>(c.size(), rho_scf);
+        }
+
+        rte::ostream out(ctx.out(), __func__);
+
+        auto steps = nlohmann::json::array();
+        int num_scf_iter_total{0};
+        double max_drift{0};
+
+        for (int istep = 0; istep < num_steps__; istep++) {
+            /* first half of the velocity Verlet step and the update of positions */
+            for (int ia = 0; ia < na; ia++) {
+                for (int x : {0, 1, 2}) {
+                    v(x, ia) += 0.5 * dt * f(x, ia) / mass[ia];
+                    r(x, ia) += dt * v(x, ia);
+                }
+                uc.atom(ia).set_position(uc.get_fractional_coordinates({r(0, ia), r(1, ia), r(2, ia)}));
+            }
+            dft_.update();
+
+            int num_dft_iter = inp.num_dft_iter();
+            if (xlbomd) {
+                auto& n0 = n_hist[0];
+                auto& n1 = n_hist[1];
+                density_pw_t n_new(n0.size(), std::vector<std::complex<double>>(n0[0].size()));
+                for (size_t j = 0; j < n0.size(); j++) {
+                    #pragma omp parallel for schedule(static)
+                    for (size_t ig = 0; ig < n0[j].size(); ig++) {
+                        auto z = 2.0 * n0[j][ig] - n1[j][ig] + kappa * (rho_scf[j][ig] - n0[j][ig]);
+                        for (size_t m = 0; m < c.size(); m++) {
+                            z += alpha * c[m] * n_hist[m][j][ig];
+                        }
+                        n_new[j][ig] = z;
+                    }
+                }
+                n_hist.pop_back();
+                n_hist.push_front(std::move(n_new));
+
+                set_density(n_hist[0]);
+                dft_.potential().generate(dft_.density(), ctx.use_symmetry(), true);
+                num_dft_iter = md.num_scf_steps();
+            }
+            /* in the conventional mode the SCF starts from the density and wave-functions of the previous step */
+            result = dft_.find(inp.density_tol(), inp.energy_tol(), ctx.cfg().iterative_solver().energy_tolerance(),
+                    num_dft_iter, false);
+            if (xlbomd) {
+                rho_scf = get_density();
+            }
+            get_forces();
+
+            /* second half of the velocity Verlet step */
+            for (int ia = 0; ia < na; ia++) {
+                for (int x : {0, 1, 2}) {
+                    v(x, ia) += 0.5 * dt * f(x, ia) / mass[ia];
+                }
+            }
+
+            int num_scf_iter = static_cast<int>(result["etot_history"].size());
+            num_scf_iter_total += num_scf_iter;
+
+            double etot  = result["energy"]["total"].get<double>();
+            double ekin  = kinetic_energy();
+            double drift = etot + ekin - etot0;
+            max_drift    = std::max(max_drift, std::abs(drift));
+
+            out << "MD step " << istep + 1 << " out of " << num_steps__ << ", time: " << (istep + 1) * dt * au2fs
+                << " fs, potential energy: " << etot << ", kinetic energy: " << ekin << ", energy drift: " << drift
+                << ", SCF iterations: " << num_scf_iter << std::endl;
+
+            nlohmann::json step;
+            step["time"]               = (istep + 1) * dt;
+            step["potential_energy"]   = etot;
+            step["kinetic_energy"]     = ekin;
+            step["energy_drift"]       = drift;
+            step["num_scf_iterations"] = num_scf_iter;
+            steps.push_back(step);
+        }
+
+        RTE_OUT(ctx.out()) << "maximum energy drift: " << max_drift << ", average number of SCF iterations per step: "
+                           << static_cast<double>(num_scf_iter_total) / std::max(num_steps__, 1) << std::endl;
+
+        result["md"]["xlbomd"]                   = xlbomd;
+        result["md"]["dt"]                       = dt;
+        result["md"]["num_steps"]                = num_steps__;
+        result["md"]["num_scf_iterations_total"] = num_scf_iter_total;
+        result["md"]["max_energy_drift"]         = max_drift;
+        result["md"]["steps"]                    = steps;
+
+        return result;
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,225 @@
+// Copyright (c) 2013-2023 Anton Kozhevnikov, Thomas Schulthess
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+// the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+//    following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+//    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** \file multi_image.hpp
+ *
+ *  \brief Concurrent ground state calculations of a chain of images.
+ */
+
+#ifndef __MULTI_IMAGE_HPP__
+#define __MULTI_IMAGE_HPP__
+
+#include <array>
+#include "dft_ground_state.hpp"
+
+namespace sirius {
+
+/// Energies and forces of a chain of images (nudged elastic band, string method).
+/** The images differ only by the atomic positions. The world communicator is split into groups and each group
+ *  computes a contiguous block of images. A group keeps one simulation context for all its images: species,
+ *  radial integral tables, G-vectors and FFT are set up once and reused through Simulation_context::update().
+ *
+ *  With the warm start each image is started from the converged density (extrapolated with the superposition of
+ *  atomic densities) and wave-functions of the same image from the previous call or, in the first call, of the
+ *  previous image of the block. The warm start is implemented only for the pseudopotential case.
+ */
+class Multi_image
+{
+  private:
+    /// Communicator of all images.
+    mpi::Communicator comm_;
+
+    /// Communicator of the group of images.
+    mpi::Communicator comm_group_;
+
+    /// Index of the group.
+    int group_{0};
+
+    /// Number of groups.
+    int num_groups_{1};
+
+    std::unique_ptr<Simulation_context> ctx_;
+
+    std::unique_ptr<K_point_set> kset_;
+
+    std::unique_ptr<DFT_ground_state> dft_;
+
+    /// Stored state of an image of this group.
+    struct image_state_t
+    {
+        /// Plane-wave coefficients of the charge density.
+        std::vector<std::complex<double>> rho;
+        /// Superposition of atomic densities at the positions of the stored density.
+        std::vector<std::complex<double>> rho_at;
+    };
+
+    /// Stored states of the images of this group from the previous call.
+    std::map<int, image_state_t> image_state_;
+
+    void store_image_state(int i__)
+    {
+        auto& rho = dft_->density().rho().rg();
+        image_state_t s;
+        s.rho = std::vector<std::complex<double>>(rho.f_pw_local().at(sddk::memory_t::host),
+                                                  rho.f_pw_local().at(sddk::memory_t::host) + ctx_->gvec().count());
+        s.rho_at = dft_->density().atomic_density_pw();
+        image_state_[i__] = std::move(s);
+    }
+
+  public:
+    /// Constructor.
+    /** The images may have a lower symmetry than the first one, so the full k-mesh is always used.
+     *
+     *  \param [in] str__         JSON configuration (file name or string) of the first image.
+     *  \param [in] comm__        Communicator of all images.
+     *  \param [in] num_groups__  Number of groups of MPI ranks that compute images concurrently.
+     */
+    Multi_image(std::string const& str__, mpi::Communicator const& comm__, int num_groups__)
+        : comm_{comm__}
+    {
+        num_groups_ = std::max(1, std::min(num_groups__, comm_.size()));
+        /* contiguous blocks of ranks form the groups */
+        group_      = static_cast<int>(static_cast<long>(comm_.rank()) * num_groups_ / comm_.size());
+        comm_group_ = comm_.split(group_);
+
+        auto dict = utils::read_json_from_file_or_string(str__);
+        dict["parameters"]["use_ibz"] = false;
+
+        ctx_ = std::make_unique<Simulation_context>(dict.dump(), comm_group_);
+        ctx_->initialize();
+
+        auto& inp = ctx_->cfg().parameters();
+        kset_ = std::make_unique<K_point_set>(*ctx_, inp.ngridk(), inp.shiftk(), false);
+        dft_  = std::make_unique<DFT_ground_state>(*kset_);
+    }
+
+    /// Compute energies and forces of all images.
+    /** \param [in] positions__   Fractional atomic positions of each image.
+     *  \param [in] warm_start__  Start from the stored or the neighbouring image's density.
+     *  \return Total energies, forces and the number of SCF iterations of all images (identical on all ranks).
+     */
+    nlohmann::json find(std::vector<std::vector<std::array<double, 3>>> const& positions__, bool warm_start__)
+    {
+        PROFILE("sirius::Multi_image::find");
+
+        auto& uc  = ctx_->unit_cell();
+        auto& inp = ctx_->cfg().parameters();
+
+        int num_images = static_cast<int>(positions__.size());
+        int na         = uc.num_atoms();
+        for (auto& e : positions__) {
+            if (static_cast<int>(e.size()) != na) {
+                RTE_THROW("wrong number of atomic positions in the image");
+            }
+        }
+        warm_start__ = warm_start__ && !ctx_->full_potential();
+
+        std::vector<double> energy(num_images, 0);
+        std::vector<int> num_scf_iter(num_images, 0);
+        std::vector<int> converged(num_images, 0);
+        sddk::mdarray<double, 3> forces(3, na, num_images);
+        forces.zero();
+
+        /* block of images of this group */
+        int i0 = static_cast<int>(static_cast<long>(num_images) * group_ / num_groups_);
+        int i1 = static_cast<int>(static_cast<long>(num_images) * (group_ + 1) / num_groups_);
+
+        for (int i = i0; i < i1; i++) {
+            /* atomic density at the positions of the currently held density */
+            std::vector<std::complex<double>> rho_at_old;
+            bool from_neighbour = warm_start__ && (i > i0) && !image_state_.count(i);
+            if (from_neighbour) {
+                rho_at_old = dft_->density().atomic_density_pw();
+            }
+
+            for (int ia = 0; ia < na; ia++) {
+                uc.atom(ia).set_position({positions__[i][ia][0], positions__[i][ia][1], positions__[i][ia][2]});
+            }
+            dft_->update();
+
+            if (warm_start__ && image_state_.count(i)) {
+                /* restart from the density of the same image */
+                auto& rho = dft_->density().rho().rg();
+                auto& s   = image_state_[i];
+                for (int igloc = 0; igloc < ctx_->gvec().count(); igloc++) {
+                    rho.f_pw_local(igloc) = s.rho[igloc];
+                }
+                rho.fft_transform(1);
+                dft_->density().extrapolate_density(s.rho_at);
+                dft_->potential().generate(dft_->density(), ctx_->use_symmetry(), true);
+            } else if (from_neighbour) {
+                dft_->density().extrapolate_density(rho_at_old);
+                dft_->potential().generate(dft_->density(), ctx_->use_symmetry(), true);
+            } else {
+                dft_->initial_state();
+            }
+
+            auto result = dft_->find(inp.density_tol(), inp.energy_tol(),
+                    ctx_->cfg().iterative_solver().energy_tolerance(), inp.num_dft_iter(), false);
+            auto& f = dft_->forces().calc_forces_total();
+
+            if (warm_start__) {
+                store_image_state(i);
+            }
+
+            if (comm_group_.rank() == 0) {
+                energy[i]       = result["energy"]["total"].get<double>();
+                num_scf_iter[i] = static_cast<int>(result["etot_history"].size());
+                converged[i]    = result["converged"].get<bool>();
+                for (int ia = 0; ia < na; ia++) {
+                    for (int x : {0, 1, 2}) {
+                        forces(x, ia, i) = f(x, ia);
+                    }
+                }
+            }
+        }
+
+        comm_.allreduce(energy.data(), num_images);
+        comm_.allreduce(num_scf_iter.data(), num_images);
+        comm_.allreduce(converged.data(), num_images);
+        comm_.allreduce(forces.at(sddk::memory_t::host), forces.size());
+
+        nlohmann::json result;
+        result["num_groups"]         = num_groups_;
+        result["energy"]             = energy;
+        result["num_scf_iterations"] = num_scf_iter;
+        result["converged"]          = std::vector<bool>(converged.begin(), converged.end());
+        result["forces"]             = nlohmann::json::array();
+        for (int i = 0; i < num_images; i++) {
+            auto fi = std::vector<std::vector<double>>(na, std::vector<double>(3));
+            for (int ia = 0; ia < na; ia++) {
+                for (int x : {0, 1, 2}) {
+                    fi[ia][x] = forces(x, ia, i);
+                }
+            }
+            result["forces"].push_back(fi);
+        }
+        return result;
+    }
+
+    /// Context of the group of images of this rank.
+    inline Simulation_context& ctx()
+    {
+        return *ctx_;
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,354 @@
+// Copyright (c) 2013-2023 Anton Kozhevnikov, Thomas Schulthess
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+// the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+//    following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+//    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** \file phonons.hpp
+ *
+ *  \brief Force constants from finite atomic displacements.
+ */
+
+#ifndef __PHONONS_HPP__
+#define __PHONONS_HPP__
+
+#include "dft_ground_state.hpp"
+#include "SDDK/hdf5_tree.hpp"
+
+namespace sirius {
+
+/// Force constants of the (super)cell from the finite atomic displacements.
+/** Only the symmetry-irreducible displacements are computed: one atom from each orbit of the space group and,
+ *  for this atom, the smallest set of Cartesian directions whose images under the site symmetry span the 3D space.
+ *  A negative displacement is added only if it is not generated by the site symmetry. The displacements are
+ *  distributed between the groups of MPI ranks and computed concurrently; each group starts every displacement
+ *  from its own copy of the undistorted ground state density and wave-functions.
+ *
+ *  The force constants are defined as
+ *  \f[
+ *    \Phi_{\beta b, \alpha a} = -\frac{\partial F_{\beta b}}{\partial u_{\alpha a}}
+ *  \f]
+ *  For each irreducible atom \f$ a \f$ the block \f$ \Phi_{b, a} \f$ is found by the least square fit of
+ *  \f$ \Phi_{g(b), a} R_g {\bf u} = -R_g \Delta {\bf F}_b({\bf u}) \f$ over all displacements and all operations
+ *  \f$ g \f$ of the site symmetry. The remaining blocks are obtained from
+ *  \f$ \Phi_{g(b), g(a)} = R_g \Phi_{b, a} R_g^{T} \f$.
+ */
+class Finite_displacement_phonons
+{
+  private:
+    /// Ground state of the undistorted structure.
+    DFT_ground_state& dft_;
+
+    /// Single displacement.
+    struct displacement_t
+    {
+        /// Index of the displaced atom.
+        int ia;
+        /// Cartesian displacement vector.
+        r3::vector<double> u;
+    };
+
+    /// Index of the atom in each orbit of the symmetry group and the operation that maps the first atom to it.
+    std::vector<std::pair<int, int>> orbit_;
+
+    /// List of irreducible displacements.
+    std::vector<displacement_t> displacements_;
+
+    /// Operations of the site symmetry of an atom.
+    std::vector<int> site_symmetry(int ia__) const
+    {
+        auto& sym = dft_.ctx().unit_cell().symmetry();
+        std::vector<int> result;
+        for (int isym = 0; isym < sym.size(); isym++) {
+            if (sym[isym].spg_op.sym_atom[ia__] == ia__) {
+                result.push_back(isym);
+            }
+        }
+        return result;
+    }
+
+    /// Generate the list of irreducible displacements.
+    void generate_displacements(double h__)
+    {
+        auto& uc  = dft_.ctx().unit_cell();
+        auto& sym = uc.symmetry();
+
+        orbit_ = std::vector<std::pair<int, int>>(uc.num_atoms(), std::make_pair(-1, -1));
+        displacements_.clear();
+
+        for (int ia = 0; ia < uc.num_atoms(); ia++) {
+            if (orbit_[ia].first >= 0) {
+                continue;
+            }
+            /* ia is the representative of a new orbit */
+            for (int isym = 0; isym < sym.size(); isym++) {
+                int ja = sym[isym].spg_op.sym_atom[ia];
+                if (orbit_[ja].first < 0) {
+                    orbit_[ja] = std::make_pair(ia, isym);
+                }
+            }
+
+            auto site_sym = site_symmetry(ia);
+
+            /* orthonormal basis of the space spanned by the images of selected directions */
+            std::vector<r3::vector<double>> basis;
+            for (int x : {0, 1, 2}) {
+                if (basis.size() == 3) {
+                    break;
+                }
+                r3::vector<double> d(0, 0, 0);
+                d[x] = 1;
+
+                bool new_direction{false};
+                bool has_minus{false};
+                for (int isym : site_sym) {
+                    auto v = dot(sym[isym].spg_op.Rc, d);
+                    if ((v + d).length() < 1e-8) {
+                        has_minus = true;
+                    }
+                    for (auto& e : basis) {
+                        v = v - e * dot(e, v);
+                    }
+                    if (v.length() > 1e-6) {
+                        basis.push_back(v * (1.0 / v.length()));
+                        new_direction = true;
+                    }
+                }
+                if (new_direction) {
+                    displacements_.push_back({ia, d * h__});
+                    if (!has_minus) {
+                        displacements_.push_back({ia, d * (-h__)});
+                    }
+                }
+            }
+        }
+    }
+
+  public:
+    Finite_displacement_phonons(DFT_ground_state& dft__)
+        : dft_{dft__}
+    {
+        if (dft_.ctx().full_potential()) {
+            RTE_THROW("finite-displacement phonons are implemented only for the pseudopotential case");
+        }
+    }
+
+    /// Compute the force constants and write them to the HDF5 file.
+    /** The ground state of the undistorted structure must be converged before calling this function.
+     *
+     *  \param [in] h__           Magnitude of the atomic displacement (in a.u.).
+     *  \param [in] num_groups__  Number of groups of MPI ranks that compute displacements concurrently.
+     *  \param [in] fname__       Name of the output HDF5 file.
+     */
+    nlohmann::json find(double h__, int num_groups__, std::string const& fname__)
+    {
+        PROFILE("sirius::Finite_displacement_phonons::find");
+
+        auto& ctx  = dft_.ctx();
+        auto& uc   = ctx.unit_cell();
+        auto& sym  = uc.symmetry();
+        auto& comm = ctx.comm();
+
+        int na = uc.num_atoms();
+
+        generate_displacements(h__);
+        int ndisp = static_cast<int>(displacements_.size());
+
+        num_groups__ = std::max(1, std::min(num_groups__, std::min(comm.size(), ndisp)));
+
+        rte::ostream out(ctx.out(), __func__);
+        out << "number of irreducible displacements: " << ndisp << ", number of groups: " << num_groups__
+            << std::endl;
+        for (auto& e : displacements_) {
+            out << "  atom : " << e.ia << ", u : " << e.u << std::endl;
+        }
+
+        /* change of forces for each displacement */
+        sddk::mdarray<double, 3> dforces(3, na, ndisp);
+        dforces.zero();
+        std::vector<int> num_scf_iter(ndisp, 0);
+
+        /* contiguous blocks of ranks form the groups */
+        int color = static_cast<int>(static_cast<long>(comm.rank()) * num_groups__ / comm.size());
+        auto comm_group = comm.split(color);
+        {
+            auto dict = ctx.cfg().dict();
+            dict.erase("locked");
+            /* displacements break the symmetry, so the full k-mesh is used by all of them */
+            dict["parameters"]["use_ibz"] = false;
+            dict["control"]["verbosity"]  = 0;
+            Simulation_context ctx_g(dict.dump(), comm_group);
+            ctx_g.initialize();
+
+            auto& inp = ctx_g.cfg().parameters();
+
+            /* undistorted ground state of the group */
+            K_point_set kset_ref(ctx_g, inp.ngridk(), inp.shiftk(), false);
+            DFT_ground_state dft_ref(kset_ref);
+            dft_ref.initial_state(dft_);
+            dft_ref.find(inp.density_tol(), inp.energy_tol(), ctx_g.cfg().iterative_solver().energy_tolerance(),
+                    inp.num_dft_iter(), false);
+            auto& f0 = dft_ref.forces().calc_forces_total();
+            sddk::mdarray<double, 2> forces_ref(3, na);
+            sddk::copy(f0, forces_ref);
+
+            K_point_set kset(ctx_g, inp.ngridk(), inp.shiftk(), false);
+            DFT_ground_state dft(kset);
+
+            for (int i = color; i < ndisp; i += num_groups__) {
+                int ia   = displacements_[i].ia;
+                auto pos = ctx_g.unit_cell().atom(ia).position();
+
+                ctx_g.unit_cell().atom(ia).set_position(pos + uc.get_fractional_coordinates(displacements_[i].u));
+                dft.update();
+                dft.initial_state(dft_ref);
+                auto result = dft.find(inp.density_tol(), inp.energy_tol(),
+                        ctx_g.cfg().iterative_solver().energy_tolerance(), inp.num_dft_iter(), false);
+                auto& f = dft.forces().calc_forces_total();
+                if (comm_group.rank() == 0) {
+                    for (int ja = 0; ja < na; ja++) {
+                        for (int x : {0, 1, 2}) {
+                            dforces(x, ja, i) = f(x, ja) - forces_ref(x, ja);
+                        }
+                    }
+                    num_scf_iter[i] = static_cast<int>(result["etot_history"].size());
+                }
+                ctx_g.unit_cell().atom(ia).set_position(pos);
+            }
+        }
+        comm.allreduce(dforces.at(sddk::memory_t::host), dforces.size());
+        comm.allreduce(num_scf_iter.data(), ndisp);
+
+        /* force constants Phi(beta, b, alpha, a) */
+        sddk::mdarray<double, 4> fc(3, na, 3, na);
+        fc.zero();
+
+        for (int ia = 0; ia < na; ia++) {
+            if (orbit_[ia].first != ia) {
+                continue;
+            }
+            auto site_sym = site_symmetry(ia);
+
+            /* sum of u u^T over all displacements and their images */
+            r3::matrix<double> uu;
+            /* sum of -dF u^T for each atom */
+            std::vector<r3::matrix<double>> fu(na);
+            for (int i = 0; i < ndisp; i++) {
+                if (displacements_[i].ia != ia) {
+                    continue;
+                }
+                for (int isym : site_sym) {
+                    auto& R = sym[isym].spg_op.Rc;
+                    auto u  = dot(R, displacements_[i].u);
+                    for (int x : {0, 1, 2}) {
+                        for (int y : {0, 1, 2}) {
+                            uu(x, y) += u[x] * u[y];
+                        }
+                    }
+                    for (int ja = 0; ja < na; ja++) {
+                        auto df = dot(R, r3::vector<double>(dforces(0, ja, i), dforces(1, ja, i), dforces(2, ja, i)));
+                        int jb  = sym[isym].spg_op.sym_atom[ja];
+                        for (int x : {0, 1, 2}) {
+                            for (int y : {0, 1, 2}) {
+                                fu[jb](x, y) -= df[x] * u[y];
+                            }
+                        }
+                    }
+                }
+            }
+            auto uu_inv = inverse(uu);
+            for (int ja = 0; ja < na; ja++) {
+                auto phi = dot(fu[ja], uu_inv);
+                for (int x : {0, 1, 2}) {
+                    for (int y : {0, 1, 2}) {
+                        fc(x, ja, y, ia) = phi(x, y);
+                    }
+                }
+            }
+        }
+
+        /* remaining atoms of each orbit */
+        for (int ia = 0; ia < na; ia++) {
+            int ia0 = orbit_[ia].first;
+            if (ia0 == ia) {
+                continue;
+            }
+            auto& op = sym[orbit_[ia].second].spg_op;
+            auto RT  = transpose(op.Rc);
+            for (int ja = 0; ja < na; ja++) {
+                r3::matrix<double> phi;
+                for (int x : {0, 1, 2}) {
+                    for (int y : {0, 1, 2}) {
+                        phi(x, y) = fc(x, ja, y, ia0);
+                    }
+                }
+                phi = dot(dot(op.Rc, phi), RT);
+                int jb = op.sym_atom[ja];
+                for (int x : {0, 1, 2}) {
+                    for (int y : {0, 1, 2}) {
+                        fc(x, jb, y, ia) = phi(x, y);
+                    }
+                }
+            }
+        }
+
+        /* symmetrize with respect to the exchange of indices */
+        for (int ia = 0; ia < na; ia++) {
+            for (int ja = 0; ja <= ia; ja++) {
+                for (int x : {0, 1, 2}) {
+                    for (int y : {0, 1, 2}) {
+                        if (ja == ia && y > x) {
+                            continue;
+                        }
+                        double v = 0.5 * (fc(x, ja, y, ia) + fc(y, ia, x, ja));
+                        fc(x, ja, y, ia) = v;
+                        fc(y, ia, x, ja) = v;
+                    }
+                }
+            }
+        }
+
+        if (comm.rank() == 0) {
+            sddk::HDF5_tree fout(fname__, sddk::hdf5_access_t::truncate);
+            fout.write("num_atoms", na);
+            fout.write("displacement", h__);
+            fout.write("force_constants", fc);
+            sddk::mdarray<double, 2> u(3, ndisp);
+            std::vector<int> atoms(ndisp);
+            for (int i = 0; i < ndisp; i++) {
+                atoms[i] = displacements_[i].ia;
+                for (int x : {0, 1, 2}) {
+                    u(x, i) = displacements_[i].u[x];
+                }
+            }
+            fout.write("displaced_atoms", atoms);
+            fout.write("displacements", u);
+            fout.write("delta_forces", dforces);
+        }
+
+        nlohmann::json result;
+        result["num_displacements"]  = ndisp;
+        result["num_groups"]         = num_groups__;
+        result["displacement"]       = h__;
+        result["num_scf_iterations"] = num_scf_iter;
+        result["file"]               = fname__;
+        return result;
+    }
+};
+
+}
+
+#endif
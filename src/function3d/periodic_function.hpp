@@ -182,6 +182,7 @@ class Periodic_function
         auto v = this->rg().gather_f_pw();
         if (ctx_.comm().rank() == 0) {
             sddk::HDF5_tree fout(storage_file_name, sddk::hdf5_access_t::read_write);
+            fout.set_layout(ctx_.hdf5_layout());
             fout[path__].write("f_pw", reinterpret_cast<T*>(v.data()), static_cast<int>(v.size() * 2));
             if (ctx_.full_potential()) {
                 for (int ia = 0; ia < unit_cell_.num_atoms(); ia++) {
@@ -193,24 +194,34 @@ class Periodic_function
         }
     }
 
-    void hdf5_read(sddk::HDF5_tree h5f__, sddk::mdarray<int, 2>& gvec__)
+    /// Set the plane-wave coefficients from the global list of coefficients of a different G-vector set.
+    /** Coefficients of the G-vectors which are not in the list are set to zero. This is used to read the function
+     *  from the file and to interpolate it between different plane-wave cutoffs. */
+    void set_f_pw(sddk::mdarray<int, 2> const& gvec__, std::complex<T> const* f_pw__)
     {
-        std::vector<std::complex<T>> v(gvec_.num_gvec());
-        h5f__.read("f_pw", reinterpret_cast<T*>(v.data()), static_cast<int>(v.size() * 2));
-
         std::map<r3::vector<int>, int> local_gvec_mapping;
 
         for (int igloc = 0; igloc < gvec_.count(); igloc++) {
             auto G                = gvec_.gvec<sddk::index_domain_t::local>(igloc);
             local_gvec_mapping[G] = igloc;
+            this->rg().f_pw_local(igloc) = 0;
         }
 
-        for (int ig = 0; ig < gvec_.num_gvec(); ig++) {
+        for (int ig = 0; ig < static_cast<int>(gvec__.size(1)); ig++) {
             r3::vector<int> G(&gvec__(0, ig));
-            if (local_gvec_mapping.count(G) != 0) {
-                this->rg().f_pw_local(local_gvec_mapping[G]) = v[ig];
+            auto it = local_gvec_mapping.find(G);
+            if (it != local_gvec_mapping.end()) {
+                this->rg().f_pw_local(it->second) = f_pw__[ig];
             }
         }
+    }
+
+    void hdf5_read(sddk::HDF5_tree h5f__, sddk::mdarray<int, 2>& gvec__)
+    {
+        std::vector<std::complex<T>> v(gvec_.num_gvec());
+        h5f__.read("f_pw", reinterpret_cast<T*>(v.data()), static_cast<int>(v.size() * 2));
+
+        this->set_f_pw(gvec__, v.data());
 
         if (ctx_.full_potential()) {
             for (int ia = 0; ia < unit_cell_.num_atoms(); ia++) {
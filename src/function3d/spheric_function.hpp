@@ -28,11 +28,21 @@
 
 #include <array>
 #include <typeinfo>
+#include <type_traits>
 #include "radial/spline.hpp"
 #include "sht/sht.hpp"
 
 namespace sirius {
 
+/// Base class of the arithmetic expressions of spheric functions.
+/** Expressions are created by the arithmetic operators and evaluated when assigned or added to a function. */
+struct Spheric_function_expr_base
+{
+};
+
+template <typename E>
+using enable_if_spheric_expr_t = std::enable_if_t<std::is_base_of<Spheric_function_expr_base, E>::value>;
+
 /// Function in spherical harmonics or spherical coordinates representation.
 /** This class works in conjugation with SHT class which provides the transformation between spherical
     harmonics and spherical coordinates and also a conversion between real and complex spherical harmonics.
@@ -55,6 +65,28 @@ class Spheric_function: public sddk::mdarray<T, 2>
     /* copy assignment operator is disabled */
     Spheric_function<domain_t, T>& operator=(Spheric_function<domain_t, T> const& src__) = delete;
 
+    /// Evaluate the expression element-wise and combine it with the values of the function.
+    template <typename E, typename F>
+    inline void evaluate(E const& e__, F&& op__)
+    {
+        static_assert(E::domain == domain_t, "wrong domain of the expression");
+
+        if (e__.angular_domain_size() != angular_domain_size_ ||
+            e__.radial_grid().num_points() != radial_grid().num_points()) {
+            RTE_THROW("wrong size of the expression");
+        }
+
+        T* ptr = this->at(sddk::memory_t::host);
+        int na = angular_domain_size_;
+        #pragma omp parallel for schedule(static)
+        for (int ir = 0; ir < radial_grid_->num_points(); ir++) {
+            for (int i = 0; i < na; i++) {
+                size_t j = static_cast<size_t>(ir) * na + i;
+                op__(ptr[j], e__[j]);
+            }
+        }
+    }
+
   public:
 
     /// Constructor of the empty function.
@@ -86,6 +118,15 @@ class Spheric_function: public sddk::mdarray<T, 2>
     {
     }
 
+    /// Constructor from the arithmetic expression.
+    /** Storage is allocated once and the expression is evaluated directly into it. */
+    template <typename E, typename = enable_if_spheric_expr_t<E>>
+    Spheric_function(E const& e__)
+        : Spheric_function(e__.angular_domain_size(), e__.radial_grid())
+    {
+        evaluate(e__, [](T& y, T x) { y = x; });
+    }
+
     /// Move constructor.
     Spheric_function(Spheric_function<domain_t, T>&& src__)
         : sddk::mdarray<T, 2>(std::move(src__))
@@ -105,6 +146,20 @@ class Spheric_function: public sddk::mdarray<T, 2>
         return *this;
     }
 
+    /// Assign the arithmetic expression.
+    /** The existing storage is reused if it has the right size. */
+    template <typename E, typename = enable_if_spheric_expr_t<E>>
+    inline Spheric_function<domain_t, T>& operator=(E const& e__)
+    {
+        if (this->size() == 0 || angular_domain_size_ != e__.angular_domain_size() ||
+            radial_grid_->num_points() != e__.radial_grid().num_points()) {
+            *this = Spheric_function<domain_t, T>(e__.angular_domain_size(), e__.radial_grid());
+        }
+        radial_grid_ = &e__.radial_grid();
+        evaluate(e__, [](T& y, T x) { y = x; });
+        return *this;
+    }
+
     inline Spheric_function<domain_t, T>& operator+=(Spheric_function<domain_t, T> const& rhs__)
     {
         for (int i1 = 0; i1 < (int)this->size(1); i1++) {
@@ -146,6 +201,23 @@ class Spheric_function: public sddk::mdarray<T, 2>
 
         return *this;
     }
+
+    /// Add the arithmetic expression in a single pass.
+    template <typename E, typename = enable_if_spheric_expr_t<E>>
+    inline Spheric_function<domain_t, T>& operator+=(E const& e__)
+    {
+        evaluate(e__, [](T& y, T x) { y += x; });
+        return *this;
+    }
+
+    /// Subtract the arithmetic expression in a single pass.
+    template <typename E, typename = enable_if_spheric_expr_t<E>>
+    inline Spheric_function<domain_t, T>& operator-=(E const& e__)
+    {
+        evaluate(e__, [](T& y, T x) { y -= x; });
+        return *this;
+    }
+
     /// Multiply by a constant.
     inline Spheric_function<domain_t, T>& operator*=(double alpha__)
     {
@@ -169,17 +241,24 @@ class Spheric_function: public sddk::mdarray<T, 2>
         return *radial_grid_;
     }
 
-    auto component(int lm__) const
+    /// Interpolate the lm component of the function with the existing spline defined on the same radial grid.
+    void component(int lm__, Spline<T>& s__) const
     {
         if (domain_t != function_domain_t::spectral) {
             RTE_THROW("function is not is spectral domain");
         }
+        RTE_ASSERT(s__.num_points() == radial_grid_->num_points());
 
-        Spline<T> s(radial_grid());
         for (int ir = 0; ir < radial_grid_->num_points(); ir++) {
-            s(ir) = (*this)(lm__, ir);
+            s__(ir) = (*this)(lm__, ir);
         }
-        s.interpolate();
+        s__.interpolate();
+    }
+
+    auto component(int lm__) const
+    {
+        Spline<T> s(radial_grid());
+        component(lm__, s);
         return s;
     }
 
@@ -241,128 +320,312 @@ class Spheric_vector_function : public std::array<Spheric_function<domain_t, T>,
     }
 };
 
-/// Multiplication of two functions in spatial domain.
-/** The result of the operation is a scalar function in spatial domain */
-template <typename T>
-inline auto operator*(Spheric_function<function_domain_t::spatial, T> const& a__,
-                      Spheric_function<function_domain_t::spatial, T> const& b__)
+/// Reference to the function as a leaf of the arithmetic expression.
+template <function_domain_t domain_t, typename T>
+class Spheric_function_ref_expr : public Spheric_function_expr_base
 {
-    if (a__.radial_grid().hash() != b__.radial_grid().hash()) {
-        RTE_THROW("wrong radial grids");
-    }
-    if (a__.angular_domain_size() != b__.angular_domain_size()) {
-        RTE_THROW("wrong angular domain sizes");
+  private:
+    Spheric_function<domain_t, T> const* f_;
+
+    T const* ptr_;
+
+  public:
+    static constexpr function_domain_t domain = domain_t;
+
+    using value_type = T;
+
+    explicit Spheric_function_ref_expr(Spheric_function<domain_t, T> const& f__)
+        : f_(&f__)
+        , ptr_(f__.at(sddk::memory_t::host))
+    {
     }
 
-    Spheric_function<function_domain_t::spatial, T> res(a__.angular_domain_size(), a__.radial_grid());
+    inline T operator[](size_t i__) const
+    {
+        return ptr_[i__];
+    }
 
-    #pragma omp parallel for schedule(static)
-    for (int ir = 0; ir < res.radial_grid().num_points(); ir++) {
-        for (int tp = 0; tp < res.angular_domain_size(); tp++) {
-            res(tp, ir) = a__(tp, ir) * b__(tp, ir);
-        }
+    inline int angular_domain_size() const
+    {
+        return f_->angular_domain_size();
     }
 
-    return res;
-}
+    inline auto const& radial_grid() const
+    {
+        return f_->radial_grid();
+    }
+};
 
-/// Dot product of two gradiensts of real functions in spatial domain.
-/** The result of the operation is the real scalar function in spatial domain */
-inline auto operator*(Spheric_vector_function<function_domain_t::spatial, double> const& f,
-                      Spheric_vector_function<function_domain_t::spatial, double> const& g)
+/// Temporary function owned by the arithmetic expression.
+/** The function is moved into the expression, so the result of e.g. transform() can be used as an operand
+    without the risk of a dangling reference. */
+template <function_domain_t domain_t, typename T>
+class Spheric_function_value_expr : public Spheric_function_expr_base
 {
-    if (f.radial_grid().hash() != g.radial_grid().hash()) {
-        RTE_THROW("wrong radial grids");
+  private:
+    Spheric_function<domain_t, T> f_;
+
+    T const* ptr_;
+
+  public:
+    static constexpr function_domain_t domain = domain_t;
+
+    using value_type = T;
+
+    explicit Spheric_function_value_expr(Spheric_function<domain_t, T>&& f__)
+        : f_(std::move(f__))
+        , ptr_(f_.at(sddk::memory_t::host))
+    {
     }
 
-    for (int x: {0, 1, 2}) {
-        if (f[x].angular_domain_size() != g[x].angular_domain_size()) {
-            RTE_THROW("wrong number of angular points");
-        }
+    /* the storage is moved together with the function and the pointer stays valid */
+    Spheric_function_value_expr(Spheric_function_value_expr<domain_t, T>&& src__) = default;
+
+    inline T operator[](size_t i__) const
+    {
+        return ptr_[i__];
     }
 
-    Spheric_function<function_domain_t::spatial, double> result(f.angular_domain_size(), f.radial_grid());
-    result.zero();
+    inline int angular_domain_size() const
+    {
+        return f_.angular_domain_size();
+    }
 
-    for (int x: {0, 1, 2}) {
-        #pragma omp parallel for schedule(static)
-        for (int ir = 0; ir < f.radial_grid().num_points(); ir++) {
-            for (int tp = 0; tp < f.angular_domain_size(); tp++) {
-                result(tp, ir) += f[x](tp, ir) * g[x](tp, ir);
-            }
-        }
+    inline auto const& radial_grid() const
+    {
+        return f_.radial_grid();
     }
+};
 
-    return result;
-}
+/// Element-wise binary operations of the expressions.
+struct spheric_expr_add
+{
+    template <typename T>
+    static inline T apply(T a__, T b__)
+    {
+        return a__ + b__;
+    }
+};
 
-/// Summation of two functions.
-template <function_domain_t domain_t, typename T>
-auto operator+(Spheric_function<domain_t, T> const& a__, Spheric_function<domain_t, T> const& b__)
+struct spheric_expr_sub
 {
-    if (a__.radial_grid().hash() != b__.radial_grid().hash()) {
-        RTE_THROW("wrong radial grids");
+    template <typename T>
+    static inline T apply(T a__, T b__)
+    {
+        return a__ - b__;
     }
-    if (a__.angular_domain_size() != b__.angular_domain_size()) {
-        RTE_THROW("wrong angular domain sizes");
+};
+
+struct spheric_expr_mul
+{
+    template <typename T>
+    static inline T apply(T a__, T b__)
+    {
+        return a__ * b__;
     }
+};
 
-    Spheric_function<domain_t, T> result(a__.angular_domain_size(), a__.radial_grid());
+/// Element-wise binary operation of two expressions.
+template <typename Op, typename L, typename R>
+class Spheric_function_binary_expr : public Spheric_function_expr_base
+{
+  private:
+    L l_;
+
+    R r_;
 
-    #pragma omp parallel for schedule(static)
-    for (int ir = 0; ir < a__.radial_grid().num_points(); ir++) {
-        for (int i = 0; i < a__.angular_domain_size(); i++) {
-            result(i, ir) = a__(i, ir) + b__(i, ir);
+    static_assert(L::domain == R::domain, "functions must be in the same domain");
+
+  public:
+    static constexpr function_domain_t domain = L::domain;
+
+    using value_type = typename L::value_type;
+
+    Spheric_function_binary_expr(L&& l__, R&& r__)
+        : l_(std::move(l__))
+        , r_(std::move(r__))
+    {
+        if (&l_.radial_grid() != &r_.radial_grid() && l_.radial_grid().hash() != r_.radial_grid().hash()) {
+            RTE_THROW("wrong radial grids");
+        }
+        if (l_.angular_domain_size() != r_.angular_domain_size()) {
+            RTE_THROW("wrong angular domain sizes");
         }
     }
 
-    return result;
-}
+    inline value_type operator[](size_t i__) const
+    {
+        return Op::apply(l_[i__], r_[i__]);
+    }
 
-/// Subtraction of functions.
-template <function_domain_t domain_t, typename T>
-auto operator-(Spheric_function<domain_t, T> const& a__, Spheric_function<domain_t, T> const& b__)
+    inline int angular_domain_size() const
+    {
+        return l_.angular_domain_size();
+    }
+
+    inline auto const& radial_grid() const
+    {
+        return l_.radial_grid();
+    }
+};
+
+/// Expression multiplied by a scalar.
+template <typename E>
+class Spheric_function_scaled_expr : public Spheric_function_expr_base
 {
-    if (a__.radial_grid().hash() != b__.radial_grid().hash()) {
-        RTE_THROW("wrong radial grids");
+  public:
+    static constexpr function_domain_t domain = E::domain;
+
+    using value_type = typename E::value_type;
+
+  private:
+    value_type alpha_;
+
+    E e_;
+
+  public:
+    Spheric_function_scaled_expr(value_type alpha__, E&& e__)
+        : alpha_(alpha__)
+        , e_(std::move(e__))
+    {
     }
-    if (a__.angular_domain_size() != b__.angular_domain_size()) {
-        RTE_THROW("wrong angular domain sizes");
+
+    inline value_type operator[](size_t i__) const
+    {
+        return alpha_ * e_[i__];
     }
 
-    Spheric_function<domain_t, T> res(a__.angular_domain_size(), a__.radial_grid());
+    inline int angular_domain_size() const
+    {
+        return e_.angular_domain_size();
+    }
 
-    #pragma omp parallel for schedule(static)
-    for (int ir = 0; ir < a__.radial_grid().num_points(); ir++) {
-        for (int i = 0; i < a__.angular_domain_size(); i++) {
-            res(i, ir) = a__(i, ir) - b__(i, ir);
-        }
+    inline auto const& radial_grid() const
+    {
+        return e_.radial_grid();
     }
+};
 
-    return res;
+/// Wrap a named function into the expression by reference.
+template <function_domain_t domain_t, typename T>
+inline auto
+as_spheric_expr(Spheric_function<domain_t, T> const& f__)
+{
+    return Spheric_function_ref_expr<domain_t, T>(f__);
 }
 
-/// Multiply function by a scalar.
+/// Take ownership of a temporary function.
 template <function_domain_t domain_t, typename T>
-auto operator*(T a__, Spheric_function<domain_t, T> const& b__)
+inline auto
+as_spheric_expr(Spheric_function<domain_t, T>&& f__)
 {
-    Spheric_function<domain_t, T> res(b__.angular_domain_size(), b__.radial_grid());
+    return Spheric_function_value_expr<domain_t, T>(std::move(f__));
+}
 
-    T const* ptr_rhs = &b__(0, 0);
-    T* ptr_res = &res(0, 0);
+/// Expression is already an expression.
+template <typename E, typename = enable_if_spheric_expr_t<std::decay_t<E>>>
+inline auto
+as_spheric_expr(E&& e__)
+{
+    return std::decay_t<E>(std::forward<E>(e__));
+}
 
-    #pragma omp parallel for schedule(static)
-    for (size_t i = 0; i < b__.size(); i++) {
-        ptr_res[i] = a__ * ptr_rhs[i];
-    }
+/// Properties of the operands of the arithmetic operators.
+template <typename X, typename = void>
+struct spheric_operand_traits
+{
+    static const bool value = false;
+};
 
-    return res;
+template <function_domain_t domain_t, typename T>
+struct spheric_operand_traits<Spheric_function<domain_t, T>>
+{
+    static const bool value = true;
+    static constexpr function_domain_t domain = domain_t;
+    using value_type = T;
+};
+
+template <typename E>
+struct spheric_operand_traits<E, enable_if_spheric_expr_t<E>>
+{
+    static const bool value = true;
+    static constexpr function_domain_t domain = E::domain;
+    using value_type = typename E::value_type;
+};
+
+template <typename A, typename B>
+using enable_if_spheric_operands_t = std::enable_if_t<spheric_operand_traits<std::decay_t<A>>::value &&
+                                                      spheric_operand_traits<std::decay_t<B>>::value>;
+
+/// Summation of two functions.
+/** Arithmetic operators return lazy expressions. They are evaluated element-wise in a single pass when assigned
+    or added to a Spheric_function and no temporary functions are allocated. Named operands are referenced by the
+    expression and must outlive it. */
+template <typename A, typename B, typename = enable_if_spheric_operands_t<A, B>>
+inline auto
+operator+(A&& a__, B&& b__)
+{
+    auto a = as_spheric_expr(std::forward<A>(a__));
+    auto b = as_spheric_expr(std::forward<B>(b__));
+    return Spheric_function_binary_expr<spheric_expr_add, decltype(a), decltype(b)>(std::move(a), std::move(b));
+}
+
+/// Subtraction of functions.
+template <typename A, typename B, typename = enable_if_spheric_operands_t<A, B>>
+inline auto
+operator-(A&& a__, B&& b__)
+{
+    auto a = as_spheric_expr(std::forward<A>(a__));
+    auto b = as_spheric_expr(std::forward<B>(b__));
+    return Spheric_function_binary_expr<spheric_expr_sub, decltype(a), decltype(b)>(std::move(a), std::move(b));
+}
+
+/// Multiplication of two functions in spatial domain.
+/** The result of the operation is a scalar function in spatial domain */
+template <typename A, typename B, typename = enable_if_spheric_operands_t<A, B>>
+inline auto
+operator*(A&& a__, B&& b__)
+{
+    static_assert(spheric_operand_traits<std::decay_t<A>>::domain == function_domain_t::spatial,
+                  "product of functions is defined only in spatial domain");
+    auto a = as_spheric_expr(std::forward<A>(a__));
+    auto b = as_spheric_expr(std::forward<B>(b__));
+    return Spheric_function_binary_expr<spheric_expr_mul, decltype(a), decltype(b)>(std::move(a), std::move(b));
+}
+
+/// Multiply function by a scalar.
+template <typename B, typename = std::enable_if_t<spheric_operand_traits<std::decay_t<B>>::value>>
+inline auto
+operator*(typename spheric_operand_traits<std::decay_t<B>>::value_type a__, B&& b__)
+{
+    auto b = as_spheric_expr(std::forward<B>(b__));
+    return Spheric_function_scaled_expr<decltype(b)>(a__, std::move(b));
 }
+
 /// Multiply function by a scalar (inverse order).
-template <function_domain_t domain_t, typename T>
-auto operator*(Spheric_function<domain_t, T> const& b__, T a__)
+template <typename B, typename = std::enable_if_t<spheric_operand_traits<std::decay_t<B>>::value>>
+inline auto
+operator*(B&& b__, typename spheric_operand_traits<std::decay_t<B>>::value_type a__)
 {
-    return (a__ * b__);
+    return a__ * std::forward<B>(b__);
+}
+
+/// Dot product of two gradiensts of real functions in spatial domain.
+/** The result of the operation is the real scalar function in spatial domain */
+inline auto operator*(Spheric_vector_function<function_domain_t::spatial, double> const& f,
+                      Spheric_vector_function<function_domain_t::spatial, double> const& g)
+{
+    if (f.radial_grid().hash() != g.radial_grid().hash()) {
+        RTE_THROW("wrong radial grids");
+    }
+
+    for (int x: {0, 1, 2}) {
+        if (f[x].angular_domain_size() != g[x].angular_domain_size()) {
+            RTE_THROW("wrong number of angular points");
+        }
+    }
+
+    return f[0] * g[0] + f[1] * g[1] + f[2] * g[2];
 }
 
 /// Inner product of two spherical functions.
@@ -404,13 +667,14 @@ laplacian(Spheric_function<function_domain_t::spectral, T> const& f__)
     int lmax = utils::lmax(lmmax);
     g = Spheric_function<function_domain_t::spectral, T>(lmmax, rgrid);
 
+    Spline<T> s(rgrid);
     Spline<T> s1(rgrid);
     for (int l = 0; l <= lmax; l++) {
         int ll = l * (l + 1);
         for (int m = -l; m <= l; m++) {
             int lm = utils::lm(l, m);
             /* get lm component */
-            auto s = f__.component(lm);
+            f__.component(lm, s);
             /* compute 1st derivative */
             for (int ir = 0; ir < s.num_points(); ir++) {
                 s1(ir) = s.deriv(1, ir);
@@ -540,6 +804,18 @@ transform(SHT const& sht__, Spheric_function<function_domain_t::spatial, T> cons
     sht__.forward_transform(&f__(0, 0), f__.radial_grid().num_points(), sht__.lmmax(), sht__.lmmax(), &g__(0, 0));
 }
 
+/// Transform to spectral domain and add the result to the function.
+/** Only the first min(sht.lmmax(), g.angular_domain_size()) harmonics of the function are updated. */
+template <typename T>
+inline void
+transform_add(SHT const& sht__, Spheric_function<function_domain_t::spatial, T> const& f__,
+              Spheric_function<function_domain_t::spectral, T>& g__)
+{
+    sht__.forward_transform(&f__(0, 0), f__.radial_grid().num_points(),
+                            std::min(sht__.lmmax(), g__.angular_domain_size()), g__.angular_domain_size(),
+                            &g__(0, 0), T(1));
+}
+
 /// Transform to spectral domain.
 template <typename T>
 inline auto
@@ -561,13 +837,15 @@ gradient(Spheric_function<function_domain_t::spectral, std::complex<double>> con
 
     int lmax = utils::lmax(f.angular_domain_size());
 
+    /* spline of the current lm component */
+    Spline<std::complex<double>> s(f.radial_grid());
     for (int l = 0; l <= lmax; l++) {
         double d1 = std::sqrt(double(l + 1) / double(2 * l + 3));
         double d2 = std::sqrt(double(l) / double(2 * l - 1));
 
         for (int m = -l; m <= l; m++) {
             int lm = utils::lm(l, m);
-            auto s = f.component(lm);
+            f.component(lm, s);
 
             for (int mu = -1; mu <= 1; mu++) {
                 int j = (mu + 2) % 3; // map -1,0,1 to 1,2,0 (to y,z,x)
@@ -609,8 +887,6 @@ gradient(Spheric_function<function_domain_t::spectral, std::complex<double>> con
 inline auto
 gradient(Spheric_function<function_domain_t::spectral, double> const& f__)
 {
-    int lmax = utils::lmax(f__.angular_domain_size());
-    SHT sht(sddk::device_t::CPU, lmax);
     auto zf = convert(f__);
     auto zg = gradient(zf);
     Spheric_vector_function<function_domain_t::spectral, double> g(f__.angular_domain_size(), f__.radial_grid());
@@ -123,14 +123,51 @@ class Spheric_function_set
     }
 
     /// Synchronize global function.
-    /** Assuming that each MPI rank was handling part of the global spherical function, broadcast data
-     *  from each rank. As a result, each rank stores a full and identical copy of global spherical function. */
+    /** Assuming that each MPI rank was handling part of the global spherical function, gather data
+     *  from all ranks. As a result, each rank stores a full and identical copy of global spherical function.
+     *
+     *  The functions of the local atoms are packed into a single buffer and exchanged with one MPI_Allgatherv
+     *  call instead of one broadcast per atom. Block distribution guarantees that the local atoms of each rank
+     *  form a contiguous range of the global index, so the gathered buffer is ordered by the global index.
+     *  Callers that only access the local atoms don't need to call this function. */
     inline void sync(sddk::splindex<sddk::splindex_t::block> const& spl_atoms__)
     {
+        PROFILE("sirius::Spheric_function_set::sync");
+
+        auto const& comm = unit_cell_->comm();
+
+        if (comm.size() == 1) {
+            return;
+        }
+
+        std::vector<int> counts(comm.size(), 0);
+        for (int i = 0; i < spl_atoms__.global_index_size(); i++) {
+            counts[spl_atoms__.location(i).rank] += static_cast<int>(func_[atoms_[i]].size());
+        }
+        std::vector<int> offsets(comm.size(), 0);
+        for (int r = 1; r < comm.size(); r++) {
+            offsets[r] = offsets[r - 1] + counts[r - 1];
+        }
+
+        std::vector<T> buf(offsets.back() + counts.back());
+
+        /* pack local atoms */
+        int offs = offsets[comm.rank()];
+        for (int i = 0; i < spl_atoms__.local_size(); i++) {
+            int ia = atoms_[spl_atoms__[i]];
+            std::copy(func_[ia].at(sddk::memory_t::host), func_[ia].at(sddk::memory_t::host) + func_[ia].size(),
+                      buf.data() + offs);
+            offs += static_cast<int>(func_[ia].size());
+        }
+
+        comm.allgather(buf.data(), counts.data(), offsets.data());
+
+        /* unpack all atoms */
+        offs = 0;
         for (int i = 0; i < spl_atoms__.global_index_size(); i++) {
-            auto loc = spl_atoms__.location(i);
             int ia = atoms_[i];
-            unit_cell_->comm().bcast(func_[ia].at(sddk::memory_t::host), static_cast<int>(func_[ia].size()), loc.rank);
+            std::copy(buf.data() + offs, buf.data() + offs + func_[ia].size(), func_[ia].at(sddk::memory_t::host));
+            offs += static_cast<int>(func_[ia].size());
         }
     }
 
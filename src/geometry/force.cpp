@@ -633,7 +633,11 @@ Force::hubbard_force_add_k_contribution_collinear(K_point<double>& kp__, Q_opera
 
     sddk::mdarray<std::complex<double>, 5> dn(r.first, r.first, ctx_.num_spins(), 3, ctx_.unit_cell().num_atoms());
 
-    potential_.U().compute_occupancies_derivatives(kp__, q_op__, dn);
+    if (ctx_.gamma_point()) {
+        potential_.U().compute_occupancies_derivatives<double>(kp__, q_op__, dn);
+    } else {
+        potential_.U().compute_occupancies_derivatives<std::complex<double>>(kp__, q_op__, dn);
+    }
 
     #pragma omp parallel for
     for (int ia = 0; ia < ctx_.unit_cell().num_atoms(); ia++) {
@@ -32,9 +32,12 @@
 
 namespace sirius {
 
-/** \tparam T  Precision type of the wave-functions */
-template<typename T, typename F>
-void add_k_point_contribution_nonlocal(Simulation_context& ctx__, Beta_projectors_base<T>& bp_base__,
+/** \tparam T   Precision type of the wave-functions
+ *  \tparam F   Type of the inner product matrices.
+ *  \tparam BP  Type of the derived beta-projectors (gradient or strain derivative).
+ */
+template<typename T, typename F, typename BP>
+void add_k_point_contribution_nonlocal(Simulation_context& ctx__, BP& bp_base__,
         K_point<T>& kp__, sddk::mdarray<real_type<F>, 2>& collect_res__)
 {
     PROFILE("sirius::add_k_point_contribution_nonlocal");
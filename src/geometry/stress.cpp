@@ -38,7 +38,11 @@ Stress::calc_stress_nonloc_aux()
 {
     PROFILE("sirius::Stress|nonloc");
 
-    sddk::mdarray<real_type<F>, 2> collect_result(9, ctx_.unit_cell().num_atoms());
+    /* stress tensor is symmetric; only the symmetric combinations of strain derivatives are needed */
+    const bool symmetric{true};
+    const int num_comp = symmetric ? 6 : 9;
+
+    sddk::mdarray<real_type<F>, 2> collect_result(num_comp, ctx_.unit_cell().num_atoms());
     collect_result.zero();
 
     stress_nonloc_.zero();
@@ -55,7 +59,7 @@ Stress::calc_stress_nonloc_aux()
         auto kp = kset_.get<T>(ik);
         auto mem = ctx_.processing_unit_memory_t();
         auto mg = kp->spinor_wave_functions().memory_guard(mem, wf::copy_to::device);
-        Beta_projectors_strain_deriv<T> bp_strain_deriv(ctx_, kp->gkvec());
+        Beta_projectors_strain_deriv<T> bp_strain_deriv(ctx_, kp->gkvec(), symmetric);
 
         add_k_point_contribution_nonlocal<T, F>(ctx_, bp_strain_deriv, *kp, collect_result);
     }
@@ -66,9 +70,11 @@ Stress::calc_stress_nonloc_aux()
 
         #pragma omp for
         for (int ia = 0; ia < ctx_.unit_cell().num_atoms(); ia++) {
-            for (int i = 0; i < 3; i++) {
-                for (int j = 0; j < 3; j++) {
-                    tmp_stress(i, j) -= collect_result(j * 3 + i, ia);
+            for (int x = 0; x < num_comp; x++) {
+                auto mn = Beta_projectors_strain_deriv<T>::component(x, symmetric);
+                tmp_stress(mn[0], mn[1]) -= collect_result(x, ia);
+                if (symmetric && mn[0] != mn[1]) {
+                    tmp_stress(mn[1], mn[0]) -= collect_result(x, ia);
                 }
             }
         }
@@ -149,7 +155,11 @@ Stress::calc_stress_hubbard()
         }
 
         /* compute the derivative of the occupancies numbers */
-        potential_.U().compute_occupancies_stress_derivatives(*kp, q_op, dn);
+        if (ctx_.gamma_point()) {
+            potential_.U().compute_occupancies_stress_derivatives<double>(*kp, q_op, dn);
+        } else {
+            potential_.U().compute_occupancies_stress_derivatives<std::complex<double>>(*kp, q_op, dn);
+        }
         for (int dir1 = 0; dir1 < 3; dir1++) {
             for (int dir2 = 0; dir2 < 3; dir2++) {
                 for (int at_lvl = 0; at_lvl < static_cast<int>(potential_.hubbard_potential().local().size());
@@ -287,8 +297,8 @@ Stress::calc_stress_xc()
 {
     stress_xc_.zero();
 
-    double e = sirius::energy_exc(density_, potential_) - sirius::energy_vxc(density_, potential_) -
-               sirius::energy_bxc(density_, potential_);
+    auto ei  = sirius::energy_integrals(density_, potential_);
+    double e = ei.exc - ei.vxc - ei.bxc;
 
     for (int l = 0; l < 3; l++) {
         stress_xc_(l, l) = e / ctx_.unit_cell().omega();
@@ -39,6 +39,12 @@ Hamiltonian0<T>::Hamiltonian0(Potential& potential__, bool precompute_lapw__)
 {
     PROFILE("sirius::Hamiltonian0");
 
+    if (ctx_.full_potential() && precompute_lapw__) {
+        /* this also provides the step-function weighted potential to the local operator; nothing is transformed
+         * if it is already up to date */
+        potential_->generate_pw_coefs();
+    }
+
     local_op_ = std::unique_ptr<Local_operator<T>>(
         new Local_operator<T>(ctx_, ctx_.spfft_coarse<T>(), ctx_.gvec_coarse_fft_sptr(), &potential__));
 
@@ -48,45 +54,86 @@ Hamiltonian0<T>::Hamiltonian0(Potential& potential__, bool precompute_lapw__)
     }
     if (ctx_.full_potential()) {
         if (precompute_lapw__) {
-            potential_->generate_pw_coefs();
             potential_->update_atomic_potential();
             ctx_.unit_cell().generate_radial_functions(ctx_.out());
             ctx_.unit_cell().generate_radial_integrals();
         }
-        hmt_ = std::vector<sddk::mdarray<std::complex<T>, 2>>(ctx_.unit_cell().num_atoms());
-        auto pu = ctx_.processing_unit();
-        #pragma omp parallel
-        {
-            int tid = omp_get_thread_num();
-            #pragma omp for
-            for (int ia = 0; ia < ctx_.unit_cell().num_atoms(); ia++) {
-                auto& atom = ctx_.unit_cell().atom(ia);
-                auto& type = atom.type();
+        generate_hmt();
+    }
+}
 
-                int nmt = type.mt_basis_size();
+template <typename T>
+void
+Hamiltonian0<T>::update(bool precompute_lapw__)
+{
+    PROFILE("sirius::Hamiltonian0::update");
 
+    if (ctx_.full_potential() && precompute_lapw__) {
+        potential_->generate_pw_coefs();
+    }
+
+    local_op_->update(*potential_);
+
+    if (!ctx_.full_potential()) {
+        /* Q-operator depends only on the augmentation charges and is kept as is */
+        d_op_->update();
+    }
+    if (ctx_.full_potential()) {
+        if (precompute_lapw__) {
+            potential_->update_atomic_potential();
+            ctx_.unit_cell().generate_radial_functions(ctx_.out());
+            ctx_.unit_cell().generate_radial_integrals();
+        }
+        generate_hmt();
+    }
+}
+
+template <typename T>
+void
+Hamiltonian0<T>::generate_hmt()
+{
+    PROFILE("sirius::Hamiltonian0::generate_hmt");
+
+    if (hmt_.empty()) {
+        hmt_ = std::vector<sddk::mdarray<std::complex<T>, 2>>(ctx_.unit_cell().num_atoms());
+    }
+    auto pu = ctx_.processing_unit();
+    #pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        #pragma omp for
+        for (int ia = 0; ia < ctx_.unit_cell().num_atoms(); ia++) {
+            auto& atom = ctx_.unit_cell().atom(ia);
+            auto& type = atom.type();
+
+            int nmt = type.mt_basis_size();
+
+            if (hmt_[ia].size() == 0) {
                 hmt_[ia] = sddk::mdarray<std::complex<T>, 2>(nmt, nmt, sddk::memory_t::host, "hmt");
+            }
 
-                /* compute muffin-tin Hamiltonian */
-                for (int j2 = 0; j2 < nmt; j2++) {
-                    int lm2    = type.indexb(j2).lm;
-                    int idxrf2 = type.indexb(j2).idxrf;
-                    for (int j1 = 0; j1 <= j2; j1++) {
-                        int lm1    = type.indexb(j1).lm;
-                        int idxrf1 = type.indexb(j1).idxrf;
-                        hmt_[ia](j1, j2) = atom.radial_integrals_sum_L3<spin_block_t::nm>(idxrf1, idxrf2,
-                                                                                type.gaunt_coefs().gaunt_vector(lm1, lm2));
-                        hmt_[ia](j2, j1) = std::conj(hmt_[ia](j1, j2));
-                    }
-                }
-                if (pu == sddk::device_t::GPU) {
-                    hmt_[ia].allocate(sddk::memory_t::device).copy_to(sddk::memory_t::device, stream_id(tid));
+            /* compute muffin-tin Hamiltonian */
+            for (int j2 = 0; j2 < nmt; j2++) {
+                int lm2    = type.indexb(j2).lm;
+                int idxrf2 = type.indexb(j2).idxrf;
+                for (int j1 = 0; j1 <= j2; j1++) {
+                    int lm1    = type.indexb(j1).lm;
+                    int idxrf1 = type.indexb(j1).idxrf;
+                    hmt_[ia](j1, j2) = atom.radial_integrals_sum_L3<spin_block_t::nm>(idxrf1, idxrf2,
+                                                                            type.gaunt_coefs().gaunt_vector(lm1, lm2));
+                    hmt_[ia](j2, j1) = std::conj(hmt_[ia](j1, j2));
                 }
             }
             if (pu == sddk::device_t::GPU) {
-                acc::sync_stream(stream_id(tid));
+                if (!hmt_[ia].on_device()) {
+                    hmt_[ia].allocate(sddk::memory_t::device);
+                }
+                hmt_[ia].copy_to(sddk::memory_t::device, stream_id(tid));
             }
         }
+        if (pu == sddk::device_t::GPU) {
+            acc::sync_stream(stream_id(tid));
+        }
     }
 }
 
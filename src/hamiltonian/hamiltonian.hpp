@@ -94,6 +94,9 @@ class Hamiltonian0
 
     std::vector<sddk::mdarray<std::complex<T>, 2>> hmt_;
 
+    /// Compute the muffin-tin part of the LAPW Hamiltonian from the current radial integrals.
+    void generate_hmt();
+
     /* copy constructor is forbidden */
     Hamiltonian0(Hamiltonian0<T> const& src) = delete;
     /* copy assignment operator is forbidden */
@@ -105,6 +108,16 @@ class Hamiltonian0
 
     ~Hamiltonian0();
 
+    /// Update the potential-dependent part of the Hamiltonian in place.
+    /** Coarse-grid effective potential, D-operator and (in the LAPW case) the muffin-tin Hamiltonian are
+     *  refreshed from the current state of the potential. All buffers, device allocations and G-vector
+     *  mappings set up by the constructor are reused, so a single instance can be kept across SCF iterations.
+     *
+     *  \param [in] precompute_lapw  Recompute the LAPW radial functions and integrals (same meaning as in the
+     *                               constructor).
+     */
+    void update(bool precompute_lapw__);
+
     /// Default move constructor.
     Hamiltonian0(Hamiltonian0<T>&& src) = default;
 
@@ -451,11 +464,15 @@ class Hamiltonian_k
     //               sddk::Wave_functions<T>* hphi__, sddk::Wave_functions<T>* sphi__);
 
     /** \tparam F  Type of the subspace matrix.
+     *
+     *  Optional real-space wave-functions phi_rg are reused by the local Hamiltonian instead of the backward FFT;
+     *  the caller guarantees that they were computed from phi.
      */
     template <typename F>
     std::enable_if_t<std::is_same<T, real_type<F>>::value, void>
     apply_h_s(wf::spin_range spins__, wf::band_range br__, wf::Wave_functions<T> const& phi__,
-              wf::Wave_functions<T>* hphi__, wf::Wave_functions<T>* sphi__)
+              wf::Wave_functions<T>* hphi__, wf::Wave_functions<T>* sphi__,
+              wf::Wave_functions_rg_cache<T> const* phi_rg__ = nullptr)
     {
         PROFILE("sirius::Hamiltonian_k::apply_h_s");
 
@@ -464,7 +481,7 @@ class Hamiltonian_k
         if (hphi__ != nullptr) {
             /* apply local part of Hamiltonian */
             H0().local_op().apply_h(reinterpret_cast<fft::spfft_transform_type<T>&>(kp().spfft_transform()),
-                                    kp().gkvec_fft_sptr(), spins__, phi__, *hphi__, br__);
+                                    kp().gkvec_fft_sptr(), spins__, phi__, *hphi__, br__, phi_rg__);
         }
 
         auto mem = H0().ctx().processing_unit_memory_t();
@@ -492,9 +509,9 @@ class Hamiltonian_k
         }
 
         /* apply the hubbard potential if relevant */
-        if (H0().ctx().hubbard_correction() && !H0().ctx().gamma_point() && hphi__) {
+        if (H0().ctx().hubbard_correction() && hphi__) {
             /* apply the hubbard potential */
-            apply_U_operator(H0().ctx(), spins__, br__, kp().hubbard_wave_functions_S(), phi__, this->U(), *hphi__);
+            apply_U_operator<T, F>(H0().ctx(), spins__, br__, kp().hubbard_wave_functions_S(), phi__, this->U(), *hphi__);
         }
 
         if (pcs) {
@@ -72,102 +72,140 @@ Local_operator<T>::Local_operator(Simulation_context const& ctx__, fft::spfft_tr
 
     /* map potential */
     if (potential__) {
+        this->update(*potential__);
+    }
+
+    buf_rg_ = sddk::mdarray<std::complex<T>, 1>(fft_coarse_.local_slice_size(), get_memory_pool(sddk::memory_t::host),
+                                         "Local_operator::buf_rg_");
+    /* move functions to GPU */
+    if (fft_coarse_.processing_unit() == SPFFT_PU_GPU) {
+        for (int j = 0; j < 6; j++) {
+            if (veff_vec_[j]) {
+                veff_vec_[j]->values().allocate(get_memory_pool(sddk::memory_t::device)).copy_to(sddk::memory_t::device);
+            }
+        }
+        buf_rg_.allocate(get_memory_pool(sddk::memory_t::device));
+    }
+}
+
+template <typename T>
+void Local_operator<T>::update(Potential& potential__)
+{
+    PROFILE("sirius::Local_operator::update");
+
+    if (ctx_.full_potential()) {
 
-        if (ctx_.full_potential()) {
+        auto& fft_dense    = ctx_.spfft<T>();
+        auto& gvec_dense_p = ctx_.gvec_fft();
 
-            auto& fft_dense    = ctx_.spfft<T>();
-            auto& gvec_dense_p = ctx_.gvec_fft();
+        /* plane-wave coefficients of Theta(r) * V_j(r) are taken from the potential if they are up to date;
+         * in this case only the backward transformation on the coarse grid is needed */
+        bool use_theta_veff = potential__.theta_veff_valid();
 
-            Smooth_periodic_function<T> ftmp(ctx_.spfft<T>(), ctx_.gvec_fft_sptr());
+        std::unique_ptr<Smooth_periodic_function<T>> ftmp;
+        if (!use_theta_veff) {
+            ftmp = std::make_unique<Smooth_periodic_function<T>>(ctx_.spfft<T>(), ctx_.gvec_fft_sptr());
+        }
 
-            for (int j = 0; j < ctx_.num_mag_dims() + 1; j++) {
+        for (int j = 0; j < ctx_.num_mag_dims() + 1; j++) {
+            if (use_theta_veff) {
+                auto& f = potential__.theta_veff(j);
+                if (j == 0) {
+                    v0_[0] = f.f_0().real();
+                }
+                /* loop over local set of coarse G-vectors */
+                #pragma omp parallel for schedule(static)
+                for (int igloc = 0; igloc < gvec_coarse_p_->gvec().count(); igloc++) {
+                    /* map from fine to coarse set of G-vectors */
+                    veff_vec_[j]->f_pw_local(igloc) = f.f_pw_local(gvec_dense_p.gvec().gvec_base_mapping(igloc));
+                }
+            } else {
                 /* multiply potential by step function theta(r) */
                 for (int ir = 0; ir < fft_dense.local_slice_size(); ir++) {
-                    ftmp.value(ir) = potential__->component(j).rg().value(ir) * ctx_.theta(ir);
+                    ftmp->value(ir) = potential__.component(j).rg().value(ir) * ctx_.theta(ir);
                 }
                 /* transform to plane-wave domain */
-                ftmp.fft_transform(-1);
+                ftmp->fft_transform(-1);
                 if (j == 0) {
-                    v0_[0] = ftmp.f_0().real();
+                    v0_[0] = ftmp->f_0().real();
                 }
                 /* loop over local set of coarse G-vectors */
                 #pragma omp parallel for schedule(static)
                 for (int igloc = 0; igloc < gvec_coarse_p_->gvec().count(); igloc++) {
                     /* map from fine to coarse set of G-vectors */
-                    veff_vec_[j]->f_pw_local(igloc) = ftmp.f_pw_local(gvec_dense_p.gvec().gvec_base_mapping(igloc));
+                    veff_vec_[j]->f_pw_local(igloc) = ftmp->f_pw_local(gvec_dense_p.gvec().gvec_base_mapping(igloc));
                 }
-                /* transform to real space */
-                veff_vec_[j]->fft_transform(1);
             }
-            if (ctx_.valence_relativity() == relativity_t::zora) {
+            /* transform to real space */
+            veff_vec_[j]->fft_transform(1);
+        }
+        if (ctx_.valence_relativity() == relativity_t::zora) {
+            if (!veff_vec_[v_local_index_t::rm_inv]) {
                 veff_vec_[v_local_index_t::rm_inv] = std::make_unique<Smooth_periodic_function<T>>(
-                        fft_coarse__, gvec_coarse_p__);
-                /* loop over local set of coarse G-vectors */
-                #pragma omp parallel for schedule(static)
-                for (int igloc = 0; igloc < gvec_coarse_p_->gvec().count(); igloc++) {
-                    /* map from fine to coarse set of G-vectors */
-                    veff_vec_[v_local_index_t::rm_inv]->f_pw_local(igloc) =
-                        potential__->rm_inv_pw(gvec_dense_p.gvec().offset() + gvec_dense_p.gvec().gvec_base_mapping(igloc));
-                }
-                /* transform to real space */
-                veff_vec_[v_local_index_t::rm_inv]->fft_transform(1);
+                        fft_coarse_, gvec_coarse_p_);
+            }
+            /* loop over local set of coarse G-vectors */
+            #pragma omp parallel for schedule(static)
+            for (int igloc = 0; igloc < gvec_coarse_p_->gvec().count(); igloc++) {
+                /* map from fine to coarse set of G-vectors */
+                veff_vec_[v_local_index_t::rm_inv]->f_pw_local(igloc) =
+                    potential__.rm_inv_pw(gvec_dense_p.gvec().offset() + gvec_dense_p.gvec().gvec_base_mapping(igloc));
             }
+            /* transform to real space */
+            veff_vec_[v_local_index_t::rm_inv]->fft_transform(1);
+        }
 
-        } else {
+    } else {
 
-            for (int j = 0; j < ctx_.num_mag_dims() + 1; j++) {
-                /* loop over local set of coarse G-vectors */
-                #pragma omp parallel for schedule(static)
-                for (int igloc = 0; igloc < gvec_coarse_p_->gvec().count(); igloc++) {
-                    /* map from fine to coarse set of G-vectors */
-                    veff_vec_[j]->f_pw_local(igloc) =
-                        potential__->component(j).rg().f_pw_local(potential__->component(j).rg().gvec().gvec_base_mapping(igloc));
-                }
-                /* transform to real space */
-                veff_vec_[j]->fft_transform(1);
+        for (int j = 0; j < ctx_.num_mag_dims() + 1; j++) {
+            /* loop over local set of coarse G-vectors */
+            #pragma omp parallel for schedule(static)
+            for (int igloc = 0; igloc < gvec_coarse_p_->gvec().count(); igloc++) {
+                /* map from fine to coarse set of G-vectors */
+                veff_vec_[j]->f_pw_local(igloc) =
+                    potential__.component(j).rg().f_pw_local(potential__.component(j).rg().gvec().gvec_base_mapping(igloc));
             }
+            /* transform to real space */
+            veff_vec_[j]->fft_transform(1);
+        }
 
-            /* change to canonical form */
-            if (ctx_.num_mag_dims()) {
-                #pragma omp parallel for schedule(static)
-                for (int ir = 0; ir < fft_coarse_.local_slice_size(); ir++) {
-                    T v0             = veff_vec_[v_local_index_t::v0]->value(ir);
-                    T v1             = veff_vec_[v_local_index_t::v1]->value(ir);
-                    veff_vec_[v_local_index_t::v0]->value(ir) = v0 + v1; // v + Bz
-                    veff_vec_[v_local_index_t::v1]->value(ir) = v0 - v1; // v - Bz
-                }
+        /* change to canonical form */
+        if (ctx_.num_mag_dims()) {
+            #pragma omp parallel for schedule(static)
+            for (int ir = 0; ir < fft_coarse_.local_slice_size(); ir++) {
+                T v0             = veff_vec_[v_local_index_t::v0]->value(ir);
+                T v1             = veff_vec_[v_local_index_t::v1]->value(ir);
+                veff_vec_[v_local_index_t::v0]->value(ir) = v0 + v1; // v + Bz
+                veff_vec_[v_local_index_t::v1]->value(ir) = v0 - v1; // v - Bz
             }
+        }
 
-            if (ctx_.num_mag_dims() == 0) {
-                v0_[0] = potential__->component(0).rg().f_0().real();
-            } else {
-                v0_[0] = potential__->component(0).rg().f_0().real() +
-                         potential__->component(1).rg().f_0().real();
-                v0_[1] = potential__->component(0).rg().f_0().real() -
-                         potential__->component(1).rg().f_0().real();
-            }
+        if (ctx_.num_mag_dims() == 0) {
+            v0_[0] = potential__.component(0).rg().f_0().real();
+        } else {
+            v0_[0] = potential__.component(0).rg().f_0().real() +
+                     potential__.component(1).rg().f_0().real();
+            v0_[1] = potential__.component(0).rg().f_0().real() -
+                     potential__.component(1).rg().f_0().real();
         }
+    }
 
-        if (ctx_.print_checksum()) {
-            for (int j = 0; j < ctx_.num_mag_dims() + 1; j++) {
-                auto cs1 = veff_vec_[j]->checksum_pw();
-                auto cs2 = veff_vec_[j]->checksum_rg();
-                utils::print_checksum("veff_pw", cs1, ctx_.out());
-                utils::print_checksum("veff_rg", cs2, ctx_.out());
-            }
+    if (ctx_.print_checksum()) {
+        for (int j = 0; j < ctx_.num_mag_dims() + 1; j++) {
+            auto cs1 = veff_vec_[j]->checksum_pw();
+            auto cs2 = veff_vec_[j]->checksum_rg();
+            utils::print_checksum("veff_pw", cs1, ctx_.out());
+            utils::print_checksum("veff_rg", cs2, ctx_.out());
         }
     }
 
-    buf_rg_ = sddk::mdarray<std::complex<T>, 1>(fft_coarse_.local_slice_size(), get_memory_pool(sddk::memory_t::host),
-                                         "Local_operator::buf_rg_");
-    /* move functions to GPU */
+    /* refresh the device copy; the memory is allocated once by the constructor */
     if (fft_coarse_.processing_unit() == SPFFT_PU_GPU) {
         for (int j = 0; j < 6; j++) {
-            if (veff_vec_[j]) {
-                veff_vec_[j]->values().allocate(get_memory_pool(sddk::memory_t::device)).copy_to(sddk::memory_t::device);
+            if (veff_vec_[j] && j != v_local_index_t::theta && veff_vec_[j]->values().on_device()) {
+                veff_vec_[j]->values().copy_to(sddk::memory_t::device);
             }
         }
-        buf_rg_.allocate(get_memory_pool(sddk::memory_t::device));
     }
 }
 
@@ -279,7 +317,8 @@ mul_by_veff(fft::spfft_transform_type<T>& spfftk__, T const* in__,
 template <typename T>
 void
 Local_operator<T>::apply_h(fft::spfft_transform_type<T>& spfftk__, std::shared_ptr<fft::Gvec_fft> gkvec_fft__,
-    wf::spin_range spins__, wf::Wave_functions<T> const& phi__, wf::Wave_functions<T>& hphi__, wf::band_range br__)
+    wf::spin_range spins__, wf::Wave_functions<T> const& phi__, wf::Wave_functions<T>& hphi__, wf::band_range br__,
+    wf::Wave_functions_rg_cache<T> const* phi_rg__)
 {
     PROFILE("sirius::Local_operator::apply_h");
 
@@ -321,11 +360,28 @@ Local_operator<T>::apply_h(fft::spfft_transform_type<T>& spfftk__, std::shared_p
     /* pointer to FFT buffer */
     auto spfft_buf = spfftk__.space_domain_data(spfft_pu);
 
+    /* number of real values in the local part of FFT buffer */
+    int nr_val = (spfftk__.type() == SPFFT_TRANS_R2C) ? nr : 2 * nr;
+
+    /* real-space wave-functions are stored only on the host */
+    if (spfft_pu != SPFFT_PU_HOST || (phi_rg__ && phi_rg__->empty())) {
+        phi_rg__ = nullptr;
+    }
+
     /* transform wave-function to real space; the result of the transformation is stored in the FFT buffer */
     auto phi_to_r = [&](wf::spin_index ispn,  wf::band_index i) {
         PROFILE("phi_to_r");
         auto phi_mem = phi_fft[ispn.get()].on_device() ? sddk::memory_t::device : sddk::memory_t::host;
-        spfftk__.backward(phi_fft[ispn.get()].pw_coeffs_spfft(phi_mem, i), spfft_pu);
+        auto phi_pw  = phi_fft[ispn.get()].pw_coeffs_spfft(phi_mem, i);
+        /* try to reuse the stored real-space wave-function */
+        if (phi_rg__) {
+            auto ptr = phi_rg__->find(ispn, wf::band_index(br__.begin() + spl_num_wf[i.get()]));
+            if (ptr) {
+                std::copy(ptr, ptr + nr_val, spfft_buf);
+                return;
+            }
+        }
+        spfftk__.backward(phi_pw, spfft_pu);
     };
 
     /* transform function to PW domain */
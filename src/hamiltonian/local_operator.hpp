@@ -43,6 +43,8 @@ class Gvec_fft;
 namespace wf {
 template <typename T>
 class Wave_functions;
+template <typename T>
+class Wave_functions_rg_cache;
 class band_range;
 class spin_range;
 }
@@ -269,6 +271,11 @@ class Local_operator
     Local_operator(Simulation_context const& ctx__, fft::spfft_transform_type<T>& fft_coarse__,
                    std::shared_ptr<fft::Gvec_fft> gvec_coarse_fft__, Potential* potential__ = nullptr);
 
+    /// Map the new effective potential to the coarse FFT grid.
+    /** All arrays (including the device copies) allocated by the constructor are reused; only the values of the
+     *  potential-dependent fields are refreshed. Unit-step function is not touched. */
+    void update(Potential& potential__);
+
     /// Prepare the k-point dependent arrays.
     /** \param [in] gkvec_p  FFT-friendly G+k vector partitioning. */
     void prepare_k(fft::Gvec_fft const& gkvec_p__);
@@ -281,6 +288,8 @@ class Local_operator
      *  \param [out] hphi    Local hamiltonian applied to wave-function.
      *  \param [in]  idx0    Starting index of wave-functions.
      *  \param [in]  n       Number of wave-functions to which H is applied.
+     *  \param [in]  phi_rg  Optional storage of real-space wave-functions which are used instead of the
+     *                       backward FFT; the caller guarantees that they were computed from phi.
      *
      *  Spin range can take the following values:
      *    - [0, 0]: apply H_{uu} to the up- component of wave-functions
@@ -291,7 +300,7 @@ class Local_operator
      */
     void apply_h(fft::spfft_transform_type<T>& spfftk__, std::shared_ptr<fft::Gvec_fft> gkvec_fft__,
             wf::spin_range spins__, wf::Wave_functions<T> const& phi__, wf::Wave_functions<T>& hphi__,
-            wf::band_range br__);
+            wf::band_range br__, wf::Wave_functions_rg_cache<T> const* phi_rg__ = nullptr);
 
     /// Apply local part of LAPW Hamiltonian and overlap operators.
     /** \param [in]  spfftk  SpFFT transform object for G+k vectors.
@@ -226,7 +226,10 @@ D_operator<T>::initialize()
     }
 
     if (this->pu_ == sddk::device_t::GPU && uc.mt_lo_basis_size() != 0) {
-        this->op_.allocate(sddk::memory_t::device).copy_to(sddk::memory_t::device);
+        if (!this->op_.on_device()) {
+            this->op_.allocate(sddk::memory_t::device);
+        }
+        this->op_.copy_to(sddk::memory_t::device);
     }
 
     /* D-operator is not diagonal in spin in case of non-collinear magnetism
@@ -25,6 +25,7 @@
 #ifndef __NON_LOCAL_OPERATOR_HPP__
 #define __NON_LOCAL_OPERATOR_HPP__
 
+#include <map>
 #include "SDDK/omp.hpp"
 #include "SDDK/memory.hpp"
 #include "beta_projectors/beta_projectors.hpp"
@@ -158,8 +159,10 @@ class Non_local_operator
     }
 
     /// Apply beta projectors from one atom in a chunk of beta projectors to all wave-functions.
+    /** \tparam F  Type of the subspace matrix
+     */
     template <typename F>
-    std::enable_if_t<std::is_same<std::complex<T>, F>::value, void>
+    void
     apply(sddk::memory_t mem__, int chunk__, wf::atom_index ia__, int ispn_block__, wf::Wave_functions<T>& op_phi__,
             wf::band_range br__, Beta_projectors_base<T>& beta__, sddk::matrix<F>& beta_phi__)
     {
@@ -185,20 +188,27 @@ class Non_local_operator
             pu = sddk::device_t::GPU;
         }
 
-        auto work = sddk::mdarray<std::complex<T>, 1>(nbf * br__.size(), get_memory_pool(mem__));
+        /* in the Gamma-point case complex coefficients are treated as a doubled list of real values */
+        int size_factor = 1;
+        if (std::is_same<F, real_type<F>>::value) {
+            size_factor = 2;
+        }
+
+        auto work = sddk::mdarray<F, 1>(nbf * br__.size(), get_memory_pool(mem__));
 
-        la::wrap(la).gemm('N', 'N', nbf, br__.size(), nbf, &la::constant<std::complex<T>>::one(),
-                        reinterpret_cast<std::complex<T>*>(op_.at(mem__, 0, packed_mtrx_offset_(ia), ispn_block__)), nbf,
-                        beta_phi__.at(mem__, offs, 0), beta_phi__.ld(), &la::constant<std::complex<T>>::zero(),
+        la::wrap(la).gemm('N', 'N', nbf, br__.size(), nbf, &la::constant<F>::one(),
+                        reinterpret_cast<F const*>(op_.at(mem__, 0, packed_mtrx_offset_(ia), ispn_block__)), nbf,
+                        beta_phi__.at(mem__, offs, 0), beta_phi__.ld(), &la::constant<F>::zero(),
                         work.at(mem__), nbf);
 
         int jspn = ispn_block__ & 1;
 
         la::wrap(la)
-            .gemm('N', 'N', num_gkvec_loc, br__.size(), nbf, &la::constant<std::complex<T>>::one(),
-                    beta_gk.at(mem__, 0, offs), num_gkvec_loc, work.at(mem__), nbf, &la::constant<std::complex<T>>::one(),
-                  op_phi__.at(mem__, 0, wf::spin_index(jspn), wf::band_index(br__.begin())),
-                  op_phi__.ld());
+            .gemm('N', 'N', num_gkvec_loc * size_factor, br__.size(), nbf, &la::constant<F>::one(),
+                  reinterpret_cast<F const*>(beta_gk.at(mem__, 0, offs)), num_gkvec_loc * size_factor,
+                  work.at(mem__), nbf, &la::constant<F>::one(),
+                  reinterpret_cast<F*>(op_phi__.at(mem__, 0, wf::spin_index(jspn), wf::band_index(br__.begin()))),
+                  op_phi__.ld() * size_factor);
 
         switch (pu) {
             case sddk::device_t::CPU: {
@@ -248,6 +258,12 @@ class D_operator : public Non_local_operator<T>
 
   public:
     D_operator(Simulation_context const& ctx_);
+
+    /// Refresh the operator from the current D-matrices of the atoms without reallocating the storage.
+    void update()
+    {
+        initialize();
+    }
 };
 
 template <typename T>
@@ -260,18 +276,76 @@ class Q_operator : public Non_local_operator<T>
     Q_operator(Simulation_context const& ctx__);
 };
 
+/// Hubbard potential in the basis of the Hubbard orbitals.
+/** The operator is stored in a block-sparse form: there is one dense (2l+1) x (2l+1) block per atomic level
+ *  (the on-site part) and one (2l_1+1) x (2l_2+1) block per distinct pair of atomic levels coupled by the
+ *  inter-site V correction. The storage and the cost of the application scale linearly with the number of
+ *  Hubbard atoms instead of quadratically as for the dense nhwf x nhwf matrix.
+ */
 template <typename T>
 class U_operator
 {
+  public:
+    /// Descriptor of a dense block of the U-operator.
+    struct block_descriptor
+    {
+        /// Offset of the block row in the list of Hubbard orbitals.
+        int row_offset;
+        /// Offset of the block column in the list of Hubbard orbitals.
+        int col_offset;
+        /// Number of rows in the block.
+        int nrow;
+        /// Number of columns in the block.
+        int ncol;
+        /// Offset of the block in the packed storage.
+        int offset;
+        /// True if this is an on-site block.
+        bool local;
+    };
+
   private:
     Simulation_context const& ctx_;
-    //sddk::mdarray<std::complex<T>, 3> um_;
-    std::array<la::dmatrix<std::complex<T>>, 4> um_;
+    /// List of non-zero blocks.
+    std::vector<block_descriptor> blocks_;
+    /// Indices of the blocks grouped by the row offset.
+    /** Blocks in one group update the same rows of the result and are applied sequentially by one thread. */
+    std::vector<std::vector<int>> row_groups_;
+    /// Index of the block (col_offset, row_offset) for each block (row_offset, col_offset) or -1 if it is absent.
+    /** In the non-collinear case the transposed blocks are applied to the wave-functions. */
+    std::vector<int> partner_;
+    /// Packed values of the blocks for each spin component.
+    sddk::mdarray<std::complex<T>, 2> um_;
+    /// Real part of the packed blocks used in the Gamma-point case.
+    sddk::mdarray<T, 2> um_gamma_;
     std::vector<int> offset_;
     std::vector<std::pair<int, int>> atomic_orbitals_;
     int nhwf_;
     r3::vector<double> vk_;
 
+    /// Maximum deviation of the block-sparse operator from the hermitian one.
+    T check_hermitian(int j__) const
+    {
+        std::map<std::pair<int, int>, int> idx;
+        for (int ib = 0; ib < static_cast<int>(blocks_.size()); ib++) {
+            idx[std::make_pair(blocks_[ib].row_offset, blocks_[ib].col_offset)] = ib;
+        }
+        T diff{0};
+        for (auto const& b : blocks_) {
+            auto it = idx.find(std::make_pair(b.col_offset, b.row_offset));
+            for (int m2 = 0; m2 < b.ncol; m2++) {
+                for (int m1 = 0; m1 < b.nrow; m1++) {
+                    auto z = um_(b.offset + m2 * b.nrow + m1, j__);
+                    if (it != idx.end()) {
+                        auto const& bt = blocks_[it->second];
+                        z -= std::conj(um_(bt.offset + m1 * bt.nrow + m2, j__));
+                    }
+                    diff = std::max(diff, std::abs(z));
+                }
+            }
+        }
+        return diff;
+    }
+
   public:
     U_operator(Simulation_context const& ctx__, Hubbard_matrix const& um1__, std::array<double, 3> vk__)
         : ctx_(ctx__)
@@ -285,24 +359,53 @@ class U_operator
         this->nhwf_            = r.first;
         this->offset_          = um1__.offset();
         this->atomic_orbitals_ = um1__.atomic_orbitals();
-        for (int j = 0; j <  ctx_.num_mag_dims() + 1; j++) {
-            um_[j] = la::dmatrix<std::complex<T>>(r.first, r.first);
-            um_[j].zero();
-        }
 
-        /* copy local blocks */
+        /* (row, column) atomic levels -> block index */
+        std::map<std::pair<int, int>, int> block_idx;
+        int size{0};
+        auto add_block = [&](int at1_lvl, int at2_lvl, int nrow, int ncol, bool local)
+        {
+            auto key = std::make_pair(at1_lvl, at2_lvl);
+            if (!block_idx.count(key)) {
+                block_idx[key] = static_cast<int>(blocks_.size());
+                blocks_.push_back({um1__.offset(at1_lvl), um1__.offset(at2_lvl), nrow, ncol, size, local});
+                size += nrow * ncol;
+            }
+            return block_idx[key];
+        };
+
+        /* on-site blocks */
         for (int at_lvl = 0; at_lvl < static_cast<int>(um1__.atomic_orbitals().size()); at_lvl++) {
             const int ia    = um1__.atomic_orbitals(at_lvl).first;
             auto& atom_type = ctx_.unit_cell().atom(ia).type();
             int lo_ind      = um1__.atomic_orbitals(at_lvl).second;
             if (atom_type.lo_descriptor_hub(lo_ind).use_for_calculation()) {
                 int lmmax_at = 2 * atom_type.lo_descriptor_hub(lo_ind).l() + 1;
-                for (int j = 0; j < ctx_.num_mag_dims() + 1; j++) {
-                    for (int m2 = 0; m2 < lmmax_at; m2++) {
-                        for (int m1 = 0; m1 < lmmax_at; m1++) {
-                            um_[j](um1__.offset(at_lvl) + m1, um1__.offset(at_lvl) + m2) =
-                                um1__.local(at_lvl)(m1, m2, j);
-                        }
+                add_block(at_lvl, at_lvl, lmmax_at, lmmax_at, true);
+            }
+        }
+        /* inter-site blocks; several translations of the same pair of levels are accumulated in one block */
+        for (int i = 0; i < ctx_.cfg().hubbard().nonlocal().size(); i++) {
+            auto nl = ctx_.cfg().hubbard().nonlocal(i);
+            int at1_lvl = um1__.find_orbital_index(nl.atom_pair()[0], nl.n()[0], nl.l()[0]);
+            int at2_lvl = um1__.find_orbital_index(nl.atom_pair()[1], nl.n()[1], nl.l()[1]);
+            add_block(at1_lvl, at2_lvl, 2 * nl.l()[0] + 1, 2 * nl.l()[1] + 1, false);
+        }
+
+        um_ = sddk::mdarray<std::complex<T>, 2>(std::max(size, 1), ctx_.num_mag_dims() + 1);
+        um_.zero();
+
+        /* copy local blocks */
+        for (int at_lvl = 0; at_lvl < static_cast<int>(um1__.atomic_orbitals().size()); at_lvl++) {
+            auto it = block_idx.find(std::make_pair(at_lvl, at_lvl));
+            if (it == block_idx.end() || !blocks_[it->second].local) {
+                continue;
+            }
+            auto const& b = blocks_[it->second];
+            for (int j = 0; j < ctx_.num_mag_dims() + 1; j++) {
+                for (int m2 = 0; m2 < b.ncol; m2++) {
+                    for (int m1 = 0; m1 < b.nrow; m1++) {
+                        um_(b.offset + m2 * b.nrow + m1, j) = um1__.local(at_lvl)(m1, m2, j);
                     }
                 }
             }
@@ -320,26 +423,63 @@ class U_operator
             int at1_lvl = um1__.find_orbital_index(ia, nl.n()[0], il);
             int at2_lvl = um1__.find_orbital_index(ja, nl.n()[1], jl);
 
+            auto const& b = blocks_[block_idx[std::make_pair(at1_lvl, at2_lvl)]];
+
             auto z1 = std::exp(std::complex<double>(0, twopi * dot(vk_, r3::vector<int>(Tr))));
-            for (int is = 0; is < ctx_.num_spins(); is++) {
-                for (int m1 = 0; m1 < 2 * il + 1; m1++) {
-                    for (int m2 = 0; m2 < 2 * jl + 1; m2++) {
-                        um_[is](um1__.offset(at1_lvl) + m1, um1__.offset(at2_lvl) + m2) +=
-                            z1 * um1__.nonlocal(i)(m1, m2, is);
+            for (int j = 0; j < ctx_.num_mag_dims() + 1; j++) {
+                for (int m2 = 0; m2 < 2 * jl + 1; m2++) {
+                    for (int m1 = 0; m1 < 2 * il + 1; m1++) {
+                        um_(b.offset + m2 * b.nrow + m1, j) +=
+                            static_cast<std::complex<T>>(z1 * um1__.nonlocal(i)(m1, m2, j));
                     }
                 }
             }
         }
+
+        /* group blocks by rows */
+        std::map<int, int> row_idx;
+        for (int ib = 0; ib < static_cast<int>(blocks_.size()); ib++) {
+            int r = blocks_[ib].row_offset;
+            if (!row_idx.count(r)) {
+                row_idx[r] = static_cast<int>(row_groups_.size());
+                row_groups_.push_back(std::vector<int>());
+            }
+            row_groups_[row_idx[r]].push_back(ib);
+        }
+        partner_ = std::vector<int>(blocks_.size(), -1);
+        for (auto const& e : block_idx) {
+            auto it = block_idx.find(std::make_pair(e.first.second, e.first.first));
+            if (it != block_idx.end()) {
+                partner_[e.second] = it->second;
+            }
+        }
+
         for (int is = 0; is < ctx_.num_spins(); is++) {
-            auto diff = check_hermitian(um_[is], r.first);
+            auto diff = check_hermitian(is);
             if (diff > 1e-10) {
                 RTE_THROW("um is not Hermitian");
             }
             if (ctx_.print_checksum()) {
-                utils::print_checksum("um" + std::to_string(is), um_[is].checksum(r.first, r.first), RTE_OUT(ctx_.out()));
+                std::complex<T> cs{0};
+                for (int i = 0; i < size; i++) {
+                    cs += um_(i, is);
+                }
+                utils::print_checksum("um" + std::to_string(is), cs, RTE_OUT(ctx_.out()));
             }
-            if (ctx_.processing_unit() == sddk::device_t::GPU) {
-                um_[is].allocate(get_memory_pool(sddk::memory_t::device)).copy_to(sddk::memory_t::device);
+        }
+        /* at Gamma point the Hubbard orbitals are real and so is the U-operator */
+        if (ctx_.gamma_point()) {
+            um_gamma_ = sddk::mdarray<T, 2>(um_.size(0), um_.size(1));
+            for (int j = 0; j < static_cast<int>(um_.size(1)); j++) {
+                for (int i = 0; i < static_cast<int>(um_.size(0)); i++) {
+                    um_gamma_(i, j) = um_(i, j).real();
+                }
+            }
+        }
+        if (ctx_.processing_unit() == sddk::device_t::GPU) {
+            um_.allocate(get_memory_pool(sddk::memory_t::device)).copy_to(sddk::memory_t::device);
+            if (ctx_.gamma_point()) {
+                um_gamma_.allocate(get_memory_pool(sddk::memory_t::device)).copy_to(sddk::memory_t::device);
             }
         }
     }
@@ -367,14 +507,47 @@ class U_operator
         return offset_[ia__];
     }
 
-    auto operator()(int m1, int m2, int j)
+    inline auto const& blocks() const
+    {
+        return blocks_;
+    }
+
+    inline auto const& block(int ib__) const
+    {
+        return blocks_[ib__];
+    }
+
+    inline auto const& row_groups() const
     {
-        return um_[j](m1, m2);
+        return row_groups_;
     }
 
-    auto* at(sddk::memory_t mem__, const int idx1, const int idx2, const int idx3)
+    /// Index of the transposed block or -1 if it does not exist.
+    inline int partner(int ib__) const
+    {
+        return partner_[ib__];
+    }
+
+    /// Return element (m1, m2) of the block ib for the spin component j.
+    auto operator()(int ib__, int m1__, int m2__, int j__) const
+    {
+        return um_(blocks_[ib__].offset + m2__ * blocks_[ib__].nrow + m1__, j__);
+    }
+
+    /// Pointer to the first element of the block ib for the spin component j.
+    template <typename F>
+    std::enable_if_t<!std::is_same<F, real_type<F>>::value, F const*>
+    at(sddk::memory_t mem__, int ib__, int j__) const
     {
-        return um_[idx3].at(mem__, idx1, idx2);
+        return um_.at(mem__, blocks_[ib__].offset, j__);
+    }
+
+    /// Pointer to the first element of the real-valued block ib for the spin component j (Gamma-point case).
+    template <typename F>
+    std::enable_if_t<std::is_same<F, real_type<F>>::value, F const*>
+    at(sddk::memory_t mem__, int ib__, int j__) const
+    {
+        return um_gamma_.at(mem__, blocks_[ib__].offset, j__);
     }
 
     const int find_orbital_index(const int ia__, const int n__, const int l__) const
@@ -501,13 +674,14 @@ void apply_S_operator(sddk::memory_t mem__, wf::spin_range spins__, wf::band_ran
     }
 }
 
-/** Apply Hubbard U correction 
+/** Apply Hubbard U correction
  * \tparam T  Precision type of wave-functions (flat or double).
+ * \tparam F  Type of the subspace (real for the Gamma-point calculation, complex otherwise).
  * \param [in]  hub_wf   Hubbard atomic wave-functions.
  * \param [in]  phi      Set of wave-functions to which Hubbard correction is applied.
  * \param [out] hphi     Output wave-functions to which the result is added.
  */
-template <typename T>
+template <typename T, typename F>
 void
 apply_U_operator(Simulation_context& ctx__, wf::spin_range spins__, wf::band_range br__,
         wf::Wave_functions<T> const& hub_wf__, wf::Wave_functions<T> const& phi__, U_operator<T>& um__,
@@ -517,7 +691,12 @@ apply_U_operator(Simulation_context& ctx__, wf::spin_range spins__, wf::band_ran
         return;
     }
 
-    la::dmatrix<std::complex<T>> dm(hub_wf__.num_wf().get(), br__.size());
+    /* Hubbard orbitals are scalar functions; in the non-collinear case the projections of both spin components
+     * are stored one after another */
+    int nhwf = hub_wf__.num_wf().get();
+    int nso  = (ctx__.num_mag_dims() == 3) ? 2 : 1;
+
+    la::dmatrix<F> dm(nso * nhwf, br__.size());
 
     auto mt = ctx__.processing_unit_memory_t();
     auto la = la::lib_t::blas;
@@ -528,57 +707,76 @@ apply_U_operator(Simulation_context& ctx__, wf::spin_range spins__, wf::band_ran
 
     /* First calculate the local part of the projections
        dm(i, n) = <phi_i| S |psi_{nk}> */
-    wf::inner(ctx__.spla_context(), mt, spins__, hub_wf__, wf::band_range(0, hub_wf__.num_wf().get()), phi__, br__, dm, 0, 0);
+    if (nso == 2) {
+        for (auto s = spins__.begin(); s != spins__.end(); s++) {
+            wf::inner(ctx__.spla_context(), mt, wf::spin_range(s.get()), hub_wf__, wf::band_range(0, nhwf), phi__,
+                    br__, dm, s.get() * nhwf, 0);
+        }
+    } else {
+        wf::inner(ctx__.spla_context(), mt, spins__, hub_wf__, wf::band_range(0, nhwf), phi__, br__, dm, 0, 0);
+    }
 
-    la::dmatrix<std::complex<T>> Up(hub_wf__.num_wf().get(), br__.size());
+    la::dmatrix<F> Up(nso * nhwf, br__.size());
     if (is_device_memory(mt)) {
         Up.allocate(mt);
     }
 
-    if (ctx__.num_mag_dims() == 3) {
-        Up.zero();
-        #pragma omp parallel for schedule(static)
-        for (int at_lvl = 0; at_lvl < (int)um__.atomic_orbitals().size(); at_lvl++) {
-            const int ia     = um__.atomic_orbitals(at_lvl).first;
-            auto const& atom = ctx__.unit_cell().atom(ia);
-            if (atom.type().lo_descriptor_hub(um__.atomic_orbitals(at_lvl).second).use_for_calculation()) {
-                const int lmax_at = 2 * atom.type().lo_descriptor_hub(um__.atomic_orbitals(at_lvl).second).l() + 1;
-                // we apply the hubbard correction. For now I have no papers
-                // giving me the formula for the SO case so I rely on QE for it
-                // but I do not like it at all
-                for (int s1 = 0; s1 < ctx__.num_spins(); s1++) {
-                    for (int s2 = 0; s2 < ctx__.num_spins(); s2++) {
-                      // TODO: replace this with matrix matrix multiplication
-                        for (int nbd = 0; nbd < br__.size(); nbd++) {
-                            for (int m1 = 0; m1 < lmax_at; m1++) {
-                                for (int m2 = 0; m2 < lmax_at; m2++) {
-                                    const int ind = (s1 == s2) * s1 + (1 + 2 * s2 + s1) * (s1 != s2);
-                                    Up(um__.nhwf() * s1 + um__.offset(at_lvl) + m1, nbd) +=
-                                      um__(um__.offset(at_lvl) + m2, um__.offset(at_lvl) + m1, ind) *
-                                      dm(um__.nhwf() * s2 + um__.offset(at_lvl) + m2, nbd);
-                                }
-                            }
+    Up.zero(mt);
+
+    auto const& groups = um__.row_groups();
+
+    /* apply blocks of U to <phi|S|psi>; blocks in one group update the same rows of Up */
+    #pragma omp parallel
+    {
+        acc::set_device_id(mpi::get_device_id(acc::num_devices())); // avoid cuda mth bugs
+
+        #pragma omp for schedule(dynamic)
+        for (int ig = 0; ig < static_cast<int>(groups.size()); ig++) {
+            for (int ib : groups[ig]) {
+                auto const& b = um__.block(ib);
+                if (ctx__.num_mag_dims() == 3) {
+                    /* the spin blocks are applied in the transposed form; the transposed block (row, col) is
+                     * stored as the block (col, row), which is the same block for the on-site part */
+                    int ibt = um__.partner(ib);
+                    if (ibt < 0) {
+                        continue;
+                    }
+                    for (int s1 = 0; s1 < ctx__.num_spins(); s1++) {
+                        for (int s2 = 0; s2 < ctx__.num_spins(); s2++) {
+                            const int ind = (s1 == s2) * s1 + (1 + 2 * s2 + s1) * (s1 != s2);
+                            la::wrap(la).gemm('T', 'N', b.nrow, br__.size(), b.ncol,
+                                    &la::constant<F>::one(), um__.template at<F>(mt, ibt, ind), b.ncol,
+                                    dm.at(mt, nhwf * s2 + b.col_offset, 0), dm.ld(),
+                                    &la::constant<F>::one(),
+                                    Up.at(mt, nhwf * s1 + b.row_offset, 0), Up.ld(),
+                                    stream_id(omp_get_thread_num()));
                         }
                     }
+                } else {
+                    la::wrap(la).gemm('N', 'N', b.nrow, br__.size(), b.ncol,
+                            &la::constant<F>::one(), um__.template at<F>(mt, ib, spins__.begin().get()), b.nrow,
+                            dm.at(mt, b.col_offset, 0), dm.ld(), &la::constant<F>::one(),
+                            Up.at(mt, b.row_offset, 0), Up.ld(), stream_id(omp_get_thread_num()));
                 }
             }
         }
-    } else {
-        la::wrap(la).gemm('N', 'N', um__.nhwf(), br__.size(), um__.nhwf(),
-                &la::constant<std::complex<T>>::one(), um__.at(mt, 0, 0, spins__.begin().get()), um__.nhwf(),
-                dm.at(mt, 0, 0), dm.ld(), &la::constant<std::complex<T>>::zero(), Up.at(mt, 0, 0), Up.ld());
-        if (is_device_memory(mt)) {
-            Up.copy_to(sddk::memory_t::host);
-        }
+    }
+    if (is_device_memory(mt)) {
+        #pragma omp parallel
+        acc::sync_stream(stream_id(omp_get_thread_num()));
+        Up.copy_to(sddk::memory_t::host);
     }
     for (auto s = spins__.begin(); s != spins__.end(); s++) {
         auto sp = hub_wf__.actual_spin_index(s);
-        wf::transform(ctx__.spla_context(), mt, Up, 0, 0, 1.0, hub_wf__, sp, wf::band_range(0, hub_wf__.num_wf().get()),
-            1.0, hphi__, sp, br__);
+        wf::transform(ctx__.spla_context(), mt, Up, (nso == 2) ? s.get() * nhwf : 0, 0, 1.0, hub_wf__, sp,
+            wf::band_range(0, nhwf), 1.0, hphi__, hphi__.actual_spin_index(s), br__);
     }
 }
 
 /// Apply strain derivative of S-operator to all scalar functions.
+/** \tparam F  Type of the subspace (real for the Gamma-point calculation, complex otherwise).
+ */
+template <typename F>
 inline void
 apply_S_operator_strain_deriv(sddk::memory_t mem__, int comp__, Beta_projectors<double>& bp__,
                               Beta_projectors_strain_deriv<double>& bp_strain_deriv__, wf::Wave_functions<double>& phi__,
@@ -590,9 +788,9 @@ apply_S_operator_strain_deriv(sddk::memory_t mem__, int comp__, Beta_projectors<
         bp__.generate(mem__, ichunk);
         /* generate derived beta-projectors for a block of atoms */
         bp_strain_deriv__.generate(mem__, ichunk, comp__);
-        auto dbeta_phi = bp_strain_deriv__.inner<std::complex<double>>(mem__, ichunk, phi__, wf::spin_index(0),
+        auto dbeta_phi = bp_strain_deriv__.template inner<F>(mem__, ichunk, phi__, wf::spin_index(0),
                 wf::band_range(0, phi__.num_wf().get()));
-        auto beta_phi = bp__.inner<std::complex<double>>(mem__, ichunk, phi__, wf::spin_index(0), wf::band_range(0, phi__.num_wf().get()));
+        auto beta_phi = bp__.template inner<F>(mem__, ichunk, phi__, wf::spin_index(0), wf::band_range(0, phi__.num_wf().get()));
         q_op__.apply(mem__, ichunk, 0, ds_phi__, wf::band_range(0, ds_phi__.num_wf().get()), bp__, dbeta_phi);
         q_op__.apply(mem__, ichunk, 0, ds_phi__, wf::band_range(0, ds_phi__.num_wf().get()), bp_strain_deriv__, beta_phi);
     }
@@ -164,6 +164,7 @@ class Hubbard
      *    - compute \f$ \tilde X_{ij} = \frac{\Lambda_{i}^{-1/2} \tilde O_{ij}' \Lambda_{j}^{-1/2}} {\Lambda_{i}^{1/2} + \Lambda_{j}^{1/2}} \f$
      *    - compute \f$ \frac{\partial}{\partial {\bf r}_{\alpha}} {\bf O}^{-1/2} = -{\bf U}\tilde {\bf X}{\bf U}^{H} \f$
      */
+    template <typename F>
     void compute_occupancies_derivatives(K_point<double>& kp__, Q_operator<double>& q_op__,
                                          sddk::mdarray<std::complex<double>, 5>& dn__);
 
@@ -171,7 +172,10 @@ class Hubbard
     /** \param [in]  kp   K-point.
      *  \param [in]  q_op Overlap operator.
      *  \param [out] dn   Derivative of the occupation number compared to displacement of each atom.
+     *
+     *  \tparam F  Type of the subspace (real for the Gamma-point calculation, complex otherwise).
      */
+    template <typename F>
     void compute_occupancies_stress_derivatives(K_point<double>& kp__, Q_operator<double>& q_op__,
                                                 sddk::mdarray<std::complex<double>, 4>& dn__);
 
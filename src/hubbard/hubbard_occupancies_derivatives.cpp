@@ -54,13 +54,46 @@ update_density_matrix_deriv(la::lib_t la__, sddk::memory_t mt__, int nwfh__, int
                       &la::constant<std::complex<double>>::one(), dn__, ld__);
 }
 
+/* Gamma-point case: the derivative of the occupation matrix is real; it is computed in a temporary real matrix
+ * and added to the (host) complex array */
+static void
+update_density_matrix_deriv(la::lib_t la__, sddk::memory_t mt__, int nwfh__, int nbnd__, double* alpha__,
+    la::dmatrix<double> const& phi_hub_s_psi_deriv__, la::dmatrix<double> const& psi_s_phi_hub__,
+    std::complex<double>* dn__, int ld__)
+{
+    la::dmatrix<double> dn(nwfh__, nwfh__);
+    if (is_device_memory(mt__)) {
+        dn.allocate(get_memory_pool(mt__));
+    }
+
+    la::wrap(la__).gemm('N', 'N', nwfh__, nwfh__, nbnd__, alpha__,
+                      phi_hub_s_psi_deriv__.at(mt__, 0, 0), phi_hub_s_psi_deriv__.ld(),
+                      psi_s_phi_hub__.at(mt__, 0, 0), psi_s_phi_hub__.ld(),
+                      &la::constant<double>::zero(), dn.at(mt__), dn.ld());
+
+    la::wrap(la__).gemm('T', 'T', nwfh__, nwfh__, nbnd__, alpha__,
+                      psi_s_phi_hub__.at(mt__, 0, 0), psi_s_phi_hub__.ld(),
+                      phi_hub_s_psi_deriv__.at(mt__, 0, 0), phi_hub_s_psi_deriv__.ld(),
+                      &la::constant<double>::one(), dn.at(mt__), dn.ld());
+
+    if (is_device_memory(mt__)) {
+        dn.copy_to(sddk::memory_t::host);
+    }
+    for (int j = 0; j < nwfh__; j++) {
+        for (int i = 0; i < nwfh__; i++) {
+            dn__[i + j * ld__] += dn(i, j);
+        }
+    }
+}
+
+template <typename F>
 static void
 build_phi_hub_s_psi_deriv(Simulation_context const& ctx__, int nbnd__, int nawf__,
-        la::dmatrix<std::complex<double>> const& ovlp__, la::dmatrix<std::complex<double>> const& inv_sqrt_O__,
-        la::dmatrix<std::complex<double>> const& phi_atomic_s_psi__,
-        la::dmatrix<std::complex<double>> const& phi_atomic_ds_psi__,
+        la::dmatrix<F> const& ovlp__, la::dmatrix<F> const& inv_sqrt_O__,
+        la::dmatrix<F> const& phi_atomic_s_psi__,
+        la::dmatrix<F> const& phi_atomic_ds_psi__,
         std::vector<int> const& atomic_wf_offset__, std::vector<int> const& hubbard_wf_offset__,
-        la::dmatrix<std::complex<double>>& phi_hub_s_psi_deriv__)
+        la::dmatrix<F>& phi_hub_s_psi_deriv__)
 {
     phi_hub_s_psi_deriv__.zero();
 
@@ -81,17 +114,17 @@ build_phi_hub_s_psi_deriv(Simulation_context const& ctx__, int nbnd__, int nawf_
                 if (ctx__.cfg().hubbard().full_orthogonalization()) {
                     /* compute \sum_{m} d/d r_{alpha} O^{-1/2}_{m,i} <phi_atomic_{m} | S | psi_{jk} > */
                     la::wrap(la::lib_t::blas).gemm('C', 'N', mmax, nbnd__, nawf__,
-                        &la::constant<std::complex<double>>::one(),
+                        &la::constant<F>::one(),
                         ovlp__.at(sddk::memory_t::host, 0, offset_in_wf), ovlp__.ld(),
                         phi_atomic_s_psi__.at(sddk::memory_t::host), phi_atomic_s_psi__.ld(),
-                        &la::constant<std::complex<double>>::one(),
+                        &la::constant<F>::one(),
                         phi_hub_s_psi_deriv__.at(sddk::memory_t::host, offset_in_hwf, 0), phi_hub_s_psi_deriv__.ld());
 
                     la::wrap(la::lib_t::blas).gemm('C', 'N', mmax, nbnd__, nawf__,
-                        &la::constant<std::complex<double>>::one(),
+                        &la::constant<F>::one(),
                         inv_sqrt_O__.at(sddk::memory_t::host, 0, offset_in_wf), inv_sqrt_O__.ld(),
                         phi_atomic_ds_psi__.at(sddk::memory_t::host), phi_atomic_ds_psi__.ld(),
-                        &la::constant<std::complex<double>>::one(),
+                        &la::constant<F>::one(),
                         phi_hub_s_psi_deriv__.at(sddk::memory_t::host, offset_in_hwf, 0), phi_hub_s_psi_deriv__.ld());
                 } else {
                     /* just copy part of the matrix elements in the order in which
@@ -107,8 +140,9 @@ build_phi_hub_s_psi_deriv(Simulation_context const& ctx__, int nbnd__, int nawf_
     } // ia
 }
 
+template <typename F>
 static void
-compute_inv_sqrt_O_deriv(la::dmatrix<std::complex<double>>& O_deriv__, la::dmatrix<std::complex<double>>& evec_O__,
+compute_inv_sqrt_O_deriv(la::dmatrix<F>& O_deriv__, la::dmatrix<F>& evec_O__,
         std::vector<double>& eval_O__, int nawf__)
 {
     /* compute \tilde O' = U^{H}O'U */
@@ -123,6 +157,7 @@ compute_inv_sqrt_O_deriv(la::dmatrix<std::complex<double>>& O_deriv__, la::dmatr
     unitary_similarity_transform(0, O_deriv__, evec_O__, nawf__);
 }
 
+template <typename F>
 void
 Hubbard::compute_occupancies_derivatives(K_point<double>& kp__, Q_operator<double>& q_op__,
                                          sddk::mdarray<std::complex<double>, 5>& dn__)
@@ -143,7 +178,9 @@ Hubbard::compute_occupancies_derivatives(K_point<double>& kp__, Q_operator<doubl
             break;
         }
     }
-    auto alpha = std::complex<double>(kp__.weight(), 0.0);
+    F alpha = kp__.weight();
+    /* in the Gamma-point case the occupation matrix derivative is accumulated on the host */
+    auto mt_dn = std::is_same<F, real_type<F>>::value ? sddk::memory_t::host : mt;
 
     // TODO: check if we have a norm conserving pseudo potential;
     // TODO: distribute (MPI) all matrices in the basis of atomic orbitals
@@ -162,17 +199,17 @@ Hubbard::compute_occupancies_derivatives(K_point<double>& kp__, Q_operator<doubl
     RTE_ASSERT(nawf == phi_atomic.num_wf().get());
     RTE_ASSERT(nawf == phi_atomic_S.num_wf().get());
 
-    if (ctx_.processing_unit() == sddk::device_t::GPU) {
+    if (is_device_memory(mt_dn)) {
         dn__.allocate(sddk::memory_t::device);
     }
 
     /* compute overlap matrix */
-    la::dmatrix<std::complex<double>> ovlp;
-    std::unique_ptr<la::dmatrix<std::complex<double>>> inv_sqrt_O;
-    std::unique_ptr<la::dmatrix<std::complex<double>>> evec_O;
+    la::dmatrix<F> ovlp;
+    std::unique_ptr<la::dmatrix<F>> inv_sqrt_O;
+    std::unique_ptr<la::dmatrix<F>> evec_O;
     std::vector<double> eval_O;
     if (ctx_.cfg().hubbard().full_orthogonalization()) {
-        ovlp = la::dmatrix<std::complex<double>>(nawf, nawf);
+        ovlp = la::dmatrix<F>(nawf, nawf);
         wf::inner(ctx_.spla_context(), mt, wf::spin_range(0), phi_atomic, wf::band_range(0, nawf),
                 phi_atomic_S, wf::band_range(0, nawf), ovlp, 0, 0);
 
@@ -185,9 +222,9 @@ Hubbard::compute_occupancies_derivatives(K_point<double>& kp__, Q_operator<doubl
 
     /* compute < psi_{ik} | S | phi_hub > */
     /* this is used in the final expression for the occupation matrix derivative */
-    std::array<la::dmatrix<std::complex<double>>, 2> psi_s_phi_hub;
+    std::array<la::dmatrix<F>, 2> psi_s_phi_hub;
     for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
-        psi_s_phi_hub[ispn] = la::dmatrix<std::complex<double>>(kp__.num_occupied_bands(ispn), nhwf);
+        psi_s_phi_hub[ispn] = la::dmatrix<F>(kp__.num_occupied_bands(ispn), nhwf);
         wf::inner(ctx_.spla_context(), mt, wf::spin_range(ispn), kp__.spinor_wave_functions(),
             wf::band_range(0, kp__.num_occupied_bands(ispn)), kp__.hubbard_wave_functions_S(),
             wf::band_range(0, nhwf), psi_s_phi_hub[ispn], 0, 0);
@@ -200,8 +237,8 @@ Hubbard::compute_occupancies_derivatives(K_point<double>& kp__, Q_operator<doubl
     auto mg2 = s_phi_atomic_tmp->memory_guard(mt);
 
     /* compute < d phi_atomic / d r_{j} | S | psi_{ik} > and < d phi_atomic / d r_{j} | S | phi_atomic > */
-    std::array<std::array<la::dmatrix<std::complex<double>>, 2>, 3> grad_phi_atomic_s_psi;
-    std::array<la::dmatrix<std::complex<double>>, 3> grad_phi_atomic_s_phi_atomic;
+    std::array<std::array<la::dmatrix<F>, 2>, 3> grad_phi_atomic_s_psi;
+    std::array<la::dmatrix<F>, 3> grad_phi_atomic_s_phi_atomic;
 
     for (int x = 0; x < 3; x++) {
         /* compute |phi_atomic_tmp> = |d phi_atomic / d r_{alpha} > for all atoms */
@@ -218,20 +255,20 @@ Hubbard::compute_occupancies_derivatives(K_point<double>& kp__, Q_operator<doubl
             phi_atomic_tmp->copy_to(mt);
         }
         /* apply S to |d phi_atomic / d r_{alpha} > */
-        apply_S_operator<double, std::complex<double>>(mt, wf::spin_range(0),
+        apply_S_operator<double, F>(mt, wf::spin_range(0),
                 wf::band_range(0, nawf), kp__.beta_projectors(), *phi_atomic_tmp, &q_op__, *s_phi_atomic_tmp);
 
         /* compute < d phi_atomic / d r_{alpha} | S | phi_atomic >
          * used to compute derivative of the inverse square root of the overlap matrix */
         if (ctx_.cfg().hubbard().full_orthogonalization()) {
-            grad_phi_atomic_s_phi_atomic[x] = la::dmatrix<std::complex<double>>(nawf, nawf);
+            grad_phi_atomic_s_phi_atomic[x] = la::dmatrix<F>(nawf, nawf);
             wf::inner(ctx_.spla_context(), mt, wf::spin_range(0), *s_phi_atomic_tmp,
                     wf::band_range(0, nawf), phi_atomic, wf::band_range(0, nawf), grad_phi_atomic_s_phi_atomic[x], 0, 0);
         }
 
         for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
             /* allocate space */
-            grad_phi_atomic_s_psi[x][ispn] = la::dmatrix<std::complex<double>>(nawf, kp__.num_occupied_bands(ispn));
+            grad_phi_atomic_s_psi[x][ispn] = la::dmatrix<F>(nawf, kp__.num_occupied_bands(ispn));
             /* compute < d phi_atomic / d r_{j} | S | psi_{ik} > for all atoms */
             wf::inner(ctx_.spla_context(), mt, wf::spin_range(ispn), *s_phi_atomic_tmp,
                     wf::band_range(0, nawf), kp__.spinor_wave_functions(),
@@ -240,10 +277,10 @@ Hubbard::compute_occupancies_derivatives(K_point<double>& kp__, Q_operator<doubl
     }
 
     /* compute <phi_atomic | S | psi_{ik} > */
-    std::array<la::dmatrix<std::complex<double>>, 2> phi_atomic_s_psi;
+    std::array<la::dmatrix<F>, 2> phi_atomic_s_psi;
     if (ctx_.cfg().hubbard().full_orthogonalization()) {
         for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
-            phi_atomic_s_psi[ispn] = la::dmatrix<std::complex<double>>(nawf, kp__.num_occupied_bands(ispn));
+            phi_atomic_s_psi[ispn] = la::dmatrix<F>(nawf, kp__.num_occupied_bands(ispn));
             /* compute < phi_atomic | S | psi_{ik} > for all atoms */
             wf::inner(ctx_.spla_context(), mt, wf::spin_range(ispn), phi_atomic_S,
                     wf::band_range(0, nawf), kp__.spinor_wave_functions(),
@@ -254,20 +291,20 @@ Hubbard::compute_occupancies_derivatives(K_point<double>& kp__, Q_operator<doubl
     Beta_projectors_gradient<double> bp_grad(ctx_, kp__.gkvec(), kp__.beta_projectors());
     bp_grad.prepare();
 
-    dn__.zero(mt);
+    dn__.zero(mt_dn);
 
     for (int ichunk = 0; ichunk < kp__.beta_projectors().num_chunks(); ichunk++) {
         kp__.beta_projectors().generate(mt, ichunk);
 
         /* <beta | phi_atomic> for this chunk */
-        auto beta_phi_atomic = kp__.beta_projectors().inner<std::complex<double>>(mt, ichunk, phi_atomic, wf::spin_index(0),
+        auto beta_phi_atomic = kp__.beta_projectors().template inner<F>(mt, ichunk, phi_atomic, wf::spin_index(0),
                 wf::band_range(0, nawf));
 
         for (int x = 0; x < 3; x++) {
             bp_grad.generate(mt, ichunk, x);
 
             /* <dbeta | phi> for this chunk */
-            auto grad_beta_phi_atomic = bp_grad.inner<std::complex<double>>(mt, ichunk, phi_atomic, wf::spin_index(0),
+            auto grad_beta_phi_atomic = bp_grad.template inner<F>(mt, ichunk, phi_atomic, wf::spin_index(0),
                     wf::band_range(0, nawf));
 
             for (int i = 0; i < kp__.beta_projectors().chunk(ichunk).num_atoms_; i++) {
@@ -301,7 +338,7 @@ Hubbard::compute_occupancies_derivatives(K_point<double>& kp__, Q_operator<doubl
                         int i = num_ps_atomic_wf.second[ja] + xi;
                         for (int j = 0; j < nawf; j++) {
                             ovlp(i, j) += grad_phi_atomic_s_phi_atomic[x](i, j);
-                            ovlp(j, i) += std::conj(grad_phi_atomic_s_phi_atomic[x](i, j));
+                            ovlp(j, i) += utils::conj(grad_phi_atomic_s_phi_atomic[x](i, j));
                         }
                     }
                     compute_inv_sqrt_O_deriv(ovlp, *evec_O, eval_O, nawf);
@@ -309,7 +346,7 @@ Hubbard::compute_occupancies_derivatives(K_point<double>& kp__, Q_operator<doubl
 
                 for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
                     /* compute <phi_atomic | dS/dr_j | psi_{ik}> */
-                    la::dmatrix<std::complex<double>> phi_atomic_ds_psi(nawf, kp__.num_occupied_bands(ispn));
+                    la::dmatrix<F> phi_atomic_ds_psi(nawf, kp__.num_occupied_bands(ispn));
                     wf::inner(ctx_.spla_context(), mt, wf::spin_range(ispn), *phi_atomic_tmp,
                             wf::band_range(0, nawf), kp__.spinor_wave_functions(),
                             wf::band_range(0, kp__.num_occupied_bands(ispn)), phi_atomic_ds_psi, 0, 0);
@@ -323,7 +360,7 @@ Hubbard::compute_occupancies_derivatives(K_point<double>& kp__, Q_operator<doubl
                     }
 
                     /* build the full d <phi_hub | S | psi_ik> / d r_{alpha} matrix */
-                    la::dmatrix<std::complex<double>> phi_hub_s_psi_deriv(num_hubbard_wf.first, kp__.num_occupied_bands(ispn));
+                    la::dmatrix<F> phi_hub_s_psi_deriv(num_hubbard_wf.first, kp__.num_occupied_bands(ispn));
 
                     build_phi_hub_s_psi_deriv(ctx_, kp__.num_occupied_bands(ispn), nawf, ovlp, *inv_sqrt_O,
                             phi_atomic_s_psi[ispn], phi_atomic_ds_psi, num_ps_atomic_wf.second, num_hubbard_wf.second,
@@ -343,19 +380,20 @@ Hubbard::compute_occupancies_derivatives(K_point<double>& kp__, Q_operator<doubl
 
                     /* update the density matrix derivative */
                     update_density_matrix_deriv(la, mt, num_hubbard_wf.first, kp__.num_occupied_bands(ispn),
-                            &alpha, phi_hub_s_psi_deriv, psi_s_phi_hub[ispn], dn__.at(mt, 0, 0, ispn, x, ja),
+                            &alpha, phi_hub_s_psi_deriv, psi_s_phi_hub[ispn], dn__.at(mt_dn, 0, 0, ispn, x, ja),
                             dn__.ld());
                 } // ispn
             } //i
         } // x
     } // ichunk
 
-    if (ctx_.processing_unit() == sddk::device_t::GPU) {
+    if (is_device_memory(mt_dn)) {
         dn__.copy_to(sddk::memory_t::host);
         dn__.deallocate(sddk::memory_t::device);
     }
 }
 
+template <typename F>
 void // TODO: rename to strain_deriv, rename previous func. to displacement_deriv
 Hubbard::compute_occupancies_stress_derivatives(K_point<double>& kp__, Q_operator<double>& q_op__,
                                                 sddk::mdarray<std::complex<double>, 4>& dn__)
@@ -376,7 +414,9 @@ Hubbard::compute_occupancies_stress_derivatives(K_point<double>& kp__, Q_operato
             break;
         }
     }
-    auto alpha = std::complex<double>(kp__.weight(), 0.0);
+    F alpha = kp__.weight();
+    /* in the Gamma-point case the occupation matrix derivative is accumulated on the host */
+    auto mt_dn = std::is_same<F, real_type<F>>::value ? sddk::memory_t::host : mt;
 
     Beta_projectors_strain_deriv<double> bp_strain_deriv(ctx_, kp__.gkvec());
     /* initialize the beta projectors and derivatives */
@@ -423,21 +463,21 @@ Hubbard::compute_occupancies_stress_derivatives(K_point<double>& kp__, Q_operato
 
     /* compute < psi_{ik} | S | phi_hub > */
     /* this is used in the final expression for the occupation matrix derivative */
-    std::array<la::dmatrix<std::complex<double>>, 2> psi_s_phi_hub;
+    std::array<la::dmatrix<F>, 2> psi_s_phi_hub;
     for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
-        psi_s_phi_hub[ispn] = la::dmatrix<std::complex<double>>(kp__.num_occupied_bands(ispn), nhwf);
+        psi_s_phi_hub[ispn] = la::dmatrix<F>(kp__.num_occupied_bands(ispn), nhwf);
         wf::inner(ctx_.spla_context(), mt, wf::spin_range(ispn), kp__.spinor_wave_functions(),
                 wf::band_range(0, kp__.num_occupied_bands(ispn)), phi_hub_S, wf::band_range(0, nhwf),
                 psi_s_phi_hub[ispn], 0, 0);
     }
 
     /* compute overlap matrix */
-    la::dmatrix<std::complex<double>> ovlp;
-    std::unique_ptr<la::dmatrix<std::complex<double>>> inv_sqrt_O;
-    std::unique_ptr<la::dmatrix<std::complex<double>>> evec_O;
+    la::dmatrix<F> ovlp;
+    std::unique_ptr<la::dmatrix<F>> inv_sqrt_O;
+    std::unique_ptr<la::dmatrix<F>> evec_O;
     std::vector<double> eval_O;
     if (ctx_.cfg().hubbard().full_orthogonalization()) {
-        ovlp = la::dmatrix<std::complex<double>>(nawf, nawf);
+        ovlp = la::dmatrix<F>(nawf, nawf);
         wf::inner(ctx_.spla_context(), mt, wf::spin_range(0), phi_atomic, wf::band_range(0, nawf),
                 phi_atomic_S, wf::band_range(0, nawf), ovlp, 0, 0);
 
@@ -449,10 +489,10 @@ Hubbard::compute_occupancies_stress_derivatives(K_point<double>& kp__, Q_operato
     }
 
     /* compute <phi_atomic | S | psi_{ik} > */
-    std::array<la::dmatrix<std::complex<double>>, 2> phi_atomic_s_psi;
+    std::array<la::dmatrix<F>, 2> phi_atomic_s_psi;
     if (ctx_.cfg().hubbard().full_orthogonalization()) {
         for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
-            phi_atomic_s_psi[ispn] = la::dmatrix<std::complex<double>>(nawf, kp__.num_occupied_bands(ispn));
+            phi_atomic_s_psi[ispn] = la::dmatrix<F>(nawf, kp__.num_occupied_bands(ispn));
             /* compute < phi_atomic | S | psi_{ik} > for all atoms */
             wf::inner(ctx_.spla_context(), mt, wf::spin_range(ispn), phi_atomic_S,
                     wf::band_range(0, nawf), kp__.spinor_wave_functions(),
@@ -473,11 +513,11 @@ Hubbard::compute_occupancies_stress_derivatives(K_point<double>& kp__, Q_operato
             }
 
             /* compute S |d phi_atomic / d epsilon_{mu, nu} > */
-            sirius::apply_S_operator<double, std::complex<double>>(mt, wf::spin_range(0),
+            sirius::apply_S_operator<double, F>(mt, wf::spin_range(0),
                     wf::band_range(0, nawf), kp__.beta_projectors(), *dphi_atomic, &q_op__, *s_dphi_atomic);
 
             ds_phi_atomic->zero(mt, wf::spin_index(0), wf::band_range(0, nawf));
-            sirius::apply_S_operator_strain_deriv(mt, 3 * nu + mu, kp__.beta_projectors(),
+            sirius::apply_S_operator_strain_deriv<F>(mt, 3 * nu + mu, kp__.beta_projectors(),
                          bp_strain_deriv, phi_atomic, q_op__, *ds_phi_atomic);
 
             if (ctx_.cfg().hubbard().full_orthogonalization()) {
@@ -486,25 +526,25 @@ Hubbard::compute_occupancies_stress_derivatives(K_point<double>& kp__, Q_operato
                         wf::band_range(0, nawf), *ds_phi_atomic, wf::band_range(0, nawf), ovlp, 0, 0);
 
                 /* compute <d phi_atomic / d epsilon | S | phi_atomic > */
-                la::dmatrix<std::complex<double>> tmp(nawf, nawf);
+                la::dmatrix<F> tmp(nawf, nawf);
                 wf::inner(ctx_.spla_context(), mt, wf::spin_range(0), *s_dphi_atomic,
                         wf::band_range(0, nawf), phi_atomic, wf::band_range(0, nawf), tmp, 0, 0);
 
                 for (int i = 0; i < nawf; i++) {
                     for (int j = 0; j < nawf; j++) {
-                        ovlp(i, j) += tmp(i, j) + std::conj(tmp(j, i));
+                        ovlp(i, j) += tmp(i, j) + utils::conj(tmp(j, i));
                     }
                 }
                 compute_inv_sqrt_O_deriv(ovlp, *evec_O, eval_O, nawf);
             }
 
             for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
-                la::dmatrix<std::complex<double>> dphi_atomic_s_psi(nawf, kp__.num_occupied_bands(ispn));
+                la::dmatrix<F> dphi_atomic_s_psi(nawf, kp__.num_occupied_bands(ispn));
                 wf::inner(ctx_.spla_context(), mt, wf::spin_range(ispn), *s_dphi_atomic,
                         wf::band_range(0, nawf), kp__.spinor_wave_functions(),
                         wf::band_range(0, kp__.num_occupied_bands(ispn)), dphi_atomic_s_psi, 0, 0);
 
-                la::dmatrix<std::complex<double>> phi_atomic_ds_psi(nawf, kp__.num_occupied_bands(ispn));
+                la::dmatrix<F> phi_atomic_ds_psi(nawf, kp__.num_occupied_bands(ispn));
                 wf::inner(ctx_.spla_context(), mt, wf::spin_range(ispn), *ds_phi_atomic,
                         wf::band_range(0, nawf), kp__.spinor_wave_functions(),
                         wf::band_range(0, kp__.num_occupied_bands(ispn)), phi_atomic_ds_psi, 0, 0);
@@ -516,7 +556,7 @@ Hubbard::compute_occupancies_stress_derivatives(K_point<double>& kp__, Q_operato
                 }
 
                 /* build the full d <phi_hub | S | psi_ik> / d epsilon_{mu,nu} matrix */
-                la::dmatrix<std::complex<double>> phi_hub_s_psi_deriv(num_hubbard_wf.first, kp__.num_occupied_bands(ispn));
+                la::dmatrix<F> phi_hub_s_psi_deriv(num_hubbard_wf.first, kp__.num_occupied_bands(ispn));
                 build_phi_hub_s_psi_deriv(ctx_, kp__.num_occupied_bands(ispn), nawf, ovlp, *inv_sqrt_O,
                         phi_atomic_s_psi[ispn], phi_atomic_ds_psi, num_ps_atomic_wf.second, num_hubbard_wf.second,
                         phi_hub_s_psi_deriv);
@@ -535,15 +575,31 @@ Hubbard::compute_occupancies_stress_derivatives(K_point<double>& kp__, Q_operato
 
                 /* update the density matrix derivative */
                 update_density_matrix_deriv(la, mt, num_hubbard_wf.first, kp__.num_occupied_bands(ispn),
-                        &alpha, phi_hub_s_psi_deriv, psi_s_phi_hub[ispn], dn__.at(mt, 0, 0, ispn, 3 * nu + mu),
+                        &alpha, phi_hub_s_psi_deriv, psi_s_phi_hub[ispn], dn__.at(mt_dn, 0, 0, ispn, 3 * nu + mu),
                         dn__.ld());
             }
         }
     }
 
-    if (ctx_.processing_unit() == sddk::device_t::GPU) {
+    if (is_device_memory(mt_dn)) {
         dn__.copy_to(sddk::memory_t::host);
     }
 }
 
+template void
+Hubbard::compute_occupancies_derivatives<double>(K_point<double>& kp__, Q_operator<double>& q_op__,
+        sddk::mdarray<std::complex<double>, 5>& dn__);
+
+template void
+Hubbard::compute_occupancies_derivatives<std::complex<double>>(K_point<double>& kp__, Q_operator<double>& q_op__,
+        sddk::mdarray<std::complex<double>, 5>& dn__);
+
+template void
+Hubbard::compute_occupancies_stress_derivatives<double>(K_point<double>& kp__, Q_operator<double>& q_op__,
+        sddk::mdarray<std::complex<double>, 4>& dn__);
+
+template void
+Hubbard::compute_occupancies_stress_derivatives<std::complex<double>>(K_point<double>& kp__,
+        Q_operator<double>& q_op__, sddk::mdarray<std::complex<double>, 4>& dn__);
+
 } // namespace sirius
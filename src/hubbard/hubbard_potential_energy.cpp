@@ -50,6 +50,29 @@ generate_potential_collinear_nonlocal(Simulation_context const& ctx__, const int
     }
 }
 
+/* the inter-site term couples all four spin components of n^{\sigma\sigma'}_{IJ}; the spin-flip components
+ * are stored in the same swapped order as in the on-site non-collinear potential */
+static void
+generate_potential_non_collinear_nonlocal(Simulation_context const& ctx__, const int index__,
+                                          sddk::mdarray<std::complex<double>, 3> const& om__,
+                                          sddk::mdarray<std::complex<double>, 3>& um__)
+{
+    auto nl = ctx__.cfg().hubbard().nonlocal(index__);
+    um__.zero();
+
+    double v_ij = nl.V() / ha2ev;
+    int il      = nl.l()[0];
+    int jl      = nl.l()[1];
+    for (int is = 0; is < 4; is++) {
+        int is1 = (is < 2) ? is : 5 - is;
+        for (int m2 = 0; m2 < 2 * jl + 1; m2++) {
+            for (int m1 = 0; m1 < 2 * il + 1; m1++) {
+                um__(m1, m2, is) = -v_ij * om__(m1, m2, is1);
+            }
+        }
+    }
+}
+
 static void
 generate_potential_collinear_local(Simulation_context const& ctx__, Atom_type const& atom_type__, const int idx_hub_wf,
                                    sddk::mdarray<std::complex<double>, 3> const& om__, sddk::mdarray<std::complex<double>, 3>& um__)
@@ -188,6 +211,27 @@ calculate_energy_collinear_nonlocal(Simulation_context const& ctx__, const int i
     return -0.5 * hubbard_energy;
 }
 
+static double
+calculate_energy_non_collinear_nonlocal(Simulation_context const& ctx__, const int index__,
+                                        sddk::mdarray<std::complex<double>, 3> const& om__)
+{
+    auto nl = ctx__.cfg().hubbard().nonlocal(index__);
+    double hubbard_energy{0.0};
+    double v_ij_ = nl.V() / ha2ev;
+    int il       = nl.l()[0];
+    int jl       = nl.l()[1];
+
+    for (int is = 0; is < 4; is++) {
+        for (int m1 = 0; m1 < 2 * jl + 1; m1++) {
+            for (int m2 = 0; m2 < 2 * il + 1; m2++) {
+                hubbard_energy += v_ij_ * std::real(om__(m2, m1, is) * conj(om__(m2, m1, is)));
+            }
+        }
+    }
+
+    return -0.5 * hubbard_energy;
+}
+
 static double
 calculate_energy_collinear_local(Simulation_context const& ctx__, Atom_type const& atom_type__, const int idx_hub_wf,
                                  sddk::mdarray<std::complex<double>, 3> const& om__)
@@ -541,9 +585,9 @@ generate_potential(Hubbard_matrix const& om__, Hubbard_matrix& um__)
 
         if (ctx.num_mag_dims() != 3) {
             ::sirius::generate_potential_collinear_nonlocal(ctx, i, om__.nonlocal(i), um__.nonlocal(i));
-        } // else {
-        //    ::sirius::generate_potential_non_collinear_nonlocal(ctx, nl, om__.nonlocal(i), um__.nonlocal(i));
-        //}
+        } else {
+            ::sirius::generate_potential_non_collinear_nonlocal(ctx, i, om__.nonlocal(i), um__.nonlocal(i));
+        }
     }
 }
 
@@ -568,9 +612,9 @@ energy(Hubbard_matrix const& om__)
     for (int i = 0; i < static_cast<int>(ctx.cfg().hubbard().nonlocal().size()); i++) {
         if (ctx.num_mag_dims() != 3) {
             energy += ::sirius::calculate_energy_collinear_nonlocal(ctx, i, om__.nonlocal(i));
-        } // else {
-        //    energy += ::sirius::calculate_energy_noncollinear_nonlocal(ctx, nl, om__.nonlocal(i));
-        //}
+        } else {
+            energy += ::sirius::calculate_energy_non_collinear_nonlocal(ctx, i, om__.nonlocal(i));
+        }
     }
     return energy;
 }
@@ -619,7 +663,7 @@ one_electron_energy_hubbard(Hubbard_matrix const& om__, Hubbard_matrix const& pm
             const auto& n1 = om__.nonlocal(i);
             const auto& n2 = pm__.nonlocal(i);
 
-            for (int is = 0; is < ctx.num_spins(); is++) {
+            for (int is = 0; is < ((ctx.num_mag_dims() == 3) ? 4 : ctx.num_spins()); is++) {
                 for (int m2 = 0; m2 < 2 * jl + 1; m2++) {
                     for (int m1 = 0; m1 < 2 * il + 1; m1++) {
                         tmp += std::conj(n2(m1, m2, is)) * n1(m1, m2, is);
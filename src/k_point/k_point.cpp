@@ -184,6 +184,62 @@ K_point<T>::initialize()
     update();
 }
 
+/// Orthogonalize atomic wave-functions with the inverse square root of their overlap matrix.
+/** On input phi and sphi contain the atomic wave-functions and S|phi>; on output they are replaced by the
+ *  orthogonalized functions O^{-1/2}|phi> and S O^{-1/2}|phi>.
+ *
+ *  \tparam T  Precision of the wave-functions.
+ *  \tparam F  Type of the subspace (real for the Gamma-point calculation, complex otherwise).
+ */
+template <typename T, typename F>
+static void
+orthogonalize_atomic_wave_functions(Simulation_context& ctx__, sddk::memory_t mem__, int nwf__,
+        Beta_projectors<T>& bp__, Q_operator<T> const* q_op__, wf::Wave_functions<T>& phi__,
+        wf::Wave_functions<T>& sphi__)
+{
+    auto const& cfg = ctx__.cfg().hubbard();
+
+    /* method to compute O^{-1/2} */
+    auto inv_sqrt = [&](la::dmatrix<F>& A, int N)
+    {
+        if (cfg.inverse_sqrt() == "newton_schulz") {
+            return inverse_sqrt_newton_schulz(A, N, cfg.inverse_sqrt_tol());
+        } else {
+            return std::move(std::get<0>(inverse_sqrt(A, N)));
+        }
+    };
+
+    std::unique_ptr<la::dmatrix<F>> B;
+    if (cfg.overlap_threshold() > 0) {
+        /* overlap matrix is stored on each rank; the inverse square root is computed independently for the
+         * groups of atoms coupled by the overlap matrix elements above the threshold */
+        la::dmatrix<F> ovlp(nwf__, nwf__);
+        wf::inner(ctx__.spla_context(), mem__, wf::spin_range(0), phi__, wf::band_range(0, nwf__), sphi__,
+                wf::band_range(0, nwf__), ovlp, 0, 0);
+
+        std::vector<int> offsets = ctx__.unit_cell().num_ps_atomic_wf().second;
+        offsets.push_back(nwf__);
+
+        B = std::move(inverse_sqrt_blocks(ovlp, offsets, cfg.overlap_threshold(), inv_sqrt).first);
+    } else {
+        int BS = ctx__.cyclic_block_size();
+        la::dmatrix<F> ovlp(nwf__, nwf__, ctx__.blacs_grid(), BS, BS);
+
+        wf::inner(ctx__.spla_context(), mem__, wf::spin_range(0), phi__, wf::band_range(0, nwf__), sphi__,
+                wf::band_range(0, nwf__), ovlp, 0, 0);
+        B = inv_sqrt(ovlp, nwf__);
+    }
+
+    /* use sphi as temporary */
+    wf::transform(ctx__.spla_context(), mem__, *B, 0, 0, 1.0, phi__, wf::spin_index(0), wf::band_range(0, nwf__),
+            0.0, sphi__, wf::spin_index(0), wf::band_range(0, nwf__));
+
+    wf::copy(mem__, sphi__, wf::spin_index(0), wf::band_range(0, nwf__), phi__, wf::spin_index(0),
+            wf::band_range(0, nwf__));
+
+    apply_S_operator<T, F>(mem__, wf::spin_range(0), wf::band_range(0, nwf__), bp__, phi__, q_op__, sphi__);
+}
+
 template <typename T>
 void
 K_point<T>::generate_hubbard_orbitals()
@@ -195,9 +251,6 @@ K_point<T>::generate_hubbard_orbitals()
     if (ctx_.so_correction()) {
         RTE_THROW("Hubbard+SO is not implemented");
     }
-    if (ctx_.gamma_point()) {
-        RTE_THROW("Hubbard+Gamma point is not implemented");
-    }
 
     //phi.zero(sddk::device_t::CPU);
     //sphi.zero(sddk::device_t::CPU);
@@ -235,8 +288,13 @@ K_point<T>::generate_hubbard_orbitals()
         /* compute S|phi> */
         beta_projectors().prepare();
 
-        sirius::apply_S_operator<T, std::complex<T>>(mem, wf::spin_range(0), wf::band_range(0, nwf), beta_projectors(),
-                *atomic_wave_functions_, q_op.get(), *atomic_wave_functions_S_);
+        if (ctx_.gamma_point()) {
+            sirius::apply_S_operator<T, T>(mem, wf::spin_range(0), wf::band_range(0, nwf), beta_projectors(),
+                    *atomic_wave_functions_, q_op.get(), *atomic_wave_functions_S_);
+        } else {
+            sirius::apply_S_operator<T, std::complex<T>>(mem, wf::spin_range(0), wf::band_range(0, nwf),
+                    beta_projectors(), *atomic_wave_functions_, q_op.get(), *atomic_wave_functions_S_);
+        }
 
         if (ctx_.cfg().hubbard().full_orthogonalization()) {
             /* save phi and sphi */
@@ -254,23 +312,13 @@ K_point<T>::generate_hubbard_orbitals()
             wf::copy(mem, *atomic_wave_functions_S_, wf::spin_index(0), wf::band_range(0, nwf),
                     *swf_tmp, wf::spin_index(0), wf::band_range(0, nwf));
 
-            int BS = ctx_.cyclic_block_size();
-            la::dmatrix<std::complex<T>> ovlp(nwf, nwf, ctx_.blacs_grid(), BS, BS);
-
-            wf::inner(ctx_.spla_context(), mem, wf::spin_range(0), *atomic_wave_functions_,
-                    wf::band_range(0, nwf), *atomic_wave_functions_S_, wf::band_range(0, nwf), ovlp, 0, 0);
-            auto B = std::get<0>(inverse_sqrt(ovlp, nwf));
-
-            /* use sphi as temporary */
-            wf::transform(ctx_.spla_context(), mem, *B, 0, 0, 1.0, *atomic_wave_functions_,
-                    wf::spin_index(0), wf::band_range(0, nwf), 0.0, *atomic_wave_functions_S_, wf::spin_index(0),
-                    wf::band_range(0, nwf));
-
-            wf::copy(mem, *atomic_wave_functions_S_, wf::spin_index(0), wf::band_range(0, nwf),
-                     *atomic_wave_functions_, wf::spin_index(0), wf::band_range(0, nwf));
-
-            apply_S_operator<T, std::complex<T>>(mem, wf::spin_range(0), wf::band_range(0, nwf), beta_projectors(),
-                *atomic_wave_functions_, q_op.get(), *atomic_wave_functions_S_);
+            if (ctx_.gamma_point()) {
+                orthogonalize_atomic_wave_functions<T, T>(ctx_, mem, nwf, beta_projectors(), q_op.get(),
+                        *atomic_wave_functions_, *atomic_wave_functions_S_);
+            } else {
+                orthogonalize_atomic_wave_functions<T, std::complex<T>>(ctx_, mem, nwf, beta_projectors(),
+                        q_op.get(), *atomic_wave_functions_, *atomic_wave_functions_S_);
+            }
 
             //if (ctx_.cfg().control().verification() >= 1) {
             //    sddk::inner(ctx_.spla_context(), sddk::spin_range(0), phi, 0, nwf, sphi, 0, nwf, ovlp, 0, 0);
@@ -579,7 +627,7 @@ K_point<T>::save(std::string const& name__, int id__) const
                 gv(x, i) = v[x];
             }
         }
-        fout["K_point_set"][id__].write("gvec", gv);
+        fout["K_point_set"][id__].write("gvec", gv, ctx_.hdf5_layout());
         fout["K_point_set"][id__].create_node("bands");
         for (int i = 0; i < ctx_.num_bands(); i++) {
             fout["K_point_set"][id__]["bands"].create_node(i);
@@ -98,6 +98,9 @@ class K_point
     /// Two-component (spinor) wave functions describing the bands.
     std::unique_ptr<wf::Wave_functions<T>> spinor_wave_functions_{nullptr};
 
+    /// Real-space spinor wave-functions saved during the density generation.
+    wf::Wave_functions_rg_cache<T> psi_rg_cache_;
+
     /// Pseudopotential atmoic wave-functions (not orthogonalized).
     std::unique_ptr<wf::Wave_functions<T>> atomic_wave_functions_{nullptr};
 
@@ -468,6 +471,54 @@ class K_point
         // return const_cast<wf::Wave_functions<T>&>(static_cast<K_point const&>(*this).spinor_wave_functions());;
     }
 
+    /// Size of the first-variational and spinor wave-functions in bytes.
+    inline size_t wave_functions_size_in_bytes() const
+    {
+        size_t n{0};
+        for (auto w : {fv_states_.get(), spinor_wave_functions_.get()}) {
+            if (w) {
+                n += w->size_in_bytes();
+            }
+        }
+        return n;
+    }
+
+    /// Move the first-variational and spinor wave-functions to memory-mapped scratch files (out-of-core mode).
+    inline void map_wave_functions_to_file(std::string const& dir__)
+    {
+        for (auto w : {fv_states_.get(), spinor_wave_functions_.get()}) {
+            if (w) {
+                w->map_to_file(dir__);
+            }
+        }
+    }
+
+    /// Start an asynchronous read of the out-of-core wave-functions.
+    inline void prefetch_wave_functions() const
+    {
+        for (auto w : {fv_states_.get(), spinor_wave_functions_.get()}) {
+            if (w) {
+                w->prefetch(wf::band_range(0, w->num_wf().get()));
+            }
+        }
+    }
+
+    /// Release the out-of-core wave-functions from the resident memory.
+    inline void evict_wave_functions() const
+    {
+        for (auto w : {fv_states_.get(), spinor_wave_functions_.get()}) {
+            if (w) {
+                w->evict(wf::band_range(0, w->num_wf().get()));
+            }
+        }
+    }
+
+    /// Return the storage of the real-space spinor wave-functions.
+    inline auto& psi_rg_cache()
+    {
+        return psi_rg_cache_;
+    }
+
     inline auto& spinor_wave_functions2()
     {
         RTE_ASSERT(spinor_wave_functions_ != nullptr);
@@ -152,6 +152,25 @@ void K_point_set::initialize(std::vector<int> const& counts)
 #endif
     }
 
+    /* keep the wave-functions in the scratch files if they don't fit into the memory limit; they are paged
+     * in for the k-point being processed */
+    auto ooc_path = ctx_.cfg().control().ooc_path();
+    if (!ooc_path.empty()) {
+        size_t n{0};
+        for (int ikloc = 0; ikloc < spl_num_kpoints_.local_size(); ikloc++) {
+            n += kpoints_[spl_num_kpoints_[ikloc]]->wave_functions_size_in_bytes();
+        }
+        if (n > ctx_.cfg().control().ooc_memory_limit() * std::pow(2, 30)) {
+            for (int ikloc = 0; ikloc < spl_num_kpoints_.local_size(); ikloc++) {
+                auto& kp = kpoints_[spl_num_kpoints_[ikloc]];
+                kp->map_wave_functions_to_file(ooc_path);
+                kp->evict_wave_functions();
+            }
+            ctx_.out(1, __func__) << "wave-functions of " << spl_num_kpoints_.local_size() << " k-points ("
+                                  << (n >> 20) << " Mb) are stored in " << ooc_path << std::endl;
+        }
+    }
+
     if (ctx_.verbosity() > 0) {
         this->print_info();
     }
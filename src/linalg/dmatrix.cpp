@@ -244,7 +244,7 @@ void dmatrix<T>::save_to_hdf5(std::string name__, int m__, int n__)
             }
         }
     }
-    this->comm().allreduce(full_mtrx.template at(sddk::memory_t::host), static_cast<int>(full_mtrx.size()));
+    this->comm().allreduce(full_mtrx.template at(sddk::memory_t::host), full_mtrx.size());
 
     if (this->blacs_grid().comm().rank() == 0) {
         sddk::HDF5_tree h5(name__, sddk::hdf5_access_t::truncate);
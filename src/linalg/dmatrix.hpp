@@ -319,7 +319,7 @@ class dmatrix: public sddk::matrix<T>
             }
         }
         if (blacs_grid_) {
-            blacs_grid_->comm().allreduce(full_mtrx.at(sddk::memory_t::host), static_cast<int>(full_mtrx.size()));
+            blacs_grid_->comm().allreduce(full_mtrx.at(sddk::memory_t::host), full_mtrx.size());
         }
         return full_mtrx;
     }
@@ -1,9 +1,13 @@
 #ifndef __INVERSE_SQRT_HPP__
 #define __INVERSE_SQRT_HPP__
 
+#include <functional>
+#include <map>
+#include <numeric>
 #include "linalg/dmatrix.hpp"
 #include "linalg/eigensolver.hpp"
 #include "linalg/linalg.hpp"
+#include "utils/profiler.hpp"
 #include "utils/rte.hpp"
 
 namespace sirius {
@@ -51,6 +55,202 @@ inverse_sqrt(la::dmatrix<T>& A__, int N__)
     return std::make_tuple(std::move(B), std::move(Z), eval);
 }
 
+/// Compute inverse square root of the Hermitian positive-definite matrix with the coupled Newton-Schulz iteration.
+/** The matrix is first scaled by its Frobenius norm \f$ c \f$, which is an upper bound of the largest eigen-value,
+ *  such that the spectrum of \f$ {\bf Y}_0 = {\bf A}/c \f$ lies in (0, 1]. Then the iteration
+ *  \f[
+ *    {\bf T}_k = \frac{1}{2}(3{\bf I} - {\bf Z}_k {\bf Y}_k), \quad {\bf Y}_{k+1} = {\bf Y}_k {\bf T}_k, \quad
+ *    {\bf Z}_{k+1} = {\bf T}_k {\bf Z}_k, \quad {\bf Z}_0 = {\bf I}
+ *  \f]
+ *  converges quadratically to \f$ {\bf Z}_{\infty} = ({\bf A}/c)^{-1/2} \f$. Only matrix-matrix multiplications are
+ *  required, which is much cheaper than the full eigen-decomposition for well-conditioned matrices such as the
+ *  overlap matrix of atomic orbitals.
+ *
+ *  The input matrix is not modified.
+ */
+template <typename T>
+inline auto
+inverse_sqrt_newton_schulz(la::dmatrix<T>& A__, int N__, real_type<T> tol__, int num_iter__ = 100)
+{
+    PROFILE("sirius::inverse_sqrt_newton_schulz");
+
+    bool serial = (A__.comm().size() == 1);
+
+    auto create = [&]()
+    {
+        if (serial) {
+            return std::make_unique<la::dmatrix<T>>(A__.num_rows(), A__.num_cols());
+        } else {
+            return std::make_unique<la::dmatrix<T>>(A__.num_rows(), A__.num_cols(), A__.blacs_grid(), A__.bs_row(),
+                    A__.bs_col());
+        }
+    };
+
+    /* C = A * B */
+    auto mult = [&](la::dmatrix<T>& A, la::dmatrix<T>& B, la::dmatrix<T>& C)
+    {
+        if (serial) {
+            la::wrap(la::lib_t::blas).gemm('N', 'N', N__, N__, N__, &la::constant<T>::one(),
+                A.at(sddk::memory_t::host), A.ld(), B.at(sddk::memory_t::host), B.ld(), &la::constant<T>::zero(),
+                C.at(sddk::memory_t::host), C.ld());
+        } else {
+            la::wrap(la::lib_t::scalapack).gemm('N', 'N', N__, N__, N__, &la::constant<T>::one(),
+                A, 0, 0, B, 0, 0, &la::constant<T>::zero(), C, 0, 0);
+        }
+    };
+
+    /* Frobenius norm of the matrix */
+    real_type<T> c{0};
+    for (int i = 0; i < A__.num_cols_local(); i++) {
+        for (int j = 0; j < A__.num_rows_local(); j++) {
+            c += std::pow(std::abs(A__(j, i)), 2);
+        }
+    }
+    A__.comm().allreduce(&c, 1);
+    c = std::sqrt(c);
+    if (c == 0) {
+        RTE_THROW("zero matrix");
+    }
+
+    auto Y  = create();
+    auto Z  = create();
+    auto W  = create();
+    auto W1 = create();
+
+    for (int i = 0; i < A__.num_cols_local(); i++) {
+        for (int j = 0; j < A__.num_rows_local(); j++) {
+            (*Y)(j, i) = A__(j, i) / static_cast<T>(c);
+            (*Z)(j, i) = (A__.irow(j) == A__.icol(i)) ? 1 : 0;
+        }
+    }
+
+    int iter{0};
+    real_type<T> diff{0};
+    for (iter = 0; iter < num_iter__; iter++) {
+        /* W = Z Y */
+        mult(*Z, *Y, *W);
+        /* check how far W is from the identity and compute T = (3I - Z Y) / 2 */
+        diff = 0;
+        for (int i = 0; i < W->num_cols_local(); i++) {
+            for (int j = 0; j < W->num_rows_local(); j++) {
+                T d = (W->irow(j) == W->icol(i)) ? 1 : 0;
+                diff += std::pow(std::abs(d - (*W)(j, i)), 2);
+                (*W)(j, i) = static_cast<T>(1.5) * d - static_cast<T>(0.5) * (*W)(j, i);
+            }
+        }
+        A__.comm().allreduce(&diff, 1);
+        diff = std::sqrt(diff);
+        if (diff < tol__) {
+            break;
+        }
+        /* Y <- Y T */
+        mult(*Y, *W, *W1);
+        std::swap(Y, W1);
+        /* Z <- T Z */
+        mult(*W, *Z, *W1);
+        std::swap(Z, W1);
+    }
+    if (diff >= tol__) {
+        std::stringstream s;
+        s << "Newton-Schulz iteration for the inverse square root is not converged" << std::endl
+          << "  number of iterations : " << iter << std::endl
+          << "  error : " << diff;
+        RTE_THROW(s);
+    }
+
+    /* A^{-1/2} = (A/c)^{-1/2} / sqrt(c) */
+    auto f = 1.0 / std::sqrt(c);
+    for (int i = 0; i < Z->num_cols_local(); i++) {
+        for (int j = 0; j < Z->num_rows_local(); j++) {
+            (*Z)(j, i) *= static_cast<T>(f);
+        }
+    }
+
+    return Z;
+}
+
+/// Compute inverse square root of a matrix which is block-diagonal up to small off-diagonal blocks.
+/** The rows and columns of the matrix are partitioned into blocks (typically, the orbitals of one atom). Two blocks
+ *  are coupled if the largest absolute value of the off-diagonal matrix elements between them exceeds the threshold.
+ *  The connected groups of the coupled blocks are found and the inverse square root is computed independently for
+ *  each group with the provided functor and then assembled back into the full matrix. For spatially separated
+ *  atoms this reduces the \f$ O(N^3) \f$ cost to the sum of the cubes of the group sizes.
+ *
+ *  \param [in] A          Serial matrix.
+ *  \param [in] offsets    Offsets of the blocks; the last element is equal to the size of the matrix.
+ *  \param [in] threshold  Threshold for the off-diagonal matrix elements.
+ *  \param [in] inv_sqrt   Functor which computes inverse square root of a serial matrix of a given size.
+ *  \return Pair of the inverse square root of the matrix and the number of independent groups.
+ */
+template <typename T, typename F>
+inline auto
+inverse_sqrt_blocks(la::dmatrix<T> const& A__, std::vector<int> const& offsets__, real_type<T> threshold__,
+        F&& inv_sqrt__)
+{
+    PROFILE("sirius::inverse_sqrt_blocks");
+
+    if (A__.comm().size() != 1) {
+        RTE_THROW("matrix must be serial");
+    }
+
+    int nb = static_cast<int>(offsets__.size()) - 1;
+    int N  = offsets__.back();
+
+    /* find connected groups of blocks with the union-find algorithm */
+    std::vector<int> parent(nb);
+    std::iota(parent.begin(), parent.end(), 0);
+    std::function<int(int)> root = [&](int i) { return (parent[i] == i) ? i : (parent[i] = root(parent[i])); };
+
+    for (int jb = 0; jb < nb; jb++) {
+        for (int ib = jb + 1; ib < nb; ib++) {
+            if (root(ib) == root(jb)) {
+                continue;
+            }
+            real_type<T> v{0};
+            for (int j = offsets__[jb]; j < offsets__[jb + 1]; j++) {
+                for (int i = offsets__[ib]; i < offsets__[ib + 1]; i++) {
+                    v = std::max(v, std::abs(A__(i, j)));
+                }
+            }
+            if (v > threshold__) {
+                parent[root(ib)] = root(jb);
+            }
+        }
+    }
+
+    /* list of matrix indices for each group */
+    std::map<int, std::vector<int>> groups;
+    for (int ib = 0; ib < nb; ib++) {
+        auto& g = groups[root(ib)];
+        for (int i = offsets__[ib]; i < offsets__[ib + 1]; i++) {
+            g.push_back(i);
+        }
+    }
+
+    auto B = std::make_unique<la::dmatrix<T>>(N, N);
+    B->zero();
+
+    for (auto const& e : groups) {
+        auto const& idx = e.second;
+        int n = static_cast<int>(idx.size());
+
+        la::dmatrix<T> a(n, n);
+        for (int j = 0; j < n; j++) {
+            for (int i = 0; i < n; i++) {
+                a(i, j) = A__(idx[i], idx[j]);
+            }
+        }
+        auto b = inv_sqrt__(a, n);
+        for (int j = 0; j < n; j++) {
+            for (int i = 0; i < n; i++) {
+                (*B)(idx[i], idx[j]) = (*b)(i, j);
+            }
+        }
+    }
+
+    return std::make_pair(std::move(B), static_cast<int>(groups.size()));
+}
+
 }
 
 #endif
@@ -35,7 +35,10 @@
 #include <algorithm>
 #include <cstring>
 #include <cstdio>
+#include <cstdlib>
 #include <map>
+#include <limits>
+#include <string>
 
 /// MPI related functions and classes.
 namespace mpi {
@@ -54,6 +57,27 @@ int get_device_id(int num_devices__);
     }                                                                                \
 }
 
+/// Size of the chunk (in bytes) used to split large buffers in the collective operations.
+/** Buffers larger than this size are split into chunks that are processed by a pipeline of non-blocking collective
+ *  calls. Zero value disables the splitting; in this case buffers with more than 2^31 - 1 elements are handled by the
+ *  large-count routines of MPI-4. The initial value can be set with the SIRIUS_MPI_CHUNK_SIZE environment
+ *  variable. */
+inline size_t& collective_chunk_size()
+{
+    static size_t chunk_size = []()
+    {
+        size_t n{1 << 26};
+        if (auto str = std::getenv("SIRIUS_MPI_CHUNK_SIZE")) {
+            n = std::stoull(str);
+        }
+        return n;
+    }();
+    return chunk_size;
+}
+
+/// Maximum number of non-blocking collective calls simultaneously in flight for a chunked buffer.
+const int collective_pipeline_depth = 4;
+
 /// Tyoe of MPI reduction.
 enum class op_t
 {
@@ -418,16 +442,76 @@ class Communicator
         CALL_MPI(MPI_Barrier, (this->native()));
     }
 
-    template <typename T, op_t mpi_op__ = op_t::sum>
-    inline void reduce(T* buffer__, int count__, int root__) const
+    /// Number of elements of type T in a single chunk of the collective operation.
+    template <typename T>
+    static inline size_t chunk_count()
     {
-        if (root__ == rank()) {
-            CALL_MPI(MPI_Reduce, (MPI_IN_PLACE, buffer__, count__, type_wrapper<T>(),
-                                  op_wrapper<mpi_op__>(), root__, this->native()));
-        } else {
-            CALL_MPI(MPI_Reduce, (buffer__, NULL, count__, type_wrapper<T>(),
-                                  op_wrapper<mpi_op__>(), root__, this->native()));
+        auto n = collective_chunk_size() / sizeof(T);
+        if (collective_chunk_size() == 0) {
+            n = static_cast<size_t>(std::numeric_limits<int>::max());
+        }
+        return std::max(size_t(1), std::min(n, static_cast<size_t>(std::numeric_limits<int>::max())));
+    }
+
+    /// Split the buffer into chunks and process them with a pipeline of non-blocking calls.
+    /** Function post__(offset, count, req) starts the non-blocking operation on a given chunk. At most
+     *  collective_pipeline_depth operations are in flight at the same time. */
+    template <typename T, typename F>
+    static inline void pipeline(size_t count__, F&& post__)
+    {
+        auto chunk   = chunk_count<T>();
+        auto nchunks = (count__ + chunk - 1) / chunk;
+
+        std::vector<MPI_Request> req(collective_pipeline_depth, MPI_REQUEST_NULL);
+        for (size_t i = 0; i < nchunks; i++) {
+            auto& r = req[i % collective_pipeline_depth];
+            if (r != MPI_REQUEST_NULL) {
+                CALL_MPI(MPI_Wait, (&r, MPI_STATUS_IGNORE));
+            }
+            size_t offset = i * chunk;
+            post__(offset, static_cast<int>(std::min(chunk, count__ - offset)), &r);
         }
+        CALL_MPI(MPI_Waitall, (collective_pipeline_depth, req.data(), MPI_STATUSES_IGNORE));
+    }
+
+    /// Return true if the large-count routines of MPI-4 are used for a buffer of a given size.
+    template <typename T>
+    static inline bool use_large_count(size_t count__)
+    {
+#if defined(MPI_VERSION) && (MPI_VERSION >= 4)
+        return collective_chunk_size() == 0 && count__ > static_cast<size_t>(std::numeric_limits<int>::max());
+#else
+        return false;
+#endif
+    }
+
+    /// Perform the in-place reduction to the root rank.
+    template <typename T, op_t mpi_op__ = op_t::sum>
+    inline void reduce(T* buffer__, size_t count__, int root__) const
+    {
+#if defined(MPI_VERSION) && (MPI_VERSION >= 4)
+        if (use_large_count<T>(count__)) {
+            auto sbuf = (root__ == rank()) ? MPI_IN_PLACE : buffer__;
+            auto rbuf = (root__ == rank()) ? buffer__ : nullptr;
+            CALL_MPI(MPI_Reduce_c, (sbuf, rbuf, static_cast<MPI_Count>(count__), type_wrapper<T>(),
+                                    op_wrapper<mpi_op__>(), root__, this->native()));
+            return;
+        }
+#endif
+        if (count__ <= chunk_count<T>()) {
+            if (root__ == rank()) {
+                CALL_MPI(MPI_Reduce, (MPI_IN_PLACE, buffer__, static_cast<int>(count__), type_wrapper<T>(),
+                                      op_wrapper<mpi_op__>(), root__, this->native()));
+            } else {
+                CALL_MPI(MPI_Reduce, (buffer__, NULL, static_cast<int>(count__), type_wrapper<T>(),
+                                      op_wrapper<mpi_op__>(), root__, this->native()));
+            }
+            return;
+        }
+        pipeline<T>(count__, [&](size_t offset__, int n__, MPI_Request* req__)
+        {
+            reduce<T, mpi_op__>(buffer__ + offset__, n__, root__, req__);
+        });
     }
 
     template <typename T, op_t mpi_op__ = op_t::sum>
@@ -443,10 +527,26 @@ class Communicator
     }
 
     template <typename T, op_t mpi_op__ = op_t::sum>
-    void reduce(T const* sendbuf__, T* recvbuf__, int count__, int root__) const
+    void reduce(T const* sendbuf__, T* recvbuf__, size_t count__, int root__) const
     {
-        CALL_MPI(MPI_Reduce, (sendbuf__, recvbuf__, count__, type_wrapper<T>(),
-                              op_wrapper<mpi_op__>(), root__, this->native()));
+#if defined(MPI_VERSION) && (MPI_VERSION >= 4)
+        if (use_large_count<T>(count__)) {
+            CALL_MPI(MPI_Reduce_c, (sendbuf__, recvbuf__, static_cast<MPI_Count>(count__), type_wrapper<T>(),
+                                    op_wrapper<mpi_op__>(), root__, this->native()));
+            return;
+        }
+#endif
+        if (count__ <= chunk_count<T>()) {
+            CALL_MPI(MPI_Reduce, (sendbuf__, recvbuf__, static_cast<int>(count__), type_wrapper<T>(),
+                                  op_wrapper<mpi_op__>(), root__, this->native()));
+            return;
+        }
+        /* receive buffer is significant only at root */
+        pipeline<T>(count__, [&](size_t offset__, int n__, MPI_Request* req__)
+        {
+            reduce<T, mpi_op__>(sendbuf__ + offset__, (recvbuf__ == nullptr) ? nullptr : recvbuf__ + offset__, n__,
+                                root__, req__);
+        });
     }
 
     template <typename T, op_t mpi_op__ = op_t::sum>
@@ -457,18 +557,33 @@ class Communicator
     }
 
     /// Perform the in-place (the output buffer is used as the input buffer) all-to-all reduction.
+    /** Large buffers are split into chunks which are reduced by a pipeline of non-blocking calls. */
     template <typename T, op_t mpi_op__ = op_t::sum>
-    inline void allreduce(T* buffer__, int count__) const
+    inline void allreduce(T* buffer__, size_t count__) const
     {
-        CALL_MPI(MPI_Allreduce, (MPI_IN_PLACE, buffer__, count__, type_wrapper<T>(),
-                                 op_wrapper<mpi_op__>(), this->native()));
+#if defined(MPI_VERSION) && (MPI_VERSION >= 4)
+        if (use_large_count<T>(count__)) {
+            CALL_MPI(MPI_Allreduce_c, (MPI_IN_PLACE, buffer__, static_cast<MPI_Count>(count__), type_wrapper<T>(),
+                                       op_wrapper<mpi_op__>(), this->native()));
+            return;
+        }
+#endif
+        if (count__ <= chunk_count<T>()) {
+            CALL_MPI(MPI_Allreduce, (MPI_IN_PLACE, buffer__, static_cast<int>(count__), type_wrapper<T>(),
+                                     op_wrapper<mpi_op__>(), this->native()));
+            return;
+        }
+        pipeline<T>(count__, [&](size_t offset__, int n__, MPI_Request* req__)
+        {
+            iallreduce<T, mpi_op__>(buffer__ + offset__, n__, req__);
+        });
     }
 
     /// Perform the in-place (the output buffer is used as the input buffer) all-to-all reduction.
     template <typename T, op_t op__ = op_t::sum>
     inline void allreduce(std::vector<T>& buffer__) const
     {
-        allreduce<T, op__>(buffer__.data(), static_cast<int>(buffer__.size()));
+        allreduce<T, op__>(buffer__.data(), buffer__.size());
     }
 
     template <typename T, op_t mpi_op__ = op_t::sum>
@@ -482,13 +597,28 @@ class Communicator
     }
 
     /// Perform buffer broadcast.
+    /** Large buffers are split into chunks which are broadcasted by a pipeline of non-blocking calls. */
     template <typename T>
-    inline void bcast(T* buffer__, int count__, int root__) const
+    inline void bcast(T* buffer__, size_t count__, int root__) const
     {
 #if defined(__PROFILE_MPI)
         PROFILE("MPI_Bcast");
 #endif
-        CALL_MPI(MPI_Bcast, (buffer__, count__, type_wrapper<T>(), root__, this->native()));
+#if defined(MPI_VERSION) && (MPI_VERSION >= 4)
+        if (use_large_count<T>(count__)) {
+            CALL_MPI(MPI_Bcast_c, (buffer__, static_cast<MPI_Count>(count__), type_wrapper<T>(), root__,
+                                   this->native()));
+            return;
+        }
+#endif
+        if (count__ <= chunk_count<T>()) {
+            CALL_MPI(MPI_Bcast, (buffer__, static_cast<int>(count__), type_wrapper<T>(), root__, this->native()));
+            return;
+        }
+        pipeline<T>(count__, [&](size_t offset__, int n__, MPI_Request* req__)
+        {
+            CALL_MPI(MPI_Ibcast, (buffer__ + offset__, n__, type_wrapper<T>(), root__, this->native(), req__));
+        });
     }
 
     inline void bcast(std::string& str__, int root__) const
@@ -555,25 +685,54 @@ class Communicator
     }
 
     /// In-place MPI_Allgatherv.
+    /** Each rank contributes count__ elements stored at offset displs__ of the buffer. Counts and offsets which do
+     *  not fit into int are handled with MPI_Allgatherv_c (MPI-4 and zero chunk size) or with a sequence of
+     *  (chunked) broadcasts of the individual parts. */
     template <typename T>
     void
-    allgather(T* buffer__, int count__, int displs__) const
+    allgather(T* buffer__, size_t count__, size_t displs__) const
     {
-        std::vector<int> v(size() * 2);
+        std::vector<unsigned long long> v(size() * 2);
         v[2 * rank()]     = count__;
         v[2 * rank() + 1] = displs__;
 
-        CALL_MPI(MPI_Allgather,
-                 (MPI_IN_PLACE, 0, MPI_DATATYPE_NULL, v.data(), 2, type_wrapper<int>(), this->native()));
+        CALL_MPI(MPI_Allgather, (MPI_IN_PLACE, 0, MPI_DATATYPE_NULL, v.data(), 2, type_wrapper<unsigned long long>(),
+                                 this->native()));
 
-        std::vector<int> counts(size());
-        std::vector<int> displs(size());
+        bool large{false};
+        for (int i = 0; i < size(); i++) {
+            large |= (v[2 * i] > chunk_count<T>()) ||
+                     (v[2 * i + 1] > static_cast<unsigned long long>(std::numeric_limits<int>::max()));
+        }
 
+        if (!large) {
+            std::vector<int> counts(size());
+            std::vector<int> displs(size());
+
+            for (int i = 0; i < size(); i++) {
+                counts[i] = static_cast<int>(v[2 * i]);
+                displs[i] = static_cast<int>(v[2 * i + 1]);
+            }
+            allgather(buffer__, counts.data(), displs.data());
+            return;
+        }
+#if defined(MPI_VERSION) && (MPI_VERSION >= 4)
+        if (collective_chunk_size() == 0) {
+            std::vector<MPI_Count> counts(size());
+            std::vector<MPI_Aint> displs(size());
+
+            for (int i = 0; i < size(); i++) {
+                counts[i] = static_cast<MPI_Count>(v[2 * i]);
+                displs[i] = static_cast<MPI_Aint>(v[2 * i + 1]);
+            }
+            CALL_MPI(MPI_Allgatherv_c, (MPI_IN_PLACE, 0, MPI_DATATYPE_NULL, buffer__, counts.data(), displs.data(),
+                                        type_wrapper<T>(), this->native()));
+            return;
+        }
+#endif
         for (int i = 0; i < size(); i++) {
-            counts[i] = v[2 * i];
-            displs[i] = v[2 * i + 1];
+            bcast(buffer__ + v[2 * i + 1], v[2 * i], i);
         }
-        allgather(buffer__, counts.data(), displs.data());
     }
 
     template <typename T>
@@ -666,14 +825,43 @@ class Communicator
                                 type_wrapper<T>(), root__, this->native()));
     }
 
+    /// MPI_Alltoall with 64-bit counts.
+    /** Large blocks are split into chunks which are exchanged by a pipeline of non-blocking calls. The datatype of a
+     *  chunk has the extent of the full block, such that the chunks of all destination blocks are addressed by a
+     *  single pointer. */
     template <typename T>
-    void alltoall(T const* sendbuf__, int sendcounts__, T* recvbuf__, int recvcounts__) const
+    void alltoall(T const* sendbuf__, size_t sendcounts__, T* recvbuf__, size_t recvcounts__) const
     {
 #if defined(__PROFILE_MPI)
         PROFILE("MPI_Alltoall");
 #endif
-        CALL_MPI(MPI_Alltoall, (sendbuf__, sendcounts__, type_wrapper<T>(), recvbuf__, recvcounts__,
-                                type_wrapper<T>(), this->native()));
+#if defined(MPI_VERSION) && (MPI_VERSION >= 4)
+        if (use_large_count<T>(std::max(sendcounts__, recvcounts__))) {
+            CALL_MPI(MPI_Alltoall_c, (sendbuf__, static_cast<MPI_Count>(sendcounts__), type_wrapper<T>(), recvbuf__,
+                                      static_cast<MPI_Count>(recvcounts__), type_wrapper<T>(), this->native()));
+            return;
+        }
+#endif
+        if (std::max(sendcounts__, recvcounts__) <= chunk_count<T>()) {
+            CALL_MPI(MPI_Alltoall, (sendbuf__, static_cast<int>(sendcounts__), type_wrapper<T>(), recvbuf__,
+                                    static_cast<int>(recvcounts__), type_wrapper<T>(), this->native()));
+            return;
+        }
+        /* send and receive types are the same, so are the counts */
+        assert(sendcounts__ == recvcounts__);
+        auto extent = static_cast<MPI_Aint>(sendcounts__ * sizeof(T));
+        pipeline<T>(sendcounts__, [&](size_t offset__, int n__, MPI_Request* req__)
+        {
+            MPI_Datatype t, t_block;
+            CALL_MPI(MPI_Type_contiguous, (n__, type_wrapper<T>(), &t));
+            CALL_MPI(MPI_Type_create_resized, (t, 0, extent, &t_block));
+            CALL_MPI(MPI_Type_commit, (&t_block));
+            CALL_MPI(MPI_Ialltoall, (sendbuf__ + offset__, 1, t_block, recvbuf__ + offset__, 1, t_block,
+                                     this->native(), req__));
+            /* the pending operation keeps its own reference to the type */
+            CALL_MPI(MPI_Type_free, (&t_block));
+            CALL_MPI(MPI_Type_free, (&t));
+        });
     }
 
     template <typename T>
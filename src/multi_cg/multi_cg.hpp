@@ -236,13 +236,19 @@ struct Smoothed_diagonal_preconditioner {
     sddk::mdarray<double, 2> S_diag;
     sddk::mdarray<double, 1> eigvals;
     int num_active;
+    // Spin components of the wave-functions to which the preconditioner is applied.
+    wf::spin_range spins{0};
 
     void apply(Wave_functions_wrap &x, Wave_functions_wrap const &y) {
         // Could avoid a copy here, but apply_precondition is in-place.
-        x.copy(y, num_active);
+        for (auto s = spins.begin(); s != spins.end(); s++) {
+            auto sp = x.x->actual_spin_index(s);
+            wf::copy(sddk::memory_t::host, *y.x, sp, wf::band_range(0, num_active), *x.x, sp,
+                    wf::band_range(0, num_active));
+        }
         sirius::apply_preconditioner(
             sddk::memory_t::host,
-            wf::spin_range(0),
+            spins,
             wf::num_bands(num_active),
             *x.x,
             H_diag,
@@ -59,12 +59,21 @@ void Potential::generate_pw_coefs()
             ctx_.gvec_fft().gather_pw_global(&fpw_fft[0], &rm_inv_pw_[0]);
         }
         default: {
-            fft::spfft_input<double>(fft, [&](int ir)
-            {
-                return effective_potential().rg().value(ir) * ctx_.theta(ir);
-            });
-            fft.forward(SPFFT_PU_HOST, reinterpret_cast<double*>(&fpw_fft[0]), SPFFT_FULL_SCALING);
-            ctx_.gvec_fft().gather_pw_global(&fpw_fft[0], &veff_pw_[0]);
+            /* Theta(r) * V_j(r) for all components; the coefficients are kept for the local operator and are
+             * not recomputed until the potential changes */
+            if (!theta_veff_valid_) {
+                for (int j = 0; j < ctx_.num_mag_dims() + 1; j++) {
+                    auto& f = *theta_veff_[j];
+                    #pragma omp parallel for schedule(static)
+                    for (int ir = 0; ir < fft.local_slice_size(); ir++) {
+                        f.value(ir) = component(j).rg().value(ir) * ctx_.theta(ir);
+                    }
+                    f.fft_transform(-1);
+                }
+                auto v = theta_veff_[0]->gather_f_pw();
+                std::copy(v.begin(), v.end(), veff_pw_.at(sddk::memory_t::host));
+                theta_veff_valid_ = true;
+            }
         }
     }
 
@@ -71,27 +71,31 @@ void Potential::generate_PAW_effective_potential(Density const& density)
     }
     comm_.allreduce(&paw_hartree_total_energy_, 1);
 
-    paw_potential_->sync();
-    std::vector<Spheric_function_set<double>*> ae_comp;
-    std::vector<Spheric_function_set<double>*> ps_comp;
-    for (int j = 0; j < ctx_.num_mag_dims() + 1; j++) {
-        ae_comp.push_back(&paw_potential_->ae_component(j));
-        ps_comp.push_back(&paw_potential_->ps_component(j));
+    /* Dij and the XC energy are computed only for the local atoms; the full copy of the functions is needed
+     * only to symmetrize them, which is a no-op for the identity operation */
+    if (unit_cell_.symmetry().size() > 1) {
+        paw_potential_->sync();
+        std::vector<Spheric_function_set<double>*> ae_comp;
+        std::vector<Spheric_function_set<double>*> ps_comp;
+        for (int j = 0; j < ctx_.num_mag_dims() + 1; j++) {
+            ae_comp.push_back(&paw_potential_->ae_component(j));
+            ps_comp.push_back(&paw_potential_->ps_component(j));
+        }
+        sirius::symmetrize(unit_cell_.symmetry(), unit_cell_.comm(), ctx_.num_mag_dims(), ae_comp);
+        sirius::symmetrize(unit_cell_.symmetry(), unit_cell_.comm(), ctx_.num_mag_dims(), ps_comp);
+
+        /* symmetrize ae- component of Exc */
+        paw_ae_exc_->sync(unit_cell_.spl_num_paw_atoms());
+        ae_comp.clear();
+        ae_comp.push_back(paw_ae_exc_.get());
+        sirius::symmetrize(unit_cell_.symmetry(), unit_cell_.comm(), 0, ae_comp);
+
+        /* symmetrize ps- component of Exc */
+        paw_ps_exc_->sync(unit_cell_.spl_num_paw_atoms());
+        ps_comp.clear();
+        ps_comp.push_back(paw_ps_exc_.get());
+        sirius::symmetrize(unit_cell_.symmetry(), unit_cell_.comm(), 0, ps_comp);
     }
-    sirius::symmetrize(unit_cell_.symmetry(), unit_cell_.comm(), ctx_.num_mag_dims(), ae_comp);
-    sirius::symmetrize(unit_cell_.symmetry(), unit_cell_.comm(), ctx_.num_mag_dims(), ps_comp);
-
-    /* symmetrize ae- component of Exc */
-    paw_ae_exc_->sync(unit_cell_.spl_num_paw_atoms());
-    ae_comp.clear();
-    ae_comp.push_back(paw_ae_exc_.get());
-    sirius::symmetrize(unit_cell_.symmetry(), unit_cell_.comm(), 0, ae_comp);
-
-    /* symmetrize ps- component of Exc */
-    paw_ps_exc_->sync(unit_cell_.spl_num_paw_atoms());
-    ps_comp.clear();
-    ps_comp.push_back(paw_ps_exc_.get());
-    sirius::symmetrize(unit_cell_.symmetry(), unit_cell_.comm(), 0, ps_comp);
 
     /* calculate PAW Dij matrix */
     #pragma omp parallel for
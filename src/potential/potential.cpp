@@ -109,6 +109,9 @@ Potential::Potential(Simulation_context& ctx__)
                 veff_pw_ = sddk::mdarray<std::complex<double>, 1>(ctx_.gvec().num_gvec());
             }
         }
+        for (int j = 0; j < ctx_.num_mag_dims() + 1; j++) {
+            theta_veff_[j] = std::make_unique<spf>(ctx_.spfft<double>(), ctx_.gvec_fft_sptr());
+        }
     }
 
     aux_bf_ = sddk::mdarray<double, 2>(3, ctx_.unit_cell().num_atoms());
@@ -140,6 +143,8 @@ void Potential::update()
         local_potential_->zero();
         generate_local_potential();
     } else {
+        /* step function depends on the unit cell */
+        invalidate_theta_veff();
         gvec_ylm_ = ctx_.generate_gvec_ylm(ctx_.lmax_pot());
         sbessel_mt_ = ctx_.generate_sbessel_mt(lmax_ + pseudo_density_order_ + 1);
 
@@ -232,6 +237,7 @@ void Potential::generate(Density const& density__, bool use_symmetry__, bool tra
 
     /* zero effective potential and magnetic field */
     zero();
+    invalidate_theta_veff();
 
     auto veff_callback = ctx_.veff_callback();
     if (veff_callback) {
@@ -362,6 +368,7 @@ void Potential::load()
     fin.read("/parameters/gvec", gv);
 
     effective_potential().hdf5_read(fin["effective_potential"], gv);
+    invalidate_theta_veff();
 
     for (int j = 0; j < ctx_.num_mag_dims(); j++) {
         effective_magnetic_field(j).hdf5_read(fin["effective_magnetic_field"][j], gv);
@@ -36,6 +36,10 @@ void check_xc_potential(Density const& rho__);
 void xc_mt(Radial_grid<double> const& rgrid__, SHT const& sht__, std::vector<XC_functional> const& xc_func__,
         int num_mag_dims__, std::vector<Flm const*> rho__, std::vector<Flm*> vxc__, Flm* exc__);
 
+double xc_mt_paw(std::vector<XC_functional> const& xc_func__, int lmax__, int num_mag_dims__, SHT const& sht__,
+    Radial_grid<double> const& rgrid__, std::vector<Flm const*> rho__, std::vector<double> const& rho_core__,
+    std::vector<Flm>& vxc__, Flm& exclm__);
+
 double density_residual_hartree_energy(Density const& rho1__, Density const& rho2__);
 
 /// Generate effective potential from charge density and magnetization.
@@ -107,6 +111,14 @@ class Potential : public Field4D
     /// Plane-wave coefficients of the effective potential weighted by the unit step-function.
     sddk::mdarray<std::complex<double>, 1> veff_pw_;
 
+    /// Local plane-wave coefficients of the effective potential and magnetic field weighted by the unit step-function.
+    /** Computed together with veff_pw_ and handed over to the local operator, so that it does not need to repeat
+     *  the dense-grid FFT of \f$ \Theta({\bf r}) V_j({\bf r}) \f$ for each component. */
+    std::array<std::unique_ptr<Smooth_periodic_function<double>>, 4> theta_veff_;
+
+    /// True if theta_veff_ is consistent with the current effective potential and magnetic field.
+    bool theta_veff_valid_{false};
+
     /// Plane-wave coefficients of the inverse relativistic mass weighted by the unit step-function.
     sddk::mdarray<std::complex<double>, 1> rm_inv_pw_;
 
@@ -801,6 +813,28 @@ class Potential : public Field4D
     void set_veff_pw(std::complex<double> const* veff_pw__)
     {
         std::copy(veff_pw__, veff_pw__ + ctx_.gvec().num_gvec(), veff_pw_.at(sddk::memory_t::host));
+        /* theta_veff_ might be inconsistent with the externally provided coefficients */
+        theta_veff_valid_ = false;
+    }
+
+    /// Return true if the step-function weighted components of the potential are up to date.
+    bool theta_veff_valid() const
+    {
+        return theta_veff_valid_;
+    }
+
+    /// Plane-wave coefficients of the j-th component of the potential weighted by the unit step-function.
+    auto const& theta_veff(int j__) const
+    {
+        RTE_ASSERT(theta_veff_valid_);
+        return *theta_veff_[j__];
+    }
+
+    /// Mark step-function weighted components of the potential as outdated.
+    /** Must be called when the real-space potential is modified outside of generate(). */
+    void invalidate_theta_veff()
+    {
+        theta_veff_valid_ = false;
     }
 
     auto const& rm_inv_pw(int ig__) const
@@ -858,6 +892,11 @@ class Potential : public Field4D
         add_delta_rho_xc_ = d__;
     }
 
+    inline auto add_delta_rho_xc() const
+    {
+        return add_delta_rho_xc_;
+    }
+
     inline void add_delta_mag_xc(double d__)
     {
         add_delta_mag_xc_ = d__;
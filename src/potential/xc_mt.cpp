@@ -109,17 +109,17 @@ void xc_mt_nonmagnetic(Radial_grid<double> const& rgrid__, SHT const& sht__, std
                 vxc_tp -= 2.0 * grad_vsigma_grad_rho_tp;
             } else {
                 Spheric_vector_function<function_domain_t::spectral, double> vsigma_grad_rho_lm(sht__.lmmax(), rgrid__);
+                Ftp vsigma_grad_rho_tp(sht__.num_points(), rgrid__);
                 for (int x: {0, 1, 2}) {
-                    auto vsigma_grad_rho_tp = vsigma_tp * grad_rho_tp[x];
+                    vsigma_grad_rho_tp = vsigma_tp * grad_rho_tp[x];
                     transform(sht__, vsigma_grad_rho_tp, vsigma_grad_rho_lm[x]);
                 }
-                auto div_vsigma_grad_rho_tp = transform(sht__, divergence(vsigma_grad_rho_lm));
                 /* add remaining term to Vxc */
-                vxc_tp -= 2.0 * div_vsigma_grad_rho_tp;
+                vxc_tp -= 2.0 * transform(sht__, divergence(vsigma_grad_rho_lm));
             }
         }
-        exc_lm__ += transform(sht__, exc_tp);
-        vxc_lm__ += transform(sht__, vxc_tp);
+        transform_add(sht__, exc_tp, exc_lm__);
+        transform_add(sht__, vxc_tp, vxc_lm__);
     } //ixc
 }
 
@@ -236,12 +236,12 @@ void xc_mt_magnetic(Radial_grid<double> const& rgrid__, SHT const& sht__, int nu
             Spheric_vector_function<function_domain_t::spatial, double> grad_vsigma_ud_tp(sht__.num_points(), rgrid__);
             Spheric_vector_function<function_domain_t::spatial, double> grad_vsigma_dd_tp(sht__.num_points(), rgrid__);
             for (int x = 0; x < 3; x++) {
-                grad_vsigma_uu_tp[x] = transform(sht__, grad_vsigma_uu_lm[x]);
-                grad_vsigma_ud_tp[x] = transform(sht__, grad_vsigma_ud_lm[x]);
-                grad_vsigma_dd_tp[x] = transform(sht__, grad_vsigma_dd_lm[x]);
+                transform(sht__, grad_vsigma_uu_lm[x], grad_vsigma_uu_tp[x]);
+                transform(sht__, grad_vsigma_ud_lm[x], grad_vsigma_ud_tp[x]);
+                transform(sht__, grad_vsigma_dd_lm[x], grad_vsigma_dd_tp[x]);
             }
 
-            /* compute scalar product of two gradients */
+            /* scalar products of two gradients are evaluated together with the update of Vxc */
             auto grad_vsigma_uu_grad_rho_up_tp = grad_vsigma_uu_tp * grad_rho_up_tp;
             auto grad_vsigma_dd_grad_rho_dn_tp = grad_vsigma_dd_tp * grad_rho_dn_tp;
             auto grad_vsigma_ud_grad_rho_up_tp = grad_vsigma_ud_tp * grad_rho_up_tp;
@@ -279,11 +279,11 @@ void xc_mt_magnetic(Radial_grid<double> const& rgrid__, SHT const& sht__, int nu
         }
         /* convert magnetic field back to Rlm */
         for (int j = 0; j < num_mag_dims__; j++) {
-            *vxc__[j + 1] += transform(sht__, bxc_tp[j]);
+            transform_add(sht__, bxc_tp[j], *vxc__[j + 1]);
         }
         /* forward transform from (theta, phi) to Rlm */
-        *vxc__[0] += transform(sht__, vxc_tp);
-        exc__ += transform(sht__, exc_tp);
+        transform_add(sht__, vxc_tp, *vxc__[0]);
+        transform_add(sht__, exc_tp, exc__);
     } // ixc
 }
 
@@ -261,22 +261,22 @@ void SHT::backward_transform<std::complex<double>>(int ld, std::complex<double>
 }
 
 template<>
-void SHT::forward_transform<double>(double const *ftp, int nr, int lmmax, int ld, double *flm) const
+void SHT::forward_transform<double>(double const *ftp, int nr, int lmmax, int ld, double *flm, double beta) const
 {
     assert(lmmax <= lmmax_);
     assert(ld >= lmmax);
     la::wrap(la::lib_t::blas).gemm('T', 'N', lmmax, nr, num_points_, &la::constant<double>::one(),
-        &rlm_forward_(0, 0), num_points_, ftp, num_points_, &la::constant<double>::zero(), flm, ld);
+        &rlm_forward_(0, 0), num_points_, ftp, num_points_, &beta, flm, ld);
 }
 
 template<>
 void SHT::forward_transform<std::complex<double>>(std::complex<double> const *ftp, int nr, int lmmax, int ld,
-                                            std::complex<double> *flm) const
+                                            std::complex<double> *flm, std::complex<double> beta) const
 {
     assert(lmmax <= lmmax_);
     assert(ld >= lmmax);
     la::wrap(la::lib_t::blas).gemm('T', 'N', lmmax, nr, num_points_, &la::constant<std::complex<double>>::one(),
-        &ylm_forward_(0, 0), num_points_, ftp, num_points_, &la::constant<std::complex<double>>::zero(), flm, ld);
+        &ylm_forward_(0, 0), num_points_, ftp, num_points_, &beta, flm, ld);
 }
 
 void SHT::check() const
@@ -256,9 +256,10 @@ class SHT // TODO: better name
      *  \param [in] lmmax Maximum number of lm- coefficients to generate.
      *  \param [in] ld Size of leading dimension of flm.
      *  \param [out] flm Raw pointer to \f$ f_{\ell m}(r) \f$.
+     *  \param [in] beta Scaling factor of the existing \f$ f_{\ell m}(r) \f$; use 1 to accumulate the result.
      */
     template <typename T>
-    void forward_transform(T const* ftp, int nr, int lmmax, int ld, T* flm) const;
+    void forward_transform(T const* ftp, int nr, int lmmax, int ld, T* flm, T beta = T(0)) const;
 
     /// Convert form Rlm to Ylm representation.
     static void convert(int lmax__, double const* f_rlm__, std::complex<double>* f_ylm__)
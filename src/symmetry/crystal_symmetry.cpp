@@ -253,6 +253,24 @@ Crystal_symmetry::Crystal_symmetry(r3::matrix<double> const& lattice_vectors__,
     }
 
     PROFILE_START("sirius::Crystal_symmetry|mag");
+    /* check if the time reversal alone is a symmetry */
+    {
+        r3::vector<double> e(0, 0, 0);
+        bool collinear{true};
+        for (int ia = 0; ia < num_atoms_; ia++) {
+            r3::vector<double> m(spins__(0, ia), spins__(1, ia), spins__(2, ia));
+            if (m.length() < 1e-10) {
+                continue;
+            }
+            if (e.length() < 1e-10) {
+                e = m * (1.0 / m.length());
+            } else if (cross(e, m).length() > 1e-10) {
+                collinear = false;
+            }
+        }
+        bool non_magnetic = (e.length() < 1e-10);
+        time_reversal_ = non_magnetic || (collinear && !spin_orbit__);
+    }
     /* loop over spatial symmetries */
     for (int isym = 0; isym < num_spg_sym(); isym++) {
         int jsym0 = 0;
@@ -260,35 +278,43 @@ Crystal_symmetry::Crystal_symmetry(r3::matrix<double> const& lattice_vectors__,
         if (spin_orbit__) {
             jsym0 = jsym1 = isym;
         }
-        /* loop over spin symmetries */
-        for (int jsym = jsym0; jsym <= jsym1; jsym++) {
-            /* take proper part of rotation matrix */
-            auto Rspin = space_group_symmetry(jsym).Rcp;
-
-            int n{0};
-            /* check if all atoms transform under spatial and spin symmetries */
-            for (int ia = 0; ia < num_atoms_; ia++) {
-                int ja = space_group_symmetry(isym).sym_atom[ia];
-
-                /* now check that vector field transforms from atom ia to atom ja */
-                /* vector field of atom is expected to be in Cartesian coordinates */
-                auto vd = dot(Rspin, r3::vector<double>(spins__(0, ia), spins__(1, ia), spins__(2, ia))) -
-                                  r3::vector<double>(spins__(0, ja), spins__(1, ja), spins__(2, ja));
-
-                if (vd.length() < 1e-10) {
-                    n++;
+        /* first try the unitary operations; if none is found and the time reversal alone is not a symmetry,
+         * try the spatial operation combined with the time reversal, which flips the magnetic moments */
+        bool found{false};
+        for (int tr = 0; tr < (time_reversal_ ? 1 : 2) && !found; tr++) {
+            double sign = tr ? -1 : 1;
+            /* loop over spin symmetries */
+            for (int jsym = jsym0; jsym <= jsym1; jsym++) {
+                /* take proper part of rotation matrix */
+                auto Rspin = space_group_symmetry(jsym).Rcp;
+
+                int n{0};
+                /* check if all atoms transform under spatial and spin symmetries */
+                for (int ia = 0; ia < num_atoms_; ia++) {
+                    int ja = space_group_symmetry(isym).sym_atom[ia];
+
+                    /* now check that vector field transforms from atom ia to atom ja */
+                    /* vector field of atom is expected to be in Cartesian coordinates */
+                    auto vd = dot(Rspin, r3::vector<double>(spins__(0, ia), spins__(1, ia), spins__(2, ia))) * sign -
+                                      r3::vector<double>(spins__(0, ja), spins__(1, ja), spins__(2, ja));
+
+                    if (vd.length() < 1e-10) {
+                        n++;
+                    }
+                }
+                /* if all atoms transform under spin rotaion, add it to a list */
+                if (n == num_atoms_) {
+                    magnetic_group_symmetry_descriptor mag_op;
+                    mag_op.spg_op            = space_group_symmetry(isym);
+                    mag_op.spin_rotation     = Rspin * sign;
+                    mag_op.spin_rotation_inv = inverse(mag_op.spin_rotation);
+                    mag_op.spin_rotation_su2 = rotation_matrix_su2(Rspin);
+                    mag_op.time_reversal     = (tr == 1);
+                    /* add symmetry to the list */
+                    magnetic_group_symmetry_.push_back(std::move(mag_op));
+                    found = true;
+                    break;
                 }
-            }
-            /* if all atoms transform under spin rotaion, add it to a list */
-            if (n == num_atoms_) {
-                magnetic_group_symmetry_descriptor mag_op;
-                mag_op.spg_op            = space_group_symmetry(isym);
-                mag_op.spin_rotation     = Rspin;
-                mag_op.spin_rotation_inv = inverse(Rspin);
-                mag_op.spin_rotation_su2 = rotation_matrix_su2(Rspin);
-                /* add symmetry to the list */
-                magnetic_group_symmetry_.push_back(std::move(mag_op));
-                break;
             }
         }
     }
@@ -350,6 +376,8 @@ Crystal_symmetry::print_info(std::ostream& out__, int verbosity__) const
     }
     out__ << "number of space group operations  : " << this->num_spg_sym() << std::endl
           << "number of magnetic group operations : " << this->size() << std::endl
+          << "  combined with time reversal       : " << this->num_antiunitary() << std::endl
+          << "time reversal symmetry : " << this->time_reversal() << std::endl
           << "metric tensor error: " << std::scientific << this->metric_tensor_error() << std::endl
           << "rotation matrix error: " << std::scientific << this->sym_op_R_error() << std::endl;
 
@@ -400,6 +428,7 @@ Crystal_symmetry::print_info(std::ostream& out__, int verbosity__) const
                 out__ << std::endl;
             }
             out__ << "proper: " << std::setw(2) << this->operator[](isym).spg_op.proper << std::endl
+                  << "time reversal: " << this->operator[](isym).time_reversal << std::endl
                   << std::endl;
         }
     }
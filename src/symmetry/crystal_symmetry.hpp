@@ -80,13 +80,20 @@ struct magnetic_group_symmetry_descriptor
     /// Element of space group symmetry.
     space_group_symmetry_descriptor spg_op;
 
-    /// Proper rotation matrix in Cartesian coordinates.
+    /// Transformation of the magnetic moments in Cartesian coordinates.
+    /** This is a proper spin rotation S for the unitary operation and -S for the operation combined with the time
+     *  reversal, such that the magnetization always transforms as \f$ {\bf m}' = {\bf S} {\bf m} \f$. */
     r3::matrix<double> spin_rotation;
 
-    /// Inverse of proper spin rotation matrix in Cartesian coordinates.
+    /// Inverse of the spin transformation matrix.
     r3::matrix<double> spin_rotation_inv;
 
+    /// SU(2) matrix of the proper spin rotation.
     sddk::mdarray<std::complex<double>, 2> spin_rotation_su2;
+
+    /// True if the operation is combined with the time reversal (antiunitary operation).
+    /** The spinor density matrix then transforms as \f$ \rho' = U \sigma_y \rho^{*} \sigma_y U^{\dagger} \f$. */
+    bool time_reversal{false};
 };
 
 /// Representation of the crystal symmetry.
@@ -127,6 +134,12 @@ class Crystal_symmetry
     /// List of all magnetic group symmetry operations.
     std::vector<magnetic_group_symmetry_descriptor> magnetic_group_symmetry_;
 
+    /// True if the time reversal alone is a symmetry of the magnetic configuration.
+    /** This is the case for non-magnetic systems and for collinear magnets without spin-orbit coupling
+     *  (each spin channel has a real Hamiltonian). Otherwise the time reversal can only appear in combination
+     *  with a spatial operation. */
+    bool time_reversal_{true};
+
     /// Number of crystal symmetries without magnetic configuration.
     inline int num_spg_sym() const
     {
@@ -221,6 +234,22 @@ class Crystal_symmetry
         return magnetic_group_symmetry_[isym__];
     }
 
+    /// True if the time reversal alone is a symmetry operation.
+    inline bool time_reversal() const
+    {
+        return time_reversal_;
+    }
+
+    /// Number of magnetic group operations combined with the time reversal.
+    inline int num_antiunitary() const
+    {
+        int n{0};
+        for (auto const& e : magnetic_group_symmetry_) {
+            n += e.time_reversal ? 1 : 0;
+        }
+        return n;
+    }
+
     auto const& lattice_vectors() const
     {
         return lattice_vectors_;
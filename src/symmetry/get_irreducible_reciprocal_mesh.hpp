@@ -36,10 +36,12 @@ get_irreducible_reciprocal_mesh(Crystal_symmetry const& sym__, r3::vector<int> k
     std::map<M, int> sym_map;
 
     for (int isym = 0; isym < sym__.size(); isym++) {
+        /* antiunitary operation maps k to -Rk */
+        int sign = sym__[isym].time_reversal ? -1 : 1;
         M s;
         for (int x: {0, 1, 2}) {
             for (int y: {0, 1, 2}) {
-                s[x][y] = sym__[isym].spg_op.R(x, y);
+                s[x][y] = sign * sym__[isym].spg_op.R(x, y);
             }
         }
         sym_map[s] = 1;
@@ -59,7 +61,7 @@ get_irreducible_reciprocal_mesh(Crystal_symmetry const& sym__, r3::vector<int> k
                                                 &ikmap[0],
                                                 &k_mesh__[0],
                                                 &is_shift__[0],
-                                                1,
+                                                sym__.time_reversal() ? 1 : 0,
                                                 static_cast<int>(sym_list.size()),
                                                 (int(*)[3][3])&sym_list[0],
                                                 1,
@@ -579,6 +579,29 @@ symmetrize(std::function<sddk::mdarray<std::complex<double>, 3>&(int ia__)> dm__
 
             int ja = sym__[isym].spg_op.inv_sym_atom[ia];
 
+            /* density matrix of the pre-image atom; for the antiunitary operation it is time-reversed first:
+             * uu -> dd^{*}, dd -> uu^{*}, ud -> -ud */
+            auto dm_src = [&](int xi1, int xi2, int j) -> std::complex<double>
+            {
+                if (!sym__[isym].time_reversal) {
+                    return dm__(ja)(xi1, xi2, j);
+                }
+                if (num_mag_comp__ == 1) {
+                    return std::conj(dm__(ja)(xi1, xi2, 0));
+                }
+                switch (j) {
+                    case 0: {
+                        return std::conj(dm__(ja)(xi1, xi2, 1));
+                    }
+                    case 1: {
+                        return std::conj(dm__(ja)(xi1, xi2, 0));
+                    }
+                    default: {
+                        return -dm__(ja)(xi1, xi2, 2);
+                    }
+                }
+            };
+
             auto& indexb = *indexb__(iat);
             auto& indexr = indexb.indexr();
 
@@ -605,7 +628,7 @@ symmetrize(std::function<sddk::mdarray<std::complex<double>, 3>&(int ia__)> dm__
                                 for (int m1p = 0; m1p < ss1; m1p++) {
                                     for (int m2p = 0; m2p < ss2; m2p++) {
                                         dm_ia(m1, m2, j) += rotm[am1.l()](m1, m1p) *
-                                                            dm__(ja)(offset1 + m1p, offset2 + m2p, j) *
+                                                            dm_src(offset1 + m1p, offset2 + m2p, j) *
                                                             rotm[am2.l()](m2, m2p);
                                     }
                                 }
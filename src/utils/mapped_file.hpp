@@ -0,0 +1,144 @@
+// Copyright (c) 2013-2023 Anton Kozhevnikov, Thomas Schulthess
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+// the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+//    following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+//    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** \file mapped_file.hpp
+ *
+ *  \brief Anonymous memory-mapped file on a node-local storage.
+ */
+
+#ifndef __MAPPED_FILE_HPP__
+#define __MAPPED_FILE_HPP__
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "rte.hpp"
+
+namespace utils {
+
+/// Memory-mapped scratch file used as an out-of-core storage.
+/** The file is created in a given directory (normally a node-local scratch) and unlinked immediately, so that
+ *  it disappears when the mapping is released, even if the program is terminated. The mapping is shared, so
+ *  the pages can be written back to the file and dropped from memory by the kernel. The residency of the pages is
+ *  steered with prefetch() (asynchronous read-ahead) and evict() (write-back and release). */
+class mapped_file
+{
+  private:
+    /// File descriptor.
+    int fd_{-1};
+    /// Size of the mapping in bytes.
+    size_t size_{0};
+    /// Pointer to the mapped memory.
+    void* ptr_{nullptr};
+
+    /// Align the range to the page boundaries and return the pointer to the first page and the length.
+    std::pair<char*, size_t> page_range(size_t offset__, size_t size__) const
+    {
+        static const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        size_t begin = (offset__ / page) * page;
+        size_t end   = std::min(size_, offset__ + size__);
+        if (end <= begin) {
+            return std::make_pair(nullptr, 0);
+        }
+        return std::make_pair(static_cast<char*>(ptr_) + begin, end - begin);
+    }
+
+  public:
+    /// Create and map a scratch file of a given size in the directory.
+    mapped_file(std::string const& dir__, size_t size__)
+        : size_{size__}
+    {
+        std::string name = dir__ + "/sirius_ooc_XXXXXX";
+        std::vector<char> tmpl(name.begin(), name.end());
+        tmpl.push_back('\0');
+
+        fd_ = mkstemp(tmpl.data());
+        if (fd_ == -1) {
+            RTE_THROW("failed to create scratch file " + name + " : " + std::strerror(errno));
+        }
+        unlink(tmpl.data());
+
+        if (size_ == 0) {
+            return;
+        }
+        if (ftruncate(fd_, static_cast<off_t>(size_)) != 0) {
+            close(fd_);
+            RTE_THROW("failed to resize scratch file : " + std::string(std::strerror(errno)));
+        }
+        ptr_ = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (ptr_ == MAP_FAILED) {
+            close(fd_);
+            RTE_THROW("failed to map scratch file : " + std::string(std::strerror(errno)));
+        }
+    }
+
+    mapped_file(mapped_file const& src__) = delete;
+
+    mapped_file& operator=(mapped_file const& src__) = delete;
+
+    ~mapped_file()
+    {
+        if (ptr_) {
+            munmap(ptr_, size_);
+        }
+        if (fd_ != -1) {
+            close(fd_);
+        }
+    }
+
+    inline void* data()
+    {
+        return ptr_;
+    }
+
+    inline size_t size() const
+    {
+        return size_;
+    }
+
+    /// Start an asynchronous read-ahead of the range.
+    inline void prefetch(size_t offset__, size_t size__) const
+    {
+        auto r = page_range(offset__, size__);
+        if (r.second) {
+            madvise(r.first, r.second, MADV_WILLNEED);
+        }
+    }
+
+    /// Schedule the write-back of the range and release its pages from the resident memory.
+    /** The content is preserved in the file and is paged in again on the next access. */
+    inline void evict(size_t offset__, size_t size__) const
+    {
+        auto r = page_range(offset__, size__);
+        if (r.second) {
+            msync(r.first, r.second, MS_ASYNC);
+            madvise(r.first, r.second, MADV_DONTNEED);
+        }
+    }
+};
+
+} // namespace utils
+
+#endif // __MAPPED_FILE_HPP__
@@ -30,6 +30,11 @@ namespace PES_optimizer{
     int n_hist_max = 10;
     double w = 2.0;
     double f_std_deviation = 0.0;
+    double alpha0 = 1.e-2;
+    double eps_subsp = 1.e-3;
+    bool use_precond = false;
+    // Cholesky factor L of the preconditioner P = L L^T
+    Eigen::LLT<Eigen::MatrixXd> precond_llt;
 
     public:
 
@@ -74,6 +79,8 @@ namespace PES_optimizer{
       this->ndim = 3*nat;
       this->initial_step_size = initial_step_size;
       this->n_hist_max = nhist_max;
+      this->alpha0 = alpha0;
+      this->eps_subsp = eps_subsp;
       this->opt_lattice = false;
       this->opt = std::make_unique<sqnm_space::SQNM>(ndim, n_hist_max, initial_step_size, alpha0, eps_subsp);
     }
@@ -111,10 +118,41 @@ namespace PES_optimizer{
       this->w = lattice_weight;
       this->n_hist_max = nhist_max;
       this->initial_step_size = initial_step_size;
+      this->alpha0 = alpha0;
+      this->eps_subsp = eps_subsp;
       setupInitialLattice(nat, lat_a, lat_b, lat_c);
       this->opt = std::make_unique<sqnm_space::SQNM>(ndim, n_hist_max, initial_step_size, alpha0, eps_subsp);
     }
 
+    /**
+     * @brief Sets a symmetric positive definite preconditioner P (an approximation of the Hessian matrix).
+     * The optimization is then performed in the transformed coordinates x' = L^T x, where P = L L^T, so that
+     * the Hessian in the transformed coordinates is close to identity. The history list is reset, because
+     * previous steps are not valid in the new coordinates.
+     * 
+     * @param P preconditioner, dimension(3 * nat, 3 * nat) for fixed cell and dimension(3 * nat + 9, 3 * nat + 9)
+     * for variable cell shape optimization. The last 9 coordinates are the transformed lattice vectors.
+     * @return bool false if P has a wrong size or is not positive definite; the preconditioner is not changed in this case.
+     */
+    bool set_preconditioner(Eigen::MatrixXd const& P)
+    {
+      if (P.rows() != ndim || P.cols() != ndim)
+      {
+        std::cerr << "Preconditioner has a wrong dimension. It is ignored.\n";
+        return false;
+      }
+      Eigen::LLT<Eigen::MatrixXd> llt(P);
+      if (llt.info() != Eigen::Success)
+      {
+        std::cerr << "Preconditioner is not positive definite. It is ignored.\n";
+        return false;
+      }
+      this->precond_llt = llt;
+      this->use_precond = true;
+      this->opt = std::make_unique<sqnm_space::SQNM>(ndim, n_hist_max, initial_step_size, alpha0, eps_subsp);
+      return true;
+    }
+
     /**
      * @brief Calculates new atomic coordinates that are closer to the local minimum. Fixed cell optimization. This function should be used the following way:
      * 1. calculate energies and forces at positions r.
@@ -134,7 +172,7 @@ namespace PES_optimizer{
       check_forces(f);
       Eigen::VectorXd pos_all = Eigen::Map<Eigen::VectorXd>(r.data(), 3*nat);
       Eigen::VectorXd force_all = - Eigen::Map<Eigen::VectorXd>(f.data(), 3*nat);
-      pos_all += opt->step(pos_all, energy, force_all);
+      pos_all += precond_step(pos_all, energy, force_all);
       r = Eigen::Map<Eigen::MatrixXd>(pos_all.data(), 3, nat);
     }
 
@@ -179,7 +217,7 @@ namespace PES_optimizer{
       Eigen::VectorXd dqall = combine_matrices(dq, dalat);
       
       //cout << "update coordinates" << endl;
-      qall += this->opt->step(qall, energy, dqall);
+      qall += precond_step(qall, energy, dqall);
 
       split_matrices(q, alat_tilde, qall);
       alat = alat_tilde * lattice_transformer_inv;
@@ -214,6 +252,19 @@ namespace PES_optimizer{
     }
 
     private:
+    // SQNM step in the preconditioned coordinates; returns the displacement in the original coordinates
+    Eigen::VectorXd precond_step(Eigen::VectorXd &x, double &energy, Eigen::VectorXd &df_dx){
+      if (!use_precond)
+      {
+        return this->opt->step(x, energy, df_dx);
+      }
+      auto L = precond_llt.matrixL();
+      Eigen::VectorXd xp = precond_llt.matrixU() * x;
+      Eigen::VectorXd dfp = L.solve(df_dx);
+      Eigen::VectorXd dxp = this->opt->step(xp, energy, dfp);
+      return precond_llt.matrixU().solve(dxp);
+    }
+
     Eigen::VectorXd combine_matrices(Eigen::MatrixXd a, Eigen::MatrixXd b){
       Eigen::VectorXd result(this->ndim);
       for (int i = 0; i < 3*nat; i++)